@@ -10,6 +10,8 @@
 #include "macros.h"
 #include  "ports.h"
 #include "timers.h"
+#include "ADC.h"
+#include <string.h>
 
 extern volatile unsigned long last_adc_isr_time;
 extern volatile unsigned long tb0_ccr0_hits;
@@ -30,12 +32,14 @@ char adc_char[4]; // Array to hold the converted ADC value in BCD format
 
 void Sample_ADC(void) {
 	sample_adc = TRUE;
+    IR_ON();                                // Held on while scanning - no settle time between scans
     TB1CCTL0 &= ~CCIFG;                     // Clear possible pending interrupt
 //    TB1CCR0   = TB1R + ADC_SAMPLE_INTERVAL(2);     // Set CCR1 for debounce interval
     TB1CCTL0 |=  CCIE;                      // TB1_0 enable interrupt
 }
 void Stop_ADC(void) {
     sample_adc = FALSE;
+    IR_OFF();
     TB1CCTL0 &= ~CCIFG;                     // Clear possible pending interrupt
     TB1CCTL0 &= ~CCIE;                      // TB1_0 enable interrupt
 }
@@ -45,6 +49,7 @@ void Reset_ADC(void){
     if((tb0_ccr0_hits - last_adc_isr_time) > 1000){
         __disable_interrupt();
         ADCCTL0 &= ~ADCENC;
+        ADCMCTL0 = LINE_SENSOR_FIRST_INPUT;                 // Restart scan at slot 0 (only takes with ENC = 0)
         ADCCTL0 |=  ADCENC;
         sample_adc = 0;
         adc_case = 0;
@@ -85,7 +90,7 @@ void Init_ADC(void)
 
     // ADCMCTL0 Register
     ADCMCTL0 |= ADCSREF_0;              // VREF - 000b = {VR+ = AVCC and VR� = AVSS }
-    ADCMCTL0 |= ADCINCH_5;              // V_THUMB (0x20) Pin 5 A5
+    ADCMCTL0 |= LINE_SENSOR_FIRST_INPUT;    // First slot of the line sensor scan (see ADC.h)
 
     ADCIE   |= ADCIE0;                  // Enable ADC conv complete interrupt
     ADCCTL0 |= ADCENC;                  // ADC enable conversion
@@ -145,3 +150,34 @@ void adc_line(char line, char location) {
 
 
 
+//-------------------------------------------------------------
+// ADC Rate display
+// Measured conversions per second for each channel of the
+// multi-rate scan (adc_rate_hz[], updated every ~1s by the ISR).
+//     Line 2 => slowest line sensor, Line 3 => fastest
+//     Line 4 => V_THUMB (2 sensor board only)
+//-------------------------------------------------------------
+void Display_ADC_Rates(void) {
+    unsigned int i;
+    unsigned int line_min = adc_rate_hz[ADC_RATE_LINE(0)];
+    unsigned int line_max = line_min;
+
+    for (i = 1; i < LINE_SENSOR_COUNT; i++) {
+        if (adc_rate_hz[ADC_RATE_LINE(i)] < line_min) { line_min = adc_rate_hz[ADC_RATE_LINE(i)]; }
+        if (adc_rate_hz[ADC_RATE_LINE(i)] > line_max) { line_max = adc_rate_hz[ADC_RATE_LINE(i)]; }
+    }
+
+    strcpy(display_line[0], "ADC Hz    ");
+    strcpy(display_line[1], "LMin      ");
+    strcpy(display_line[2], "LMax      ");
+    strcpy(display_line[3], "Thmb  ----");
+    HEXtoBCD(line_min);
+    adc_line(2, 6);
+    HEXtoBCD(line_max);
+    adc_line(3, 6);
+#if ADC_SCAN_THUMB
+    HEXtoBCD(adc_rate_hz[ADC_RATE_THUMB]);
+    adc_line(4, 6);
+#endif
+    display_changed = TRUE;
+}
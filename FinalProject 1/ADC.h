@@ -17,23 +17,77 @@
 
 #define SAMPLES        (10)    // Number of samples to average during calibration
 
-
-// ================ GLOBALS =====================
-// Calibration values (set during calibration routine)
-extern unsigned int LEFT_BLACK_VALUE;
-extern unsigned int LEFT_WHITE_VALUE;
-extern unsigned int RIGHT_BLACK_VALUE;
-extern unsigned int RIGHT_WHITE_VALUE;
+// Line sensor array ______________________
+// Sensors are indexed car-left -> car-right. The centre pair is still published
+// as ADC_Left/Right_Detect for the drive state machine (CAR_Left/Right_Detect).
+#define LINE_SENSOR_COUNT       (2)     // 2 (V_DETECT board), 4 or 6 (SENS0-SENS2 PCB)
+#define LINE_CENTER_LEFT        ((LINE_SENSOR_COUNT / 2) - 1)
+#define LINE_CENTER_RIGHT       (LINE_SENSOR_COUNT / 2)
+
+#if LINE_SENSOR_COUNT == 2
+#define LINE_SENSOR_CHANNELS    ADCINCH_3, ADCINCH_2                        // V_DETECT_R (car left), V_DETECT_L (car right)
+#define LINE_SENSOR_FIRST_INPUT (ADCINCH_3)
+#define ADC_SCAN_THUMB          (1)                                         // V_THUMB on A5
+#elif LINE_SENSOR_COUNT == 4
+#define LINE_SENSOR_CHANNELS    ADCINCH_2, ADCINCH_1, ADCINCH_0, ADCINCH_5  // SENS1_L, SENS0_L, SENS0_R, SENS1_R
+#define LINE_SENSOR_FIRST_INPUT (ADCINCH_2)
+#define ADC_SCAN_THUMB          (0)                                         // A5 is SENS1_R on the PCB
+#elif LINE_SENSOR_COUNT == 6
+#define LINE_SENSOR_CHANNELS    ADCINCH_8, ADCINCH_2, ADCINCH_1, ADCINCH_0, ADCINCH_5, ADCINCH_9    // SENS2_L .. SENS2_R
+#define LINE_SENSOR_FIRST_INPUT (ADCINCH_8)
+#define ADC_SCAN_THUMB          (0)
+#else
+#error "LINE_SENSOR_COUNT must be 2, 4 or 6"
+#endif
+
+// Multi-rate scan ________________________
+// Every scan converts each line sensor once, then one SHARED slot. A slow channel
+// (thumb, supply...) takes the shared slot once every <divisor> scans; on every
+// other scan the slot goes to an extra conversion of the next line sensor
+// (round robin), which is averaged into that sensor's reading.
+#define ADC_SCAN_RATE_HZ        (500)   // Scans per second (TB1 CCR0 trigger) = steering rate, 200-1000
+#define ADC_THUMB_INPUT         (ADCINCH_5)
+#define ADC_THUMB_DIVISOR       (ADC_SCAN_RATE_HZ / 10)                     // V_THUMB only scrolls menus - 10 Hz is plenty
+#define ADC_SCAN_SUPPLY         (1)                                         // V_DAC on A10 (P5.2) - motor rail for DAC regulation
+#define ADC_SUPPLY_INPUT        (ADCINCH_10)
+#define ADC_SUPPLY_DIVISOR      (ADC_SCAN_RATE_HZ / 50)                     // 50 Hz - regulator filters it at 20 Hz
+#define ADC_SLOW_COUNT          (ADC_SCAN_THUMB + ADC_SCAN_SUPPLY)          // Channels sharing the slot
+#define ADC_SLOW_THUMB          (0)                                         // Shared slot owners (slow channel index)
+#define ADC_SLOW_SUPPLY         (ADC_SCAN_THUMB)
+#define ADC_SLOW_NONE           (0xFF)  // Shared slot owner: extra line sensor conversion
+#define ADC_SCAN_LENGTH         (LINE_SENSOR_COUNT + 1)                     // Conversions per scan
+
+// Nominal effective rates (x10 Hz): shared slots left over after the slow channels
+// are spread over the line sensors
+#if ADC_SCAN_THUMB
+#define ADC_THUMB_RATE_X10      ((10 * ADC_SCAN_RATE_HZ) / ADC_THUMB_DIVISOR) // 10 Hz
+#else
+#define ADC_THUMB_RATE_X10      (0)
+#endif
+#if ADC_SCAN_SUPPLY
+#define ADC_SUPPLY_RATE_X10     ((10 * ADC_SCAN_RATE_HZ) / ADC_SUPPLY_DIVISOR) // 50 Hz
+#else
+#define ADC_SUPPLY_RATE_X10     (0)
+#endif
+#define ADC_SLOW_SLOTS_X10      (ADC_THUMB_RATE_X10 + ADC_SUPPLY_RATE_X10)
+#define ADC_LINE_RATE_X10       ((10 * ADC_SCAN_RATE_HZ) + (((10 * ADC_SCAN_RATE_HZ) - ADC_SLOW_SLOTS_X10) / LINE_SENSOR_COUNT))
+                                                                            // At 500 Hz - 2 sensors: 720 Hz, 4: 612 Hz, 6: 575 Hz
+// Measured rates: ADC_RATE_LINE(i) / ADC_RATE_THUMB / ADC_RATE_SUPPLY index into adc_rate_hz[]
+#define ADC_RATE_CHANNELS       (LINE_SENSOR_COUNT + ADC_SLOW_COUNT)
+#define ADC_RATE_LINE(i)        (i)
+#define ADC_RATE_THUMB          (LINE_SENSOR_COUNT + ADC_SLOW_THUMB)
+#define ADC_RATE_SUPPLY         (LINE_SENSOR_COUNT + ADC_SLOW_SUPPLY)
 
 
-// Calculated thresholds (midpoint between black and white)
-extern unsigned int LEFT_THRESHOLD;
-extern unsigned int RIGHT_THRESHOLD;
+// ================ GLOBALS =====================
+// Calibration values and thresholds are per sensor - see calibration.h
 
 
 extern volatile unsigned int ADC_Thumb;
+extern volatile unsigned int ADC_Supply;                        // V_DAC (motor rail divider), 10-bit
 extern volatile unsigned int ADC_Left_Detect;
 extern volatile unsigned int ADC_Right_Detect;
+extern volatile unsigned int ADC_Line_Detect[LINE_SENSOR_COUNT];
 
 extern volatile unsigned char display_thumb;
 extern volatile unsigned char display_left_detect;
@@ -41,9 +95,12 @@ extern volatile unsigned char display_right_detect;
 
 extern volatile unsigned char sample_adc;
 
+extern volatile unsigned int adc_rate_hz[ADC_RATE_CHANNELS];
+
 
 void Sample_ADC(void);
 void Stop_ADC(void);
+void Display_ADC_Rates(void);
 
 // OFFSET READINGS ATTEMPT
 //#define LINE_THRESHOLD  ((LEFT_BLACK_VALUE + LEFT_WHITE_VALUE) / 2)			// Single threshold
@@ -5,16 +5,24 @@
  *      Author: Dallas.Owens
  *  Description: Digital to Analog Converter configuration and control
  *               Controls Buck-Boost converter for variable motor voltage
+ *               Voltage ramps step from the TB3 period tick (DAC_Ramp_Update)
+ *               Millivolt requests go through a measured (code, mV) table,
+ *               kept in FRAM and refreshed with the IoT W workflow
+ *               The rail is read back on V_DAC and the code trimmed so it
+ *               holds the asked-for voltage as the battery drains
  */
 
 #include "msp430.h"
 #include "macros.h"
 #include "functions.h"
+#include <string.h>
 #include "ports.h"
 #include "DAC.h"
+#include "ADC.h"
 #include  "led.h"
 #include  "ports.h"
 #include  "timers.h"
+#include "fram.h"
 
 
 
@@ -22,12 +30,92 @@
 volatile unsigned int DAC_data;
 volatile unsigned char dac_voltage_set = FALSE;
 
+// Ramp engine - stepped by DAC_Ramp_Update (TB3 CCR0 ISR)
+static volatile unsigned char dac_ramping = FALSE;
+static volatile unsigned int dac_ramp_target = DAC_BEGIN;
+static volatile unsigned int dac_ramp_step = DAC_RAMP_STEP;
+static volatile unsigned int dac_ramp_ticks = 1;            // Ticks per step
+static volatile unsigned int dac_ramp_count = 0;
+static dac_ramp_done_t dac_ramp_done = NULL;
+
+// Voltage calibration - built-in points are the DAC.h annotations
+static const dac_cal_point_t dac_cal_default[DAC_CAL_POINTS] = {
+    { DAC_SAFE_MAX,      6050 },
+    { DAC_MOTOR_FAST,    5800 },
+    { DAC_MOTOR_MEDIUM,  5030 },
+    { DAC_MOTOR_SLOW,    4080 },
+    { DAC_MOTOR_CRAWL,   3440 },
+    { DAC_MIN,           2210 },
+};
+static dac_cal_point_t dac_cal[DAC_CAL_POINTS];             // Table in use
+static dac_cal_point_t dac_cal_work[DAC_CAL_POINTS];        // W workflow edits
+static unsigned char dac_cal_selected = DAC_CAL_POINTS;     // Point being measured, DAC_CAL_POINTS = none
+static unsigned char dac_cal_ready = FALSE;
+
+// Supply regulation - DAC_Supply_Update (TB3 CCR0 ISR)
+static volatile unsigned int dac_set_code = DAC_BEGIN;      // Code last asked for (before trim)
+static volatile unsigned int dac_supply_mv = 0;             // Its table voltage = the regulator setpoint
+static volatile unsigned char dac_reg_enabled = DAC_REG_ENABLE;
+static volatile unsigned char dac_reg_hold = DAC_REG_SETTLE;    // Updates left before trimming again
+static unsigned int dac_reg_count = 0;
+static unsigned char dac_reg_primed = FALSE;
+static unsigned int dac_reg_filter = 0;                     // Reading, mV << DAC_REG_FILTER
+static volatile unsigned int dac_reg_reading = 0;           // Filtered rail, mV
+static volatile int dac_reg_trim = 0;                       // mV added to the setpoint
+static volatile int dac_reg_error = 0;                      // Setpoint - reading, last update
+static volatile unsigned int dac_reg_error_max = 0;         // |error| since the last report
+
+// Measured code-to-rail curve (IoT W) - replaces the bench table at boot
+#pragma PERSISTENT(dac_cal_record)
+dac_cal_record_t dac_cal_record = { 0 };
+
+extern char adc_char[4];
+
 
 // External references
 extern volatile unsigned char display_changed;
 extern char display_line[4][11];
 
 
+static void DAC_Boot_Ramp_Done(void) {
+    RED_OFF();                          // Turn off RED LED - voltage set
+}
+
+// Every setpoint goes through here. The regulator's trim carries over onto the
+// new code, and only a real step (not the speed schedule's small moves) holds
+// the regulator off while the rail and the filter catch up.
+static void DAC_Write(unsigned int value) {
+    unsigned short interrupt_state = __get_SR_register() & GIE;
+    unsigned int millivolts = DAC_mV_For_Code(value);
+    unsigned int output = value;
+    int moved;
+
+    __disable_interrupt();
+    if ((dac_reg_trim != 0) && (value >= DAC_SAFE_MAX) && (value <= DAC_MIN) && (dac_cal_selected == DAC_CAL_POINTS)) {
+        output = DAC_Code_For_mV((unsigned int)((int)millivolts + dac_reg_trim));
+    }
+    moved = (int)millivolts - (int)dac_supply_mv;
+    DAC_data = output;
+    SAC3DAT = output;
+    dac_set_code = value;
+    dac_supply_mv = millivolts;
+    if ((moved > DAC_REG_RESETTLE_MV) || (moved < -DAC_REG_RESETTLE_MV)) {
+        dac_reg_hold = DAC_REG_SETTLE;
+    }
+    __bis_SR_register(interrupt_state);
+}
+
+static unsigned int DAC_Clamp(unsigned int value) {
+    if (value < DAC_SAFE_MAX) {
+        value = DAC_SAFE_MAX;           // Clamp to maximum safe value
+    }
+    if (value > DAC_MIN) {
+        value = DAC_MIN;                // Clamp to minimum value
+    }
+    return value;
+}
+
+
 void Init_DAC(void)
 {
     // Configure DAC
@@ -53,45 +141,27 @@ void Init_DAC(void)
     DAC_data = DAC_BEGIN;               // Starting Low value for DAC output [2V]
     SAC3DAT = DAC_data;                 // Write initial DAC data
 
-    // Enable B0 OVRFLW ramping
-    TB0CTL |= TBIE;                     // Timer B0 overflow interrupt enable
-    RED_ON();                           // RED LED indicates voltage ramping in progress
-
     // Enable the DAC
     SAC3DAC |= DACEN;                   // Enable DAC - starts voltage output
 
-    dac_voltage_set = FALSE;            // Flag cleared until target voltage reached
+    // Ramp up to the operating voltage (TB3 tick)
+    RED_ON();                           // RED LED indicates voltage ramping in progress
+    DAC_Ramp_To(DAC_ADJUST, DAC_RAMP_STEP, DAC_RAMP_MS, DAC_Boot_Ramp_Done);     // Clears dac_voltage_set until there
 }
 
 
-//unsigned int DAC_Battery_Adjust(unsigned int V_BAT_current) {
-//    unsigned int adjusted_dac = base_dac * (5.5 / V_BAT_current);
-//	return adjusted_dac;
-//}
-
-
 void DAC_Increase_Speed(unsigned int target_dac) 
 { // must ramp to higer voltage 
-  // (by lowering DAC value)
-    unsigned int current = DAC_data;
-
-    while (current > target_dac) {              // CAREFUL!!! LOWER DAC = HIGHER voltage
-        current -= DAC_STEP_MEDIUM;
-        if (current < target_dac) {
-            current = target_dac;
-        }
-        SAC3DAT = current;
-        __delay_cycles(400000);                 // 50ms delay between steps
-    }
-    DAC_data = current;
+  // (by lowering DAC value) - 50ms per step, returns at once
+    DAC_Ramp_To(target_dac, DAC_STEP_MEDIUM, DAC_RAMP_MS, NULL);
 }
 
 
 
 void DAC_Decrease_Speed(unsigned int target_dac) 
 { // Can decrease voltage in single step
-    DAC_data = target_dac;
-    SAC3DAT = target_dac;
+    dac_ramping = FALSE;                        // Overrides a ramp in progress
+    DAC_Write(target_dac);
 }
 
 
@@ -100,24 +170,21 @@ void DAC_Set_Voltage(unsigned int target_value) {
     // Set DAC to a specific value
     // Same as Decrease_Speed but with safety guards
     //   ...Because it is 3am and I have no idea where a fire extinguisher is...
+    // Immediate - overrides a ramp in progress
     //==============================================================================
-    if (target_value < DAC_SAFE_MAX) {
-        target_value = DAC_SAFE_MAX;             // Clamp to maximum safe value
-    }
-    if (target_value > DAC_MIN) {
-        target_value = DAC_MIN;             // Clamp to minimum value
-    }
+    target_value = DAC_Clamp(target_value);
 
-    DAC_data = target_value;
-    SAC3DAT = DAC_data;
+    dac_ramping = FALSE;
+    DAC_Write(target_value);
 }
 
 
 unsigned int DAC_Get_Voltage(void) {
     //==============================================================================
-    // Returns current DAC value
+    // Returns the code last asked for - DAC_data is what the regulator has
+    // trimmed it to on SAC3
     //==============================================================================
-    return DAC_data;
+    return dac_set_code;
 }
 
 
@@ -129,27 +196,399 @@ unsigned char DAC_Ready(void) {
 }
 
 
-void DAC_Ramp_ISR(void) {
+void DAC_Ramp(unsigned int target_value) {
+    //==============================================================================
+    // Ramp at the default step and rate
+    //==============================================================================
+    DAC_Ramp_To(target_value, DAC_RAMP_STEP, DAC_RAMP_MS, NULL);
+}
+
+
+void DAC_Ramp_To(unsigned int target_value, unsigned int step, unsigned int period_ms, dac_ramp_done_t done) {
+    //==============================================================================
+    // Start (or retarget) a ramp: one step of 'step' codes every period_ms,
+    // either direction. 'done' runs in the ISR on arrival and DAC_Ready()
+    // goes TRUE. Returns at once.
+    //==============================================================================
+    unsigned short interrupt_state = __get_SR_register() & GIE;
+    unsigned int ticks = DAC_RAMP_TICKS(period_ms);
+
+    __disable_interrupt();
+    dac_ramp_target = DAC_Clamp(target_value);
+    dac_ramp_step = (step == 0) ? 1 : step;
+    dac_ramp_ticks = (ticks == 0) ? 1 : ticks;
+    dac_ramp_count = 0;
+    dac_ramp_done = done;
+    dac_voltage_set = FALSE;
+    dac_ramping = TRUE;
+    __bis_SR_register(interrupt_state);
+}
+
+
+void DAC_Ramp_Stop(void) {
+    dac_ramping = FALSE;
+}
+
+
+unsigned char DAC_Ramping(void) {
+    return dac_ramping;
+}
+
+
+void DAC_Ramp_Update(void) {
     //==============================================================================
-    // Called from TB0 overflow ISR (interrupts_timers.c)
-    // Gradually decreases DAC value from 2725 (2V) to 875 (6V)
+    // Called from the TB3 CCR0 ISR (odometry.c), once per PWM period
     //
     // Note: Lower DAC values = Higher output voltage (inverse relationship)
     //       This is due to the feedback configuration of the buck-boost converter
     //==============================================================================
+    unsigned int current = dac_set_code;      // Steps the setpoint - DAC_Write trims it
+    dac_ramp_done_t done;
 
-    DAC_data = DAC_data - DAC_RAMP_STEP;    // Decrease by ramp step
-    SAC3DAT = DAC_data;                     // Update DAC output
+    if (!dac_ramping) return;
+    if (++dac_ramp_count < dac_ramp_ticks) return;
+    dac_ramp_count = 0;
 
-    if (DAC_data <= DAC_LIMIT) {            // Check if target reached
-        DAC_data = DAC_ADJUST;              // Set final adjustment value
-        SAC3DAT = DAC_data;                 // Write final value
-        TB0CTL &= ~TBIE;                    // Disable TB0 overflow interrupt
-        RED_OFF();                          // Turn off RED LED - voltage set
-        dac_voltage_set = TRUE;             // Set completion flag
+    if (current > dac_ramp_target) {        // Raising the voltage
+        current = ((current - dac_ramp_target) > dac_ramp_step) ? (current - dac_ramp_step) : dac_ramp_target;
+    }
+    else if (current < dac_ramp_target) {
+        current = ((dac_ramp_target - current) > dac_ramp_step) ? (current + dac_ramp_step) : dac_ramp_target;
+    }
+    DAC_Write(current);
+
+    if (current == dac_ramp_target) {       // Target reached
+        dac_ramping = FALSE;
+        dac_voltage_set = TRUE;
+        done = dac_ramp_done;
+        dac_ramp_done = NULL;
+        if (done) {
+            done();
+        }
     }
 }
 
 
+//==============================================================================
+// VOLTAGE CALIBRATION
+// Straight lines between the table points, integer maths with rounding. Codes
+// past either end follow the end segment; requests are clamped to the safe
+// range like DAC_Set_Voltage.
+//==============================================================================
+static const dac_cal_point_t *DAC_Cal_Table(void) {
+    unsigned char i;
+
+    if (!dac_cal_ready) {                   // Before DAC_Cal_Load (or without it)
+        for (i = 0; i < DAC_CAL_POINTS; i++) {
+            dac_cal[i] = dac_cal_default[i];
+        }
+        dac_cal_ready = TRUE;
+    }
+    return dac_cal;
+}
+
+static unsigned char DAC_Cal_Valid(const dac_cal_point_t *point) {
+    unsigned char i;
 
+    for (i = 0; i < DAC_CAL_POINTS; i++) {
+        if (point[i].mv < DAC_CAL_MV_MIN) return FALSE;
+        if ((i > 0) && ((point[i].code <= point[i - 1].code) || (point[i].mv >= point[i - 1].mv))) {
+            return FALSE;                   // Must fall as the code rises
+        }
+    }
+    return TRUE;
+}
+
+static unsigned int DAC_Cal_CRC(const dac_cal_record_t *record) {
+    return FRAM_CRC(record, DAC_CAL_RECORD_WORDS, DAC_CAL_CRC_SEED);
+}
+
+static void DAC_Cal_Write(const dac_cal_record_t *record) {
+    FRAM_Record_Write(&dac_cal_record, record, DAC_CAL_RECORD_WORDS, record->crc);
+}
+
+unsigned char DAC_Cal_Load(void) {
+    unsigned char i;
+
+    DAC_Cal_Table();                        // Built-in first
+    if (dac_cal_record.version != DAC_CAL_VERSION) return FALSE;
+    if (DAC_Cal_CRC(&dac_cal_record) != dac_cal_record.crc) return FALSE;
+    if (!DAC_Cal_Valid(dac_cal_record.point)) return FALSE;
+
+    for (i = 0; i < DAC_CAL_POINTS; i++) {
+        dac_cal[i] = dac_cal_record.point[i];
+    }
+    return TRUE;
+}
+
+// Segment (lo = i, hi = i + 1) for a code, or for a voltage when by_mv
+static unsigned char DAC_Cal_Segment(const dac_cal_point_t *point, unsigned int value, unsigned char by_mv) {
+    unsigned char i;
+
+    for (i = 1; i < (DAC_CAL_POINTS - 1); i++) {
+        if (by_mv ? (value >= point[i].mv) : (value <= point[i].code)) break;
+    }
+    return i - 1;
+}
 
+// a * b / span to the nearest, either sign (span > 0)
+static long DAC_Cal_Scale(long a, long b, long span) {
+    long product = a * b;
+
+    if (product < 0) return -(((-product * 2) + span) / (span * 2));
+    return ((product * 2) + span) / (span * 2);
+}
+
+unsigned int DAC_mV_For_Code(unsigned int code) {
+    const dac_cal_point_t *point = DAC_Cal_Table();
+    const dac_cal_point_t *lo;
+    const dac_cal_point_t *hi;
+    long span, mv;
+
+    lo = &point[DAC_Cal_Segment(point, code, FALSE)];
+    hi = lo + 1;
+    span = (long)hi->code - lo->code;
+    mv = (long)lo->mv - DAC_Cal_Scale((long)lo->mv - hi->mv, (long)code - lo->code, span);
+    if (mv < 0) return 0;
+    return (unsigned int)mv;
+}
+
+static long DAC_Code_Raw(unsigned int millivolts) {
+    const dac_cal_point_t *point = DAC_Cal_Table();
+    const dac_cal_point_t *lo;
+    const dac_cal_point_t *hi;
+    long span;
+
+    lo = &point[DAC_Cal_Segment(point, millivolts, TRUE)];
+    hi = lo + 1;
+    span = (long)lo->mv - hi->mv;
+    return (long)lo->code + DAC_Cal_Scale((long)hi->code - lo->code, (long)lo->mv - millivolts, span);
+}
+
+unsigned int DAC_Code_For_mV(unsigned int millivolts) {
+    long code = DAC_Code_Raw(millivolts);
+
+    if (code < DAC_SAFE_MAX) return DAC_SAFE_MAX;
+    if (code > DAC_MIN) return DAC_MIN;
+    return (unsigned int)code;
+}
+
+unsigned char DAC_Set_Voltage_mV(unsigned int millivolts) {
+    long code = DAC_Code_Raw(millivolts);
+
+    DAC_Set_Voltage(DAC_Code_For_mV(millivolts));
+    return (code >= DAC_SAFE_MAX) && (code <= DAC_MIN);
+}
+
+void DAC_Ramp_mV(unsigned int millivolts) {
+    DAC_Ramp(DAC_Code_For_mV(millivolts));
+}
+
+
+//==============================================================================
+// CALIBRATION WORKFLOW (IoT W, see DAC.h)
+// LCD: point, its code, the reading in the working table.
+// UART: "DAC P0 C0875 M6050"
+//==============================================================================
+static void DAC_Cal_Line(char line, const char *label, unsigned int value) {
+    strcpy(display_line[line - 1], label);
+    HEXtoBCD((int)value);
+    adc_line(line, 6);
+}
+
+static void DAC_Cal_Report(void) {
+    char response[] = "DAC P0 C0000 M0000\r\n";
+    const dac_cal_point_t *point = &dac_cal_work[dac_cal_selected];
+    unsigned char i;
+
+    DAC_Cal_Line(1, "Cal Pt    ", dac_cal_selected);
+    DAC_Cal_Line(2, "Code      ", point->code);
+    DAC_Cal_Line(3, "mV        ", point->mv);
+    strcpy(display_line[3], "W1000+ mV ");
+    display_changed = TRUE;
+
+    response[5] = (char)('0' + dac_cal_selected);
+    HEXtoBCD((int)point->code);
+    for (i = 0; i < 4; i++) response[8 + i] = adc_char[i];
+    HEXtoBCD((int)point->mv);
+    for (i = 0; i < 4; i++) response[14 + i] = adc_char[i];
+    Send_Response(response);
+}
+
+void DAC_Cal_Command(unsigned int value) {
+    dac_cal_record_t record = { 0 };
+    const dac_cal_point_t *point;
+    unsigned char i;
+
+    if (value < DAC_CAL_POINTS) {                   // Select a point and drive to it
+        if (dac_cal_selected == DAC_CAL_POINTS) {
+            point = DAC_Cal_Table();
+            for (i = 0; i < DAC_CAL_POINTS; i++) {
+                dac_cal_work[i] = point[i];
+            }
+        }
+        dac_cal_selected = (unsigned char)value;
+        DAC_Set_Voltage(dac_cal_work[dac_cal_selected].code);
+        DAC_Cal_Report();
+    }
+    else if (value >= DAC_CAL_MV_MIN) {             // Meter reading for the selected point
+        if (dac_cal_selected == DAC_CAL_POINTS) {
+            Send_Response("DAC Cal: W000n first\r\n");
+            return;
+        }
+        dac_cal_work[dac_cal_selected].mv = value;
+        DAC_Cal_Report();
+    }
+    else if (value == DAC_CAL_CMD_SAVE) {
+        if ((dac_cal_selected == DAC_CAL_POINTS) || !DAC_Cal_Valid(dac_cal_work)) {
+            Send_Response("DAC Cal Bad\r\n");
+            return;
+        }
+        record.version = DAC_CAL_VERSION;
+        for (i = 0; i < DAC_CAL_POINTS; i++) {
+            record.point[i] = dac_cal_work[i];
+            dac_cal[i] = dac_cal_work[i];
+        }
+        record.crc = DAC_Cal_CRC(&record);
+        DAC_Cal_Write(&record);
+        dac_cal_selected = DAC_CAL_POINTS;
+        Send_Response("DAC Cal Saved\r\n");
+    }
+    else if (value == DAC_CAL_CMD_DEFAULT) {
+        record.crc = DAC_Cal_CRC(&record) ^ DAC_CAL_CRC_SEED;   // Version 0 + bad CRC: never loads
+        DAC_Cal_Write(&record);
+        for (i = 0; i < DAC_CAL_POINTS; i++) {
+            dac_cal[i] = dac_cal_default[i];
+        }
+        dac_cal_selected = DAC_CAL_POINTS;
+        Send_Response("DAC Cal Default\r\n");
+    }
+    else if (value == DAC_REG_CMD_REPORT) {
+        DAC_Supply_Report();
+    }
+    else if (value == DAC_REG_CMD_TOGGLE) {
+        DAC_Supply_Enable(!dac_reg_enabled);
+        Send_Response(dac_reg_enabled ? "SUP Reg On\r\n" : "SUP Reg Off\r\n");
+    }
+    else {
+        Send_Response("DAC Cal ?\r\n");
+    }
+}
+
+
+//==============================================================================
+// SUPPLY REGULATION (DAC.h)
+// Every DAC_REG_MS: filter the V_DAC reading, compare it with the table
+// voltage of the code asked for, and move the trim (mV) by part of the error.
+// The code is then slewed toward the table code for setpoint + trim. The trim
+// only integrates once the code has caught up with it, and not into a clamp.
+// Left alone while a ramp runs, during W calibration, and with the ADC off.
+//==============================================================================
+unsigned int DAC_Supply_mV(void) {
+    return dac_supply_mv;
+}
+
+void DAC_Supply_Update(void) {
+#if ADC_SCAN_SUPPLY
+    unsigned int reading, code, current;
+    int error, step;
+
+    if (++dac_reg_count < DAC_RAMP_TICKS(DAC_REG_MS)) return;
+    dac_reg_count = 0;
+
+    if (!sample_adc) {                          // No fresh V_DAC - start the filter over when it is back
+        dac_reg_primed = FALSE;
+        return;
+    }
+    reading = (unsigned int)((((unsigned long)ADC_Supply * DAC_SENSE_FULL_MV) + 512) >> 10);
+    if (!dac_reg_primed) {
+        dac_reg_filter = reading << DAC_REG_FILTER;
+        dac_reg_primed = TRUE;
+    }
+    else {
+        dac_reg_filter = dac_reg_filter - (dac_reg_filter >> DAC_REG_FILTER) + reading;
+    }
+    reading = dac_reg_filter >> DAC_REG_FILTER;
+    dac_reg_reading = reading;
+
+    if (!dac_reg_enabled || dac_ramping || (dac_cal_selected != DAC_CAL_POINTS)) return;
+    if ((dac_set_code < DAC_SAFE_MAX) || (dac_set_code > DAC_MIN)) return;     // Motors off (DAC_BEGIN)
+    if (dac_reg_hold) {
+        dac_reg_hold--;
+        return;
+    }
+
+    error = (int)dac_supply_mv - (int)reading;
+    dac_reg_error = error;
+    if ((unsigned int)((error < 0) ? -error : error) > dac_reg_error_max) {
+        dac_reg_error_max = (unsigned int)((error < 0) ? -error : error);
+    }
+
+    current = DAC_data;
+    code = DAC_Code_For_mV((unsigned int)((int)dac_supply_mv + dac_reg_trim));
+    if ((code == current) && ((error > DAC_REG_DEADBAND_MV) || (error < -DAC_REG_DEADBAND_MV))) {
+        step = error / 2;
+        if (step > DAC_REG_STEP_MV) step = DAC_REG_STEP_MV;
+        if (step < -DAC_REG_STEP_MV) step = -DAC_REG_STEP_MV;
+        if (!((code == DAC_SAFE_MAX) && (step > 0)) && !((code == DAC_MIN) && (step < 0))) {
+            dac_reg_trim += step;               // Not past the end of the code range
+            if (dac_reg_trim > DAC_REG_TRIM_MV) dac_reg_trim = DAC_REG_TRIM_MV;
+            if (dac_reg_trim < -DAC_REG_TRIM_MV) dac_reg_trim = -DAC_REG_TRIM_MV;
+        }
+        code = DAC_Code_For_mV((unsigned int)((int)dac_supply_mv + dac_reg_trim));
+    }
+
+    if (code < current) {                       // Lower code = higher rail
+        code = ((current - code) > DAC_REG_CODE_STEP) ? (current - DAC_REG_CODE_STEP) : code;
+    }
+    else if (code > current) {
+        code = ((code - current) > DAC_REG_CODE_STEP) ? (current + DAC_REG_CODE_STEP) : code;
+    }
+    DAC_data = code;
+    SAC3DAT = code;
+#endif
+}
+
+void DAC_Supply_Enable(unsigned char enable) {
+    dac_reg_enabled = enable;
+    if (!enable) {
+        dac_reg_trim = 0;
+        DAC_Write(dac_set_code);                // Back to the table code
+    }
+}
+
+// LCD: setpoint, reading, signed error and trim (mV).
+// UART: "SUP T5800 M5750 E+0050 X0120" - X is the largest |error| since the last report
+static void DAC_Supply_Signed(char line, const char *label, int value) {
+    DAC_Cal_Line(line, label, (unsigned int)((value < 0) ? -value : value));
+    display_line[line - 1][5] = (value < 0) ? '-' : '+';
+}
+
+void DAC_Supply_Report(void) {
+    char response[] = "SUP T0000 M0000 E+0000 X0000\r\n";
+    int error = dac_reg_error;
+    unsigned int error_max = dac_reg_error_max;
+    unsigned char i;
+
+    dac_reg_error_max = 0;
+
+    DAC_Cal_Line(1, "Sup Set   ", dac_supply_mv);
+    DAC_Cal_Line(2, "Sup Rd    ", dac_reg_reading);
+    DAC_Supply_Signed(3, "Sup Err   ", error);
+    DAC_Supply_Signed(4, "Trim      ", dac_reg_trim);
+    display_changed = TRUE;
+
+    HEXtoBCD((int)dac_supply_mv);
+    for (i = 0; i < 4; i++) response[5 + i] = adc_char[i];
+    HEXtoBCD((int)dac_reg_reading);
+    for (i = 0; i < 4; i++) response[11 + i] = adc_char[i];
+    if (error < 0) {
+        response[17] = '-';
+        error = -error;
+    }
+    HEXtoBCD(error);
+    for (i = 0; i < 4; i++) response[18 + i] = adc_char[i];
+    HEXtoBCD((int)error_max);
+    for (i = 0; i < 4; i++) response[24 + i] = adc_char[i];
+    Send_Response(response);
+}
@@ -7,6 +7,8 @@
  *  Description: PWM motor control with direction change delay management
  *               Implements 500ms delay between direction changes and 50ms
  *               reverse pulse for line intercept braking.
+ *               Movement functions go through a slew-rate-limited output
+ *               stage stepped at the PWM rate (see PWM.h).
  */
 
 #include "timers.h"
@@ -14,6 +16,7 @@
 #include "functions.h"
 #include "msp430.h"
 #include "LED.h"
+#include "motor.h"
 #include "PWM.h"
 
 // Track motor directions
@@ -22,14 +25,26 @@ static unsigned char right_motor_direction = MOTOR_OFF;
 volatile unsigned char ebraking = FALSE;
 volatile unsigned char safety_stop = FALSE;
 
+// Output stage - TB3 CCR0 ISR steps the wheel speeds toward the targets
+static volatile int pwm_target[MOTOR_WHEELS];
+static volatile int pwm_output[MOTOR_WHEELS];               // Last speed the stage set
+static volatile unsigned int pwm_step_up[MOTOR_WHEELS];
+static volatile unsigned int pwm_step_down[MOTOR_WHEELS];
+static volatile unsigned char pwm_slewing = FALSE;
+
 
 
 
 void PWM_EBRAKE(void){
-    PWM_REVERSE();
+    unsigned int interval = TB2CCR2_INTERVAL;
+
+    PWM_Set_Immediate(-MOTOR_SPEED(FAST), -MOTOR_SPEED(FAST));     // Brake pulse - no ramp
+    if (PWM_Reversing()) {
+        interval += PWM_DEAD_TB2;           // Pulse starts once the reversal reaches the CCRs
+    }
     ebraking = TRUE;
-    TB1CCTL1 &= ~CCIFG;                     // Clear possible pending interrupt
-    TB2CCR2 = TB2R + TB2CCR2_INTERVAL;      // Set first interrupt
+    TB2CCTL2 &= ~CCIFG;                     // Clear possible pending interrupt
+    TB2CCR2 = TB2R + interval;              // Set first interrupt
     TB2CCTL2 |= CCIE;                       // Enable TB2 CCR2 interrupt
 }
 
@@ -41,10 +56,7 @@ void PWM_EBRAKE(void){
 void Init_PWM(void) {
     PWM_PERIOD = WHEEL_PERIOD;
 
-    RIGHT_FORWARD_SPEED = WHEEL_OFF;
-    LEFT_FORWARD_SPEED = WHEEL_OFF;
-    LEFT_REVERSE_SPEED = WHEEL_OFF;
-    RIGHT_REVERSE_SPEED = WHEEL_OFF;
+    PWM_Set_Immediate(0, 0);
     
     left_motor_direction = MOTOR_OFF;
     right_motor_direction = MOTOR_OFF;
@@ -53,32 +65,154 @@ void Init_PWM(void) {
 }
 
 void PWM_Opening_Curve_Left (void) {
-    LEFT_REVERSE_SPEED = WHEEL_OFF;
-    RIGHT_REVERSE_SPEED = WHEEL_OFF;
-
-    LEFT_FORWARD_SPEED = LINE_SPEED;
-    RIGHT_FORWARD_SPEED = SLOW;
+    PWM_Set_Target(MOTOR_SPEED(LINE_SPEED), MOTOR_SPEED(SLOW));
 }
 
 void PWM_Opening_Curve_Right(void) {
-    LEFT_REVERSE_SPEED = WHEEL_OFF;
-    RIGHT_REVERSE_SPEED = WHEEL_OFF;
-
-    LEFT_FORWARD_SPEED = SLOW;
-    RIGHT_FORWARD_SPEED = LINE_SPEED;
+    PWM_Set_Target(MOTOR_SPEED(SLOW), MOTOR_SPEED(LINE_SPEED));
 }
 
 //==============================================================================
 // FUNCTION: Set_Wheel_Speeds
-// Low-level function to directly set PWM values
-// Does NOT handle direction change delays - use higher level functions
+// Low-level function to directly set PWM values (TB3 counts, no ramp)
+// Forward minus reverse per wheel - motor.c never drives both
 //==============================================================================
 void Set_Wheel_Speeds(unsigned int left_fwd, unsigned int left_rev,
                       unsigned int right_fwd, unsigned int right_rev) {
-    LEFT_FORWARD_SPEED = left_fwd;
-    LEFT_REVERSE_SPEED = left_rev;
-    RIGHT_FORWARD_SPEED = right_fwd;
-    RIGHT_REVERSE_SPEED = right_rev;
+    PWM_Set_Immediate(MOTOR_SPEED(left_fwd) - MOTOR_SPEED(left_rev),
+                      MOTOR_SPEED(right_fwd) - MOTOR_SPEED(right_rev));
+}
+
+//==============================================================================
+// OUTPUT STAGE (signed wheel speeds, motor.c units)
+// PWM_Set_Target plans a ramp: the wheel needing the most periods at full
+// rate (accel while speeding up, decel while slowing or reversing) sets the
+// length and the other wheel's rates are scaled down to finish with it. A
+// wheel starting from rest counts from PWM_BREAKAWAY. Anything else calling
+// motor.c directly (steering ISR, motion.c) takes that wheel over - the stage
+// sees the speed differ from what it set and leaves it alone.
+//==============================================================================
+static unsigned int PWM_Magnitude(int speed) {
+    return (speed < 0) ? (unsigned int)(-speed) : (unsigned int)speed;
+}
+
+static unsigned int PWM_Periods(unsigned int change, unsigned int rate) {
+    return (change / rate) + ((change % rate) ? 1 : 0);
+}
+
+void PWM_Set_Immediate(int left, int right) {
+    unsigned short interrupt_state = __get_SR_register() & GIE;
+
+    __disable_interrupt();
+    pwm_slewing = FALSE;
+    Motor_Set(left, right);
+    __bis_SR_register(interrupt_state);
+}
+
+void PWM_Set_Target(int left, int right) {
+#if PWM_USE_SLEW
+    unsigned short interrupt_state = __get_SR_register() & GIE;
+    unsigned int up[MOTOR_WHEELS], down[MOTOR_WHEELS], needed[MOTOR_WHEELS];
+    unsigned int periods = 1;
+    unsigned int from, to;
+    unsigned char wheel;
+
+    __disable_interrupt();
+    pwm_target[MOTOR_LEFT] = left;
+    pwm_target[MOTOR_RIGHT] = right;
+
+    for (wheel = 0; wheel < MOTOR_WHEELS; wheel++) {
+        pwm_output[wheel] = Motor_Get(wheel);
+        from = PWM_Magnitude(pwm_output[wheel]);
+        to = PWM_Magnitude(pwm_target[wheel]);
+        up[wheel] = 0;
+        down[wheel] = 0;
+        if ((from != 0) && ((to == 0) || ((pwm_output[wheel] < 0) != (pwm_target[wheel] < 0)))) {
+            down[wheel] = from;                     // Through zero
+            from = 0;
+        }
+        else if (to < from) {
+            down[wheel] = from - to;
+        }
+        if (to > from) {
+            if ((from < PWM_BREAKAWAY) && (to > PWM_BREAKAWAY)) from = PWM_BREAKAWAY;
+            up[wheel] = to - from;
+        }
+        needed[wheel] = PWM_Periods(down[wheel], PWM_SLEW_STEP(PWM_DECEL_MS)) + PWM_Periods(up[wheel], PWM_SLEW_STEP(PWM_ACCEL_MS));
+        if (needed[wheel] > periods) periods = needed[wheel];
+    }
+    for (wheel = 0; wheel < MOTOR_WHEELS; wheel++) {
+        pwm_step_down[wheel] = PWM_Periods(PWM_SLEW_STEP(PWM_DECEL_MS) * needed[wheel], periods);
+        pwm_step_up[wheel] = PWM_Periods(PWM_SLEW_STEP(PWM_ACCEL_MS) * needed[wheel], periods);
+        if (pwm_step_down[wheel] == 0) pwm_step_down[wheel] = 1;
+        if (pwm_step_up[wheel] == 0) pwm_step_up[wheel] = 1;
+    }
+    pwm_slewing = TRUE;
+    __bis_SR_register(interrupt_state);
+#else
+    PWM_Set_Immediate(left, right);
+#endif
+}
+
+// TB3 CCR0 ISR, after odometry has used the duty of the period just ended
+void PWM_Slew_Update(void) {
+    unsigned char done = TRUE;
+    unsigned int magnitude, to;
+    int output, target;
+    unsigned char wheel;
+
+    if (!pwm_slewing) return;
+
+    for (wheel = 0; wheel < MOTOR_WHEELS; wheel++) {
+        output = pwm_output[wheel];
+        target = pwm_target[wheel];
+        if (Motor_Get(wheel) != output) {           // Taken over by another writer
+            pwm_target[wheel] = Motor_Get(wheel);
+            pwm_output[wheel] = pwm_target[wheel];
+            continue;
+        }
+        if (output == target) continue;
+
+        magnitude = PWM_Magnitude(output);
+        to = PWM_Magnitude(target);
+        if ((output != 0) && ((target == 0) || ((output < 0) != (target < 0)))) {
+            to = 0;                                 // Slow to a stop first
+        }
+        if (to < magnitude) {
+            magnitude = ((magnitude - to) > pwm_step_down[wheel]) ? (magnitude - pwm_step_down[wheel]) : to;
+        }
+        else if (Motor_Settling(wheel)) {           // Reversing - wait out the dead time
+            done = FALSE;
+            continue;
+        }
+        else if ((magnitude < PWM_BREAKAWAY) && (to > PWM_BREAKAWAY)) {
+            magnitude = PWM_BREAKAWAY;              // From rest - no torque below this anyway
+        }
+        else {
+            magnitude = ((to - magnitude) > pwm_step_up[wheel]) ? (magnitude + pwm_step_up[wheel]) : to;
+        }
+
+        if (magnitude == 0) {
+            output = 0;
+        }
+        else {
+            output = ((output < 0) || ((output == 0) && (target < 0))) ? -(int)magnitude : (int)magnitude;
+        }
+        Motor_Set_Wheel(wheel, output);
+        pwm_output[wheel] = output;
+        if (output != target) done = FALSE;
+    }
+    if (done) {
+        pwm_slewing = FALSE;
+    }
+}
+
+unsigned char PWM_Slewing(void) {
+    return pwm_slewing;
+}
+
+unsigned char PWM_Reversing(void) {
+    return Motor_Settling(MOTOR_LEFT) || Motor_Settling(MOTOR_RIGHT);
 }
 
 //==============================================================================
@@ -107,10 +241,7 @@ static unsigned char Apply_Direction_Change_Delay(unsigned char new_left_dir,
     // If direction change detected, stop motors and wait
     if (delay_needed) {
         // Stop all motors
-        LEFT_FORWARD_SPEED = WHEEL_OFF;
-        LEFT_REVERSE_SPEED = WHEEL_OFF;
-        RIGHT_FORWARD_SPEED = WHEEL_OFF;
-        RIGHT_REVERSE_SPEED = WHEEL_OFF;
+        PWM_Set_Immediate(0, 0);
         
         // Wait 500ms for motor to fully stop
         safety_stop = 1;
@@ -128,10 +259,7 @@ static unsigned char Apply_Direction_Change_Delay(unsigned char new_left_dir,
 // Safely stop all motors and reset direction tracking
 //==============================================================================
 void Wheels_Safe_Stop(void) {
-    LEFT_FORWARD_SPEED = WHEEL_OFF;
-    LEFT_REVERSE_SPEED = WHEEL_OFF;
-    RIGHT_FORWARD_SPEED = WHEEL_OFF;
-    RIGHT_REVERSE_SPEED = WHEEL_OFF;
+    PWM_Set_Immediate(0, 0);                        // Emergency path - no ramp
     
     left_motor_direction = MOTOR_OFF;
     right_motor_direction = MOTOR_OFF;
@@ -184,10 +312,7 @@ void PWM_FORWARD(void) {
 //    Apply_Direction_Change_Delay(MOTOR_FORWARD, MOTOR_FORWARD);
     
     // Set motors to forward
-    LEFT_REVERSE_SPEED = WHEEL_OFF;
-    RIGHT_REVERSE_SPEED = WHEEL_OFF;
-    LEFT_FORWARD_SPEED = SLOW;
-    RIGHT_FORWARD_SPEED = FAST;
+    PWM_Set_Target(MOTOR_SPEED(SLOW), MOTOR_SPEED(FAST));
 }
 
 //==============================================================================
@@ -199,18 +324,13 @@ void PWM_REVERSE(void) {
 //    Apply_Direction_Change_Delay(MOTOR_REVERSE, MOTOR_REVERSE);
     
     // Set motors to reverse
-    LEFT_FORWARD_SPEED = WHEEL_OFF;
-    RIGHT_FORWARD_SPEED = WHEEL_OFF;
-    LEFT_REVERSE_SPEED = FAST;
-    RIGHT_REVERSE_SPEED = FAST;
+    PWM_Set_Target(-MOTOR_SPEED(FAST), -MOTOR_SPEED(FAST));
 }
 
 void PWM_REVERSE_PULSE(void) {
-    // Set motors to reverse
-    LEFT_FORWARD_SPEED = WHEEL_OFF;
-    RIGHT_FORWARD_SPEED = WHEEL_OFF;
-    LEFT_REVERSE_SPEED = LINE_SPEED;
-    RIGHT_REVERSE_SPEED = LINE_SPEED;
+    // Set motors to reverse - a brake, so no ramp. Open-ended (DRIVE_BACKUP
+    // stops it); a wheel coming out of forward starts after the dead time.
+    PWM_Set_Immediate(-MOTOR_SPEED(LINE_SPEED), -MOTOR_SPEED(LINE_SPEED));
 }
 
 
@@ -229,10 +349,7 @@ void PWM_FULLSTOP(void) {
 void PWM_TURN_RIGHT(void) {
 //    Apply_Direction_Change_Delay(MOTOR_FORWARD, MOTOR_FORWARD);
     
-    LEFT_FORWARD_SPEED = SLOW;
-    RIGHT_FORWARD_SPEED = WHEEL_OFF;
-    LEFT_REVERSE_SPEED = WHEEL_OFF;
-    RIGHT_REVERSE_SPEED = WHEEL_OFF;
+    PWM_Set_Target(MOTOR_SPEED(SLOW), 0);
 }
 
 //==============================================================================
@@ -242,10 +359,7 @@ void PWM_TURN_RIGHT(void) {
 void PWM_TURN_LEFT(void) {
 //    Apply_Direction_Change_Delay(MOTOR_FORWARD, MOTOR_FORWARD);
     
-    LEFT_FORWARD_SPEED = WHEEL_OFF;
-    RIGHT_FORWARD_SPEED = FAST;
-    LEFT_REVERSE_SPEED = WHEEL_OFF;
-    RIGHT_REVERSE_SPEED = WHEEL_OFF;
+    PWM_Set_Target(0, MOTOR_SPEED(FAST));
 }
 
 //==============================================================================
@@ -254,11 +368,7 @@ void PWM_TURN_LEFT(void) {
 //==============================================================================
 void PWM_ROTATE_RIGHT(void) {
 //    Apply_Direction_Change_Delay(MOTOR_FORWARD, MOTOR_REVERSE);
-    LEFT_REVERSE_SPEED = WHEEL_OFF;
-    RIGHT_FORWARD_SPEED = WHEEL_OFF;
-
-    LEFT_FORWARD_SPEED = LINE_SPEED;
-    RIGHT_REVERSE_SPEED = LINE_SPEED;
+    PWM_Set_Target(MOTOR_SPEED(LINE_SPEED), -MOTOR_SPEED(LINE_SPEED));
 }
 
 //==============================================================================
@@ -268,11 +378,7 @@ void PWM_ROTATE_RIGHT(void) {
 void PWM_ROTATE_LEFT(void) {
 //    Apply_Direction_Change_Delay(MOTOR_REVERSE, MOTOR_FORWARD);
     
-     LEFT_FORWARD_SPEED = WHEEL_OFF;
-    RIGHT_REVERSE_SPEED = WHEEL_OFF;
-
-    LEFT_REVERSE_SPEED = LINE_SPEED;
-    RIGHT_FORWARD_SPEED = LINE_SPEED;
+    PWM_Set_Target(-MOTOR_SPEED(LINE_SPEED), MOTOR_SPEED(LINE_SPEED));
 }
 
 //==============================================================================
@@ -282,10 +388,7 @@ void PWM_ROTATE_LEFT(void) {
 void PWM_NUDGE_LEFT(void) {
     Apply_Direction_Change_Delay(MOTOR_OFF, MOTOR_FORWARD);
     
-    LEFT_FORWARD_SPEED = WHEEL_OFF;
-    RIGHT_FORWARD_SPEED = SLOW;
-    LEFT_REVERSE_SPEED = WHEEL_OFF;
-    RIGHT_REVERSE_SPEED = WHEEL_OFF;
+    PWM_Set_Target(0, MOTOR_SPEED(SLOW));
 }
 
 //==============================================================================
@@ -295,10 +398,7 @@ void PWM_NUDGE_LEFT(void) {
 void PWM_NUDGE_RIGHT(void) {
     Apply_Direction_Change_Delay(MOTOR_FORWARD, MOTOR_OFF);
     
-    LEFT_FORWARD_SPEED = SLOW;
-    RIGHT_FORWARD_SPEED = WHEEL_OFF;
-    LEFT_REVERSE_SPEED = WHEEL_OFF;
-    RIGHT_REVERSE_SPEED = WHEEL_OFF;
+    PWM_Set_Target(MOTOR_SPEED(SLOW), 0);
 }
 
 //==============================================================================
@@ -312,10 +412,7 @@ void PWM_NUDGE_RIGHT(void) {
 // WARNING: Only use when you're certain no direction change is occurring
 //==============================================================================
 void PWM_FORWARD_IMMEDIATE(void) {
-    LEFT_FORWARD_SPEED = SLOW;
-    RIGHT_FORWARD_SPEED = SLOW;
-    LEFT_REVERSE_SPEED = WHEEL_OFF;
-    RIGHT_REVERSE_SPEED = WHEEL_OFF;
+    PWM_Set_Immediate(MOTOR_SPEED(SLOW), MOTOR_SPEED(SLOW));
     
     left_motor_direction = MOTOR_FORWARD;
     right_motor_direction = MOTOR_FORWARD;
@@ -327,10 +424,7 @@ void PWM_FORWARD_IMMEDIATE(void) {
 // WARNING: Only use when you're certain no direction change is occurring
 //==============================================================================
 void PWM_REVERSE_IMMEDIATE(void) {
-    LEFT_FORWARD_SPEED = WHEEL_OFF;
-    RIGHT_FORWARD_SPEED = WHEEL_OFF;
-    LEFT_REVERSE_SPEED = SLOW;
-    RIGHT_REVERSE_SPEED = SLOW;
+    PWM_Set_Immediate(-MOTOR_SPEED(SLOW), -MOTOR_SPEED(SLOW));
     
     left_motor_direction = MOTOR_REVERSE;
     right_motor_direction = MOTOR_REVERSE;
@@ -0,0 +1,345 @@
+/*
+ * autotune.c
+ *
+ *  Created on: Dec 13, 2025
+ *      Author: Dallas.Owens
+ *
+ *  Description: Relay-feedback (Astrom-Hagglund) auto-tune of the PD gains.
+ *               U0000 / U0001 arm it by selecting the relay controller; the
+ *               next run follows the line with a bang-bang steer (+/- a fixed
+ *               wheel offset, with hysteresis) which settles into a limit
+ *               cycle. The ADC ISR times each cycle between rising switches
+ *               and takes its error peak-to-peak. Once enough cycles are in,
+ *               the main loop turns period and amplitude into PD gains,
+ *               stores them in FRAM, reports them and hands the run back to
+ *               the PD on the new gains.
+ */
+
+#include "msp430.h"
+#include "macros.h"
+#include "functions.h"
+#include <string.h>
+#include "DAC.h"
+#include "control.h"
+#include "pid.h"
+#include "wheels.h"
+#include "steer_ctrl.h"
+#include "autotune.h"
+#include "fram.h"
+
+
+volatile autotune_state_t autotune_state = AUTOTUNE_IDLE;
+autotune_record_t autotune_result;
+steer_relay_params_t steer_relay_params;
+
+// Last tuned gains - loaded over the built-in ones at boot
+#pragma PERSISTENT(autotune_record)
+autotune_record_t autotune_record = { 0 };
+
+static unsigned int autotune_method = AUTOTUNE_ZN;
+
+// Measurement - written by the ADC ISR while AUTOTUNE_RUNNING
+static volatile signed char relay_out = 0;          // +1 right wheel fast, -1 left wheel fast, 0 not started
+static volatile unsigned char tune_switches = 0;    // Rising switches since reset
+static volatile unsigned char tune_measured = 0;    // Cycles in the sums
+static volatile unsigned int tune_updates = 0;      // Updates into the current cycle
+static volatile unsigned int tune_high = 0;         // ...of them with the relay high
+static volatile int relay_bias = 0;                 // Offset the relay swings about
+static volatile unsigned int tune_total = 0;        // Updates since reset (timeout)
+static volatile int tune_max = 0;                   // Error extremes of the current cycle
+static volatile int tune_min = 0;
+static volatile unsigned long tune_period_sum = 0;
+static volatile unsigned long tune_span_sum = 0;    // Peak-to-peak, twice the amplitude
+
+extern char adc_char[4];
+
+
+//==============================================================================
+// RELAY CONTROLLER (steer_controllers[STEER_CTRL_RELAY], ADC ISR)
+// Same sign as the PD: line LEFT (error > h) -> right wheel fast. The relay
+// only flips once the error crosses the far side of the hysteresis band.
+// Selected with K0003 it just oscillates - measuring needs U000n.
+// On a curve holding the line takes a steady wheel difference, so a relay
+// centred on zero sits longer on one side and the cycle it measures is
+// lopsided. Each cycle moves the centre (relay_bias) by half the high/low
+// time imbalance, so the swing settles about what the curve needs.
+//==============================================================================
+void Autotune_Relay_Init(void) {
+    steer_relay_params.base = STEER_RELAY_BASE;
+    steer_relay_params.amplitude = STEER_RELAY_AMPLITUDE;
+    steer_relay_params.hysteresis = STEER_RELAY_HYSTERESIS;
+    steer_relay_params.dac = STEER_DAC_STRAIGHT;
+}
+
+void Autotune_Relay_Reset(void) {
+    // Run start or back from a line loss - the cycle in progress is lost, start over
+    relay_out = 0;
+    relay_bias = 0;
+    if (autotune_state == AUTOTUNE_MEASURED) {
+        return;                                     // Sums not read by the main loop yet
+    }
+    tune_switches = 0;
+    tune_measured = 0;
+    tune_updates = 0;
+    tune_high = 0;
+    tune_total = 0;
+    tune_max = 0;
+    tune_min = 0;
+    tune_period_sum = 0;
+    tune_span_sum = 0;
+}
+
+static void Autotune_Cycle(int error) {
+    long shift;
+
+    // Rising switch - closes the cycle that started at the previous one
+    if ((autotune_state == AUTOTUNE_RUNNING) && (tune_switches > AUTOTUNE_SKIP_CYCLES)
+            && (tune_total >= AUTOTUNE_SETTLE)) {
+        tune_period_sum += tune_updates;
+        tune_span_sum += (long)tune_max - tune_min;
+        tune_measured++;
+        if (tune_measured >= AUTOTUNE_CYCLES) {
+            autotune_state = AUTOTUNE_MEASURED;
+        }
+    }
+    if ((tune_switches > 0) && (tune_updates > 0)) {
+        shift = ((long)steer_relay_params.amplitude * ((2 * (long)tune_high) - (long)tune_updates)) / (2 * (long)tune_updates);
+        relay_bias += (int)shift;
+        if (relay_bias > steer_relay_params.amplitude) relay_bias = steer_relay_params.amplitude;
+        if (relay_bias < -steer_relay_params.amplitude) relay_bias = -steer_relay_params.amplitude;
+    }
+    if (tune_switches < 0xFF) {
+        tune_switches++;
+    }
+    tune_updates = 0;
+    tune_high = 0;
+    tune_max = error;
+    tune_min = error;
+}
+
+void Autotune_Relay_Update(int error, int *left_speed, int *right_speed) {
+    int offset;
+
+    if (DAC_Get_Voltage() != steer_relay_params.dac) {
+        DAC_Set_Voltage(steer_relay_params.dac);
+    }
+
+    if ((error > steer_relay_params.hysteresis) && (relay_out <= 0)) {
+        relay_out = 1;
+        Autotune_Cycle(error);
+    }
+    else if ((error < -steer_relay_params.hysteresis) && (relay_out >= 0)) {
+        relay_out = -1;
+    }
+
+    if (error > tune_max) tune_max = error;
+    if (error < tune_min) tune_min = error;
+    if (tune_updates < 0xFFFF) {
+        tune_updates++;
+        if (relay_out > 0) tune_high++;
+    }
+    if ((autotune_state == AUTOTUNE_RUNNING) && (++tune_total >= AUTOTUNE_TIMEOUT)) {
+        autotune_state = AUTOTUNE_FAILED;           // No steady oscillation
+    }
+
+    offset = relay_bias;
+    if (relay_out > 0) offset += steer_relay_params.amplitude;
+    if (relay_out < 0) offset -= steer_relay_params.amplitude;
+    *left_speed = (int)steer_relay_params.base - offset;
+    *right_speed = (int)steer_relay_params.base + offset;
+}
+
+
+//==============================================================================
+// FRAM RECORD
+//==============================================================================
+static unsigned int Autotune_CRC(const autotune_record_t *record) {
+    return FRAM_CRC(record, AUTOTUNE_RECORD_WORDS, AUTOTUNE_CRC_SEED);
+}
+
+static void Autotune_Write(const autotune_record_t *record) {
+    FRAM_Record_Write(&autotune_record, record, AUTOTUNE_RECORD_WORDS, record->crc);
+}
+
+static void Autotune_Apply(const autotune_record_t *record) {
+    steer_pd_params.kp_gentle = record->kp_gentle;
+    steer_pd_params.kp_sharp = record->kp_sharp;
+    steer_pd_params.kd = record->kd;
+}
+
+unsigned char Autotune_Load(void) {
+    // Called once at boot after Steer_Ctrl_Init - ki and max correction stay as built
+    if (autotune_record.version != AUTOTUNE_RECORD_VERSION) return FALSE;
+    if (autotune_record.rate_hz != CONTROL_RATE_HZ) return FALSE;
+    if (Autotune_CRC(&autotune_record) != autotune_record.crc) return FALSE;
+
+    autotune_result = autotune_record;
+    Autotune_Apply(&autotune_result);
+    return TRUE;
+}
+
+
+//==============================================================================
+// START / CLEAR (IoT U command)
+//==============================================================================
+unsigned char Autotune_Start(unsigned int method) {
+    autotune_record_t record = { 0 };
+
+    if (method == AUTOTUNE_CLEAR) {
+        record.crc = Autotune_CRC(&record) ^ AUTOTUNE_CRC_SEED;     // Version 0 + bad CRC: never loads
+        Autotune_Write(&record);
+        autotune_state = AUTOTUNE_IDLE;
+        steer_controllers[STEER_CTRL_PD].init();    // steer_params.h gains
+        Steer_Ctrl_Select(STEER_CTRL_PD);
+        return TRUE;
+    }
+    if ((method != AUTOTUNE_ZN) && (method != AUTOTUNE_TL)) {
+        return FALSE;
+    }
+
+    autotune_method = method;
+    autotune_state = AUTOTUNE_RUNNING;
+    Steer_Ctrl_Select(STEER_CTRL_RELAY);            // Reset clears the sums
+    return TRUE;
+}
+
+
+//==============================================================================
+// GAINS
+// Describing function of a relay with hysteresis: Ku = 4d / (pi sqrt(a^2 - h^2)).
+// d is in PWM counts and a in error units, so Ku comes out in the PD's own
+// units (PWM counts per error unit). All unsigned - every term is positive.
+//==============================================================================
+static unsigned int Autotune_Sqrt(unsigned long value) {
+    unsigned long root = 0;
+    unsigned long bit = 1UL << 30;
+
+    while (bit > value) bit >>= 2;
+    while (bit) {
+        if (value >= root + bit) {
+            value -= root + bit;
+            root = (root >> 1) + bit;
+        }
+        else {
+            root >>= 1;
+        }
+        bit >>= 2;
+    }
+    return (unsigned int)root;
+}
+
+static int Autotune_Gain(unsigned long value) {
+    return (value > 32767) ? 32767 : (int)value;
+}
+
+static unsigned char Autotune_Compute(autotune_record_t *record) {
+    unsigned long tu = tune_period_sum / AUTOTUNE_CYCLES;
+    unsigned long a = tune_span_sum / (2 * AUTOTUNE_CYCLES);
+    unsigned long h = (unsigned long)steer_relay_params.hysteresis;
+    unsigned long a_eff, ku, kp, kd;
+
+    if ((a <= h) || (tu == 0)) return FALSE;      // Swing never cleared the band
+    a_eff = Autotune_Sqrt((a * a) - (h * h));
+    if (a_eff == 0) return FALSE;
+
+    ku = ((unsigned long)steer_relay_params.amplitude * ((4UL << PID_GAIN_SHIFT) * 1000)) / (3142UL * a_eff);
+    if (autotune_method == AUTOTUNE_TL) {
+        kp = (ku * 10) / 22;
+        kd = (kp * tu * 10) / 63;
+    }
+    else {
+        kp = (ku * 8) / 10;
+        kd = (kp * tu) / 8;
+    }
+    if (kp == 0) return FALSE;
+
+    record->version = AUTOTUNE_RECORD_VERSION;
+    record->rate_hz = CONTROL_RATE_HZ;
+    record->method = autotune_method;
+    record->ku = Autotune_Gain(ku);
+    record->tu = (tu > 0xFFFF) ? 0xFFFF : (unsigned int)tu;
+    record->amplitude = (int)a;
+    record->kp_gentle = Autotune_Gain(kp);
+    record->kp_sharp = Autotune_Gain((kp * STEER_KP_SHARP) / STEER_KP_GENTLE);
+    record->kd = Autotune_Gain(kd);
+    record->crc = Autotune_CRC(record);
+    return TRUE;
+}
+
+
+//==============================================================================
+// REPORT
+// UART: "Tune P0040 D0012" - whole STEER_KP_GENTLE / STEER_KD values, ready
+// to go into steer_params.h (Kd there is per 100ms of change, not per update).
+// LCD: rule, Ku, Tu in ms, Kp.
+//==============================================================================
+static void Autotune_Digits(char *dest, int value) {
+    HEXtoBCD((value > 9999) ? 9999 : value);
+    dest[0] = adc_char[0];
+    dest[1] = adc_char[1];
+    dest[2] = adc_char[2];
+    dest[3] = adc_char[3];
+}
+
+static void Autotune_Line(char line, const char *label, int value) {
+    strcpy(display_line[line - 1], label);
+    HEXtoBCD((value > 9999) ? 9999 : value);
+    adc_line(line, 6);
+}
+
+static void Autotune_Report(const autotune_record_t *record) {
+    char response[] = "Tune P0000 D0000\r\n";
+
+    Autotune_Digits(&response[6], record->kp_gentle >> PID_GAIN_SHIFT);
+    Autotune_Digits(&response[12], (record->kd >> PID_GAIN_SHIFT) / CONTROL_RATE_SCALE);
+    Send_Response(response);
+
+    strcpy(display_line[0], (record->method == AUTOTUNE_TL) ? "Tuned TL  " : "Tuned ZN  ");
+    Autotune_Line(2, "Ku        ", record->ku >> PID_GAIN_SHIFT);
+    Autotune_Line(3, "Tu ms     ", (int)(((unsigned long)record->tu * 1000) / CONTROL_RATE_HZ));
+    Autotune_Line(4, "Kp        ", record->kp_gentle >> PID_GAIN_SHIFT);
+    display_changed = TRUE;
+}
+
+
+//==============================================================================
+// PROCESS (Line_Follow_Process, every 100ms while driving)
+// The run carries on with the PD either way - on the new gains, or on the old
+// ones if the experiment failed. With STEER_USE_LUT the table is rebuilt from
+// the new gains on the next boot.
+//==============================================================================
+void Autotune_Process(void) {
+    autotune_record_t record;
+
+    switch (autotune_state) {
+        case AUTOTUNE_RUNNING:
+            if (steer_ctrl_active != STEER_CTRL_RELAY) {
+                autotune_state = AUTOTUNE_IDLE;     // Another controller picked with K - abandon
+            }
+            break;
+
+        case AUTOTUNE_MEASURED:
+            if (Autotune_Compute(&record)) {
+                Autotune_Write(&record);
+                autotune_result = record;
+                Autotune_Apply(&autotune_result);
+                Steer_Ctrl_Select(STEER_CTRL_PD);
+                Autotune_Report(&autotune_result);
+                autotune_state = AUTOTUNE_IDLE;
+                break;
+            }
+            autotune_state = AUTOTUNE_FAILED;
+            // fall through
+
+        case AUTOTUNE_FAILED:
+            Steer_Ctrl_Select(STEER_CTRL_PD);
+            Send_Response("Tune Failed\r\n");
+            strcpy(display_line[0], "Tune Fail ");
+            display_changed = TRUE;
+            autotune_state = AUTOTUNE_IDLE;
+            break;
+
+        default:
+            break;
+    }
+}
@@ -13,32 +13,46 @@
 #include "LCD.h"
 #include <string.h>
 #include "calibration.h"
+#include "fram.h"
 #include "switches.h"
 #include "wheels.h"
 #include "DAC.h"
+#include "motor.h"
 
 
 calib_state_t calib_state = CALIB_IDLE;
 
 volatile unsigned int calib_timer = 0;
 unsigned char calib_sample_count = 0;
-unsigned long calib_left_sum = 0;
-unsigned long calib_right_sum = 0;
+unsigned long calib_sum[LINE_SENSOR_COUNT];
 
 volatile unsigned char process_calibration = FALSE;
 
 // CALIBRATION Value storage
-unsigned int LEFT_BLACK_VALUE = 0;
-unsigned int LEFT_WHITE_VALUE = 0;
-unsigned int RIGHT_BLACK_VALUE = 0;
-unsigned int RIGHT_WHITE_VALUE = 0;
-unsigned int LEFT_THRESHOLD = 0;
-unsigned int RIGHT_THRESHOLD = 0;
+unsigned int LINE_BLACK_VALUE[LINE_SENSOR_COUNT];
+unsigned int LINE_WHITE_VALUE[LINE_SENSOR_COUNT];
+unsigned int LINE_THRESHOLD[LINE_SENSOR_COUNT];
+
+// NORMALIZATION (Q12 reciprocal of each sensor's black/white span)
+unsigned int LINE_NORM_RECIP[LINE_SENSOR_COUNT];    // 0 = span too small, fall back to threshold step
+static unsigned int norm_span[LINE_SENSOR_COUNT];   // Span the reciprocal was computed from
+unsigned int line_norm[LINE_SENSOR_COUNT];          // Latest samples in 0..NORM_FULL_SCALE
 
 volatile unsigned char calibrating = FALSE;
 unsigned char calibration_complete = FALSE;
 extern unsigned char display_menu;
 
+// ONLINE CALIBRATION (running black/white envelope while driving)
+unsigned char online_calibration_enabled = TRUE;
+unsigned char calibration_low_confidence = TRUE;
+static unsigned int online_min_q[LINE_SENSOR_COUNT];   // Envelope edges in 1/16 counts (ONLINE_SCALE_SHIFT)
+static unsigned int online_max_q[LINE_SENSOR_COUNT];
+static unsigned char online_sample_count = 0;
+
+// FRAM CALIBRATION RECORD (survives reset, lives in write-protected program FRAM)
+#pragma PERSISTENT(calib_record)
+calib_record_t calib_record = { 0 };
+
 //unsigned char exit_circle = FALSE;
 
 
@@ -50,8 +64,7 @@ void IR_Calibrate_Menu(void)
     calibrating = TRUE;
 
 //    drive_state = DRIVE_IDLE;               // For safety
-    LEFT_FORWARD_SPEED = WHEEL_OFF;
-    RIGHT_FORWARD_SPEED = WHEEL_OFF;
+    Motor_Stop();
 
 
     strcpy(display_line[0], "IR CALIBRT");
@@ -65,7 +78,25 @@ void IR_Calibrate_Menu(void)
     TB1CCTL1 |=  CCIE;                      // CCR1 enable interrupt
 }
 
+static void Calibration_Clear_Sums(void) {
+    unsigned int i;
+    for (i = 0; i < LINE_SENSOR_COUNT; i++) {
+        calib_sum[i] = 0;
+    }
+}
+
+
+static void Calibration_Accumulate(void) {
+    unsigned int i;
+    for (i = 0; i < LINE_SENSOR_COUNT; i++) {
+        calib_sum[i] += ADC_Line_Detect[i];
+    }
+    calib_sample_count++;
+}
+
+
 void IR_Calibrate_Process(void) {
+    unsigned int i;
 	if (!calibrating) return;               // Only process if calibrating
     switch (calib_state) 
     {
@@ -77,21 +108,18 @@ void IR_Calibrate_Process(void) {
             SW2_pressed = 0;
             calib_state = CALIB_SAMPLING_BLACK;
             calib_sample_count = 0;
-            calib_left_sum = 0;
-            calib_right_sum = 0;
+            Calibration_Clear_Sums();
         }
         break;
 
     case CALIB_SAMPLING_BLACK:
-        // calib_left_sum accumulates actual left sensor (CAR_Left_Detect)
-        // calib_right_sum accumulates actual right sensor (CAR_Right_Detect)
-        calib_left_sum += CAR_Left_Detect;
-        calib_right_sum += CAR_Right_Detect;
-        calib_sample_count++;
+        // calib_sum[i] accumulates ADC_Line_Detect[i] (car-left -> car-right)
+        Calibration_Accumulate();
 
         if (calib_sample_count >= SAMPLES) {
-            LEFT_BLACK_VALUE = calib_left_sum / SAMPLES;
-            RIGHT_BLACK_VALUE = calib_right_sum / SAMPLES;
+            for (i = 0; i < LINE_SENSOR_COUNT; i++) {
+                LINE_BLACK_VALUE[i] = calib_sum[i] / SAMPLES;
+            }
 
             strcpy(display_line[0], "BLACK Val ");
             strcpy(display_line[1], "L:        ");
@@ -126,23 +154,19 @@ void IR_Calibrate_Process(void) {
             SW2_pressed = 0;
             calib_state = CALIB_SAMPLING_WHITE;
             calib_sample_count = 0;
-            calib_left_sum = 0;
-            calib_right_sum = 0;
+            Calibration_Clear_Sums();
         }
         break;
 
     case CALIB_SAMPLING_WHITE:
-        // calib_left_sum accumulates actual left sensor (CAR_Left_Detect)
-        // calib_right_sum accumulates actual right sensor (CAR_Right_Detect)
-        calib_left_sum += CAR_Left_Detect;
-        calib_right_sum += CAR_Right_Detect;
-        calib_sample_count++;
+        // calib_sum[i] accumulates ADC_Line_Detect[i] (car-left -> car-right)
+        Calibration_Accumulate();
 
         if (calib_sample_count >= SAMPLES) {
-            LEFT_WHITE_VALUE = calib_left_sum / SAMPLES;
-            RIGHT_WHITE_VALUE = calib_right_sum / SAMPLES;
-            LEFT_THRESHOLD = (LEFT_BLACK_VALUE + LEFT_WHITE_VALUE) / 2;
-            RIGHT_THRESHOLD = (RIGHT_BLACK_VALUE + RIGHT_WHITE_VALUE) / 2;
+            for (i = 0; i < LINE_SENSOR_COUNT; i++) {
+                LINE_WHITE_VALUE[i] = calib_sum[i] / SAMPLES;
+                LINE_THRESHOLD[i] = (LINE_BLACK_VALUE[i] + LINE_WHITE_VALUE[i]) / 2;
+            }
 
             strcpy(display_line[0], "WHITE Val ");
             strcpy(display_line[1], "L:        ");
@@ -216,11 +240,12 @@ void IR_Calibrate_Process(void) {
 
         calibration_complete = TRUE;
         calibrating = FALSE;
+        IR_Normalize_Update();
+        Calibration_Save();                     // Keep for next power-up
 
         calib_state = CALIB_IDLE;
         calib_sample_count = 0;
-        calib_left_sum = 0;
-        calib_right_sum = 0;
+        Calibration_Clear_Sums();
 
         TB1CCTL1 &= ~CCIFG;                     // Clear possible pending interrupt
         TB1CCTL1 &= ~CCIE;                      // CCR1 enable interrupt
@@ -255,3 +280,212 @@ void Display_Calibration(void){
 
     display_changed = TRUE;
 }
+
+
+//==============================================================================
+// ONLINE CALIBRATION
+// Tracks a decaying min/max envelope per sensor while the car drives and
+// re-centres the thresholds between them. Black = envelope max, White = min.
+// Manual IR_Calibrate_Menu() values (if any) only seed the envelope.
+//==============================================================================
+void IR_Calibrate_Online_Reset(void) {
+    unsigned int i;
+
+    online_sample_count = 0;
+    calibration_low_confidence = TRUE;
+
+    if (calibration_complete) {                             // Seed from last known good calibration
+        for (i = 0; i < LINE_SENSOR_COUNT; i++) {
+            online_min_q[i] = LINE_WHITE_VALUE[i] << ONLINE_SCALE_SHIFT;
+            online_max_q[i] = LINE_BLACK_VALUE[i] << ONLINE_SCALE_SHIFT;
+        }
+        online_sample_count = 1;                            // Skip first-sample seeding below
+    }
+    else {                                                  // Nothing known yet - fall back to fixed thresholds
+        for (i = 0; i < LINE_SENSOR_COUNT; i++) {
+            LINE_THRESHOLD[i] = (i < LINE_CENTER_RIGHT) ? DETECT_THRESH_LEFT : DETECT_THRESH_RIGHT;
+            LINE_BLACK_VALUE[i] = LINE_WHITE_VALUE[i] = 0;
+        }
+    }
+    IR_Normalize_Update();
+}
+
+
+static unsigned char Online_Track(unsigned int sample, unsigned int *min_q, unsigned int *max_q,
+                                  unsigned int *black, unsigned int *white, unsigned int *threshold) {
+    unsigned int sample_q = sample << ONLINE_SCALE_SHIFT;
+    unsigned int decay = (*max_q - *min_q) >> ONLINE_DECAY_SHIFT;
+
+    if (sample_q > *max_q) { *max_q = sample_q; }           // New black extreme
+    else                   { *max_q -= decay; }             // Otherwise relax toward white
+    if (sample_q < *min_q) { *min_q = sample_q; }           // New white extreme
+    else                   { *min_q += decay; }             // Otherwise relax toward black
+
+    if (((*max_q - *min_q) >> ONLINE_SCALE_SHIFT) < ONLINE_MIN_SPAN) {
+        return FALSE;                                       // Not enough contrast seen - keep old threshold
+    }
+
+    *black = *max_q >> ONLINE_SCALE_SHIFT;
+    *white = *min_q >> ONLINE_SCALE_SHIFT;
+    *threshold = (*black + *white) >> 1;
+    return TRUE;
+}
+
+
+void IR_Calibrate_Online_Update(void) {
+    // Called once per new ADC scan while line following (ADC_Line_Detect[])
+    unsigned int i;
+    unsigned char sensor_ok;
+    unsigned char any_ok = FALSE;
+    unsigned char center_ok = TRUE;
+
+    if (!online_calibration_enabled || calibrating) return;
+
+    if (online_sample_count == 0) {                         // First sample - collapse envelope onto it
+        for (i = 0; i < LINE_SENSOR_COUNT; i++) {
+            online_min_q[i] = online_max_q[i] = ADC_Line_Detect[i] << ONLINE_SCALE_SHIFT;
+        }
+    }
+    if (online_sample_count < ONLINE_MIN_SAMPLES) {
+        online_sample_count++;
+    }
+
+    for (i = 0; i < LINE_SENSOR_COUNT; i++) {
+        sensor_ok = Online_Track(ADC_Line_Detect[i], &online_min_q[i], &online_max_q[i],
+                                 &LINE_BLACK_VALUE[i], &LINE_WHITE_VALUE[i], &LINE_THRESHOLD[i]);
+        any_ok |= sensor_ok;
+        if ((i == LINE_CENTER_LEFT) || (i == LINE_CENTER_RIGHT)) {
+            center_ok &= sensor_ok;                         // Outer sensors may rarely see the line
+        }
+    }
+
+    unsigned char was_low_confidence = calibration_low_confidence;
+    if (any_ok) {
+        IR_Normalize_Update();                              // Cheap unless a span moved past tolerance
+    }
+
+    calibration_low_confidence = !(center_ok && (online_sample_count >= ONLINE_MIN_SAMPLES));
+    if (!calibration_low_confidence) {
+        calibration_complete = TRUE;                        // Envelope now as good as a manual calibration
+        if (was_low_confidence) {
+            Calibration_Save();                             // Only on confidence gain - not every sample
+        }
+    }
+}
+
+
+//==============================================================================
+// SENSOR NORMALIZATION
+// Maps each sensor onto 0..NORM_FULL_SCALE using its own black/white span so
+// the controller sees the same units from both sides. The division happens
+// here, only when a span moves; per-sample work is one 16x16 hardware multiply.
+//==============================================================================
+static unsigned int Norm_Recip(unsigned int black, unsigned int white, unsigned int *span_used) {
+    unsigned int span = (black > white) ? (black - white) : 0;
+    if (span < NORM_MIN_SPAN) {
+        *span_used = 0;
+        return 0;                                           // Too little contrast - IR_Normalize steps at threshold
+    }
+    *span_used = span;
+    return (unsigned int)(((unsigned long)NORM_FULL_SCALE << NORM_RECIP_SHIFT) / span);
+}
+
+
+static unsigned char Norm_Span_Moved(unsigned int black, unsigned int white, unsigned int span_used) {
+    unsigned int span = (black > white) ? (black - white) : 0;
+    unsigned int delta = (span > span_used) ? (span - span_used) : (span_used - span);
+    return (delta > NORM_SPAN_TOLERANCE);
+}
+
+
+void IR_Normalize_Update(void) {
+    unsigned int i;
+    for (i = 0; i < LINE_SENSOR_COUNT; i++) {
+        if (Norm_Span_Moved(LINE_BLACK_VALUE[i], LINE_WHITE_VALUE[i], norm_span[i])) {
+            LINE_NORM_RECIP[i] = Norm_Recip(LINE_BLACK_VALUE[i], LINE_WHITE_VALUE[i], &norm_span[i]);
+        }
+    }
+}
+
+
+unsigned int IR_Normalize(unsigned int sample, unsigned int white, unsigned int black,
+                          unsigned int threshold, unsigned int recip) {
+    if (recip == 0) {                                       // No usable span - binary on/off line
+        return (sample > threshold) ? NORM_FULL_SCALE : 0;
+    }
+    if (sample <= white) return 0;
+    if (sample >= black) return NORM_FULL_SCALE;
+
+    // (sample - white) < span <= 1023, recip <= 65015: product fits 32 bits
+    return (unsigned int)(((unsigned long)(sample - white) * recip) >> NORM_RECIP_SHIFT);
+}
+
+
+void IR_Normalize_Sample(void) {
+    unsigned int i;
+    for (i = 0; i < LINE_SENSOR_COUNT; i++) {
+        line_norm[i] = IR_Normalize(ADC_Line_Detect[i], LINE_WHITE_VALUE[i], LINE_BLACK_VALUE[i],
+                                    LINE_THRESHOLD[i], LINE_NORM_RECIP[i]);
+    }
+}
+
+
+//==============================================================================
+// FRAM CALIBRATION STORAGE
+// Record is CRC16 checked with the hardware CRC module. The CRC word is written
+// last so a reset mid-write leaves a record that fails the check.
+//==============================================================================
+static unsigned int Calibration_CRC(const calib_record_t *record) {
+    return FRAM_CRC(record, CALIB_RECORD_WORDS, CALIB_CRC_SEED);
+}
+
+
+static void Calibration_Write(const calib_record_t *record) {
+    FRAM_Record_Write(&calib_record, record, CALIB_RECORD_WORDS, record->crc);
+}
+
+
+unsigned char Calibration_Load(void) {
+    // Called once at boot - returns TRUE and marks calibration complete if record is valid
+    unsigned int i;
+
+    if (calib_record.version != CALIB_RECORD_VERSION) return FALSE;
+    if (Calibration_CRC(&calib_record) != calib_record.crc) return FALSE;
+
+    for (i = 0; i < LINE_SENSOR_COUNT; i++) {
+        LINE_BLACK_VALUE[i] = calib_record.black[i];
+        LINE_WHITE_VALUE[i] = calib_record.white[i];
+        LINE_THRESHOLD[i] = calib_record.threshold[i];
+    }
+    IR_Normalize_Update();
+    calibration_complete = TRUE;
+    return TRUE;
+}
+
+
+void Calibration_Save(void) {
+    calib_record_t record;
+    unsigned int i;
+
+    record.version = CALIB_RECORD_VERSION;
+    for (i = 0; i < LINE_SENSOR_COUNT; i++) {
+        record.black[i] = LINE_BLACK_VALUE[i];
+        record.white[i] = LINE_WHITE_VALUE[i];
+        record.threshold[i] = LINE_THRESHOLD[i];
+    }
+    record.crc = Calibration_CRC(&record);
+
+    Calibration_Write(&record);
+}
+
+
+void Calibration_Invalidate(void) {
+    // IoT command 'V' - forget stored calibration (RAM values and FRAM record)
+    calib_record_t record = { 0 };
+
+    record.crc = Calibration_CRC(&record) ^ CALIB_CRC_SEED;     // Version 0 + bad CRC: never loads
+    Calibration_Write(&record);
+
+    calibration_complete = FALSE;
+    IR_Calibrate_Online_Reset();
+}
@@ -0,0 +1,109 @@
+/*
+ * control.c
+ *
+ *  Created on: Dec 7, 2025
+ *      Author: Dallas.Owens
+ *
+ *  Description: Fixed-rate steering loop. TB1 CCR0 starts an ADC scan every
+ *               CONTROL_TICK_INTERVAL; the ADC ISR calls Control_Update() when
+ *               the last line sensor is in, so the PD sees a sample that is at
+ *               most one scan old. Drive states, timers and display stay in
+ *               the 100ms main loop (Line_Follow_Process).
+ */
+
+#include "msp430.h"
+#include "macros.h"
+#include "functions.h"
+#include "timers.h"
+#include "ADC.h"
+#include "calibration.h"
+#include "line_sensor.h"
+#include "wheels.h"
+#include "steer_ctrl.h"
+#include "control.h"
+
+
+volatile unsigned char control_active = FALSE;
+volatile unsigned char control_steering = FALSE;
+volatile unsigned int control_cycles = 0;
+volatile unsigned int control_cycles_max = 0;
+volatile unsigned int control_overruns = 0;
+volatile unsigned int control_missed_ticks = 0;
+
+extern volatile unsigned char ADC_Channel;
+
+
+void Control_Start(void) {
+    control_steering = FALSE;               // Drive state machine enables steering
+    control_cycles_max = 0;
+    control_overruns = 0;
+    control_missed_ticks = 0;
+    Line_Follow_Steer_Reset();
+
+    control_active = TRUE;
+    TB1CCTL0 &= ~CCIFG;                     // Clear possible pending interrupt
+    TB1CCR0 = TB1R + CONTROL_TICK_INTERVAL;
+    Sample_ADC();                           // Enables TB1 CCR0
+}
+
+
+void Control_Stop(void) {
+    control_steering = FALSE;
+    control_active = FALSE;
+    Stop_ADC();
+}
+
+
+//==============================================================================
+// STEERING UPDATE
+// Runs in the ADC ISR once per scan. Only the per-sample work lives here:
+// normalize, centroid, PD. Online calibration (slow envelope) stays in the
+// main loop. Cost is measured on TB3R (SMCLK = MCLK, 1 tick = 1 cycle).
+//==============================================================================
+void Control_Update(void) {
+    unsigned int start = CYCLE_STAMP();
+    unsigned int end;
+    unsigned int cycles;
+#if CONTROL_DIVIDER > 1
+    static unsigned char control_skip = 0;
+
+    if (++control_skip < CONTROL_DIVIDER) return;  // Scan not used for steering
+    control_skip = 0;
+#endif
+
+    IR_Normalize_Sample();
+    Line_Position_Update();
+    if (control_steering) {
+        if (line_lost) {
+            Line_Follow_Search();                   // Arc toward where the line went
+        }
+        else {
+            Line_Follow_Steer();                    // Active controller (steer_ctrl.c)
+        }
+    }
+
+    end = CYCLE_STAMP();
+    cycles = CYCLES_SINCE(start, end);
+    control_cycles = cycles;
+    if (cycles > control_cycles_max) {
+        control_cycles_max = cycles;
+    }
+    if (cycles > CONTROL_BUDGET_CYCLES) {
+        control_overruns++;
+    }
+}
+
+
+// ----------------- TIMER B1 - 0 ----------------
+// ----------- CONTROL_TICK_INTERVAL -------------
+#pragma vector = TIMER_B1_CCR0_VECTOR
+__interrupt void TIMER_B1_CCR0_ISR(void) {      // TB1 CCR0 - scan trigger
+    TB1CCR0 += CONTROL_TICK_INTERVAL;                   // ADD OFFSET TO TBCCR0
+    if (!sample_adc) { return; }
+
+    if (ADC_Channel != 0) {                             // Last scan still converting
+        control_missed_ticks++;
+        return;
+    }
+    ADCCTL0 |= ADCENC | ADCSC;                          // Start scan (input already set to slot 0)
+}
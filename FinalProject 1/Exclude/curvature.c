@@ -0,0 +1,98 @@
+/*
+ * curvature.c
+ *
+ *  Created on: Dec 10, 2025
+ *      Author: Dallas.Owens
+ *
+ *  Description: Path curvature from the commanded wheel speeds.
+ *               Each steering update adds its wheel difference and wheel sum to
+ *               two leaky integrators. Their ratio is the distance-weighted mean
+ *               of (right - left) / (right + left) - the turn rate per unit of
+ *               travel - so it reads the same at any base speed.
+ *               The main loop turns that into an "on the circle" decision with
+ *               hysteresis, a confidence count and a minimum arc length.
+ */
+
+#include "msp430.h"
+#include "macros.h"
+#include "wheels.h"
+#include "curvature.h"
+
+
+int curvature = 0;
+unsigned char circle_confidence = 0;
+unsigned long circle_arc = 0;
+
+static volatile long curve_diff = 0;                // Leaky sum of (right - left)
+static volatile long curve_sum = 0;                 // Leaky sum of (right + left)
+static volatile unsigned long curve_distance = 0;   // Total travel, wraps
+static unsigned long last_distance = 0;
+
+
+void Curvature_Reset(void) {
+    unsigned short interrupt_state = __get_SR_register() & GIE;
+    __disable_interrupt();
+    curve_diff = 0;
+    curve_sum = 0;
+    last_distance = curve_distance;
+    __bis_SR_register(interrupt_state);
+
+    curvature = 0;
+    circle_confidence = 0;
+    circle_arc = 0;
+}
+
+
+//==============================================================================
+// INTEGRATE (per steering update)
+// x += input - x / 2^CURVE_WINDOW_SHIFT on both sums, so old path fades out
+// over the window and the ratio never needs a divide in the ISR.
+//==============================================================================
+void Curvature_Update(unsigned int left, unsigned int right) {
+    curve_diff += ((long)right - (long)left) - (curve_diff >> CURVE_WINDOW_SHIFT);
+    curve_sum += ((long)right + (long)left) - (curve_sum >> CURVE_WINDOW_SHIFT);
+    curve_distance += ((unsigned long)left + right) >> 1;
+}
+
+
+//==============================================================================
+// CIRCLE CHECK (100ms main loop)
+//==============================================================================
+unsigned char Curvature_Check(void) {
+    long diff, sum;
+    unsigned long distance, travelled;
+    unsigned short interrupt_state = __get_SR_register() & GIE;
+
+    __disable_interrupt();                          // 32-bit values written by the ADC ISR
+    diff = curve_diff;
+    sum = curve_sum;
+    distance = curve_distance;
+    __bis_SR_register(interrupt_state);
+
+    travelled = distance - last_distance;           // Wrap safe
+    last_distance = distance;
+
+    if (sum < CURVE_MIN_SUM) {
+        curvature = 0;                              // Barely moving - no heading change to measure
+    }
+    else {
+        curvature = (int)((diff * (CURVE_SCALE / 8)) / (sum >> 3));   // diff x 1000 could overflow 32 bits
+    }
+
+    if (curvature >= CURVE_ENTER) {
+        circle_confidence += CIRCLE_CONF_GAIN;
+        if (circle_confidence > CIRCLE_CONF_MAX) circle_confidence = CIRCLE_CONF_MAX;
+        circle_arc += travelled;
+    }
+    else if (curvature < CURVE_EXIT) {
+        circle_confidence = (circle_confidence > CIRCLE_CONF_DECAY) ? (circle_confidence - CIRCLE_CONF_DECAY) : 0;
+        if (circle_confidence == 0) {
+            circle_arc = 0;                         // Curve ended - next one starts from scratch
+        }
+    }
+    else if (circle_confidence) {
+        circle_arc += travelled;                    // Between thresholds - still the same curve
+    }
+
+    return (circle_confidence >= CIRCLE_CONF_MIN) && (circle_arc >= CIRCLE_MIN_ARC);
+}
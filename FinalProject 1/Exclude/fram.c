@@ -0,0 +1,58 @@
+/*
+ * fram.c
+ *
+ *  Created on: Dec 18, 2025
+ *      Author: Dallas.Owens
+ *
+ *  Description: Shared write path for the FRAM records.
+ *               Records live in .TI.persistent, which is program FRAM and
+ *               write protected (PFWP) from startup. A write opens it with
+ *               interrupts off, invalidates the stored CRC, copies the words,
+ *               writes the CRC last and puts SYSCFG0 back as it was - a reset
+ *               part way through leaves a record that fails its check.
+ */
+
+#include "msp430.h"
+#include "fram.h"
+
+
+unsigned int FRAM_CRC(const void *data, unsigned int words, unsigned int seed) {
+    const unsigned int *word = (const unsigned int *)data;
+    unsigned int i;
+
+    CRCINIRES = seed;
+    for (i = 0; i < words; i++) {
+        CRCDI = word[i];
+    }
+    return CRCINIRES;
+}
+
+
+void FRAM_Unlock(fram_lock_t *lock) {
+    lock->interrupt_state = __get_SR_register() & GIE;
+    __disable_interrupt();                  // No ISR may run while program FRAM is writable
+    lock->protect = SYSCFG0 & FRAM_PROTECT_BITS;
+    SYSCFG0 = FRWPPW | (lock->protect & ~PFWP);
+}
+
+
+void FRAM_Relock(const fram_lock_t *lock) {
+    SYSCFG0 = FRWPPW | lock->protect;       // Protection and FRWPOA boundary as they were
+    __bis_SR_register(lock->interrupt_state);
+}
+
+
+void FRAM_Record_Write(void *record, const void *image, unsigned int words, unsigned int crc) {
+    const unsigned int *src = (const unsigned int *)image;
+    unsigned int *dst = (unsigned int *)record;
+    fram_lock_t lock;
+    unsigned int i;
+
+    FRAM_Unlock(&lock);
+    dst[words] = ~crc;                      // Invalidate first in case we reset mid-copy
+    for (i = 0; i < words; i++) {
+        dst[i] = src[i];
+    }
+    dst[words] = crc;                       // Commit
+    FRAM_Relock(&lock);
+}
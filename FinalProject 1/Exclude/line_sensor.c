@@ -0,0 +1,96 @@
+/*
+ * line_sensor.c
+ *
+ *  Created on: Dec 6, 2025
+ *      Author: Dallas.Owens
+ *
+ *  Description: Weighted-centroid line position across the IR sensor array.
+ *               Works on line_norm[] (IR_Normalize_Sample) so every sensor is
+ *               in the same 0..NORM_FULL_SCALE units regardless of its own span.
+ */
+
+#include "msp430.h"
+#include "macros.h"
+#include "functions.h"
+#include "ADC.h"
+#include "calibration.h"
+#include "line_sensor.h"
+
+
+int line_position = 0;                          // -LINE_POS_LOST..+LINE_POS_LOST, + = line under car-left
+unsigned char line_lost = TRUE;
+volatile unsigned int line_position_cycles = 0; // Last Line_Position_Update cost (TB3R = SMCLK, 1 tick = 1 cycle)
+
+// Position of each sensor, index matches ADC_Line_Detect[] (car-left -> car-right)
+static const int line_sensor_pos[LINE_SENSOR_COUNT] = {
+#if LINE_SENSOR_COUNT == 2
+    1000, -1000
+#elif LINE_SENSOR_COUNT == 4
+    1000, 333, -333, -1000
+#elif LINE_SENSOR_COUNT == 6
+    1000, 600, 200, -200, -600, -1000
+#endif
+};
+
+
+//==============================================================================
+// LINE POSITION
+// Centroid of the normalized readings above LINE_NOISE_FLOOR. The divisor never
+// drops below one fully-black sensor (LINE_EDGE_WEIGHT) so a faint reading from a
+// single sensor gives a proportionally small offset instead of a full-pitch jump.
+// On the 2 sensor board this keeps the sign and zero of the old
+// (left - threshold) - (right - threshold) error but not its scale: it is
+// 1000 x (wL - wR) / max(wL + wR, 900), w = normalized reading less the floor -
+// linear in the difference while little of the line is seen, the ratio of the
+// two once both see it, +/-1000 with one sensor on the tape.
+// line_lost is also not the old "both sensors below threshold": it is set when
+// the total weight above the floor is under LINE_LOST_WEIGHT (150), so a
+// sensor just short of its threshold still counts as seeing the line.
+// Past the outermost sensor the position is interpolated from how much of the
+// line that sensor still sees; once too little is seen the last side is held.
+//==============================================================================
+int Line_Position_Update(void) {
+    unsigned int start = CYCLE_STAMP();
+    unsigned int end;
+    unsigned int weight[LINE_SENSOR_COUNT];
+    unsigned int total = 0;
+    unsigned int divisor;
+    long weighted = 0;
+    unsigned char peak = 0;
+    unsigned char i;
+
+    for (i = 0; i < LINE_SENSOR_COUNT; i++) {
+        weight[i] = (line_norm[i] > LINE_NOISE_FLOOR) ? (line_norm[i] - LINE_NOISE_FLOOR) : 0;
+        total += weight[i];
+        weighted += (long)weight[i] * line_sensor_pos[i];      // 16x16 hardware multiply
+        if (weight[i] > weight[peak]) {
+            peak = i;
+        }
+    }
+
+    if (total < LINE_LOST_WEIGHT) {
+        line_lost = TRUE;                                       // Hold the side the line was last seen on
+        line_position = (line_position >= 0) ? LINE_POS_LOST : -LINE_POS_LOST;
+    }
+#if LINE_SENSOR_COUNT > 2
+    else if ((peak == 0) && (weight[1] == 0)) {                 // Only the outer car-left sensor sees it
+        line_lost = FALSE;
+        line_position = LINE_POS_MAX
+                      + (int)(((unsigned long)(LINE_EDGE_WEIGHT - weight[0]) * (LINE_SENSOR_PITCH / 2)) / LINE_EDGE_WEIGHT);
+    }
+    else if ((peak == (LINE_SENSOR_COUNT - 1)) && (weight[LINE_SENSOR_COUNT - 2] == 0)) {   // Outer car-right
+        line_lost = FALSE;
+        line_position = -LINE_POS_MAX
+                      - (int)(((unsigned long)(LINE_EDGE_WEIGHT - weight[peak]) * (LINE_SENSOR_PITCH / 2)) / LINE_EDGE_WEIGHT);
+    }
+#endif
+    else {
+        line_lost = FALSE;
+        divisor = (total > LINE_EDGE_WEIGHT) ? total : LINE_EDGE_WEIGHT;
+        line_position = (int)(weighted / (long)divisor);
+    }
+
+    end = CYCLE_STAMP();
+    line_position_cycles = CYCLES_SINCE(start, end);
+    return line_position;
+}
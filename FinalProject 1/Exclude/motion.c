@@ -0,0 +1,200 @@
+/*
+ * motion.c
+ *
+ *  Created on: Dec 15, 2025
+ *      Author: Dallas.Owens
+ *
+ *  Description: Move a set distance or turn a set angle.
+ *               Runs on the odometry tick: each PWM period the remaining
+ *               distance (or wheel arc) sets the profile speed - trapezoid
+ *               with a slow final approach - and the inverse wheel model
+ *               turns it into duty for the present supply. Straight moves
+ *               also hold the heading they started on. Done means the
+ *               odometry estimate reached the target; the queue sees it as
+ *               command_complete, like a timed F/B/R/L.
+ */
+
+#include "msp430.h"
+#include "macros.h"
+#include "functions.h"
+#include "DAC.h"
+#include "odometry.h"
+#include "motion.h"
+#include "motor.h"
+
+
+typedef enum {
+    MOTION_IDLE,
+    MOTION_STRAIGHT,
+    MOTION_ROTATE
+} motion_type_t;
+
+static volatile motion_type_t motion_type = MOTION_IDLE;
+static signed char motion_dir = 1;                  // Straight: +1 forward. Rotate: +1 left
+static unsigned long motion_target = 0;             // Straight: um. Rotate: 16-bit binary angle units
+static unsigned long motion_mark = 0;               // Odometry distance at the start
+static unsigned int motion_heading_mark = 0;        // Heading at the start
+static unsigned int motion_heading_last = 0;
+static long motion_turned = 0;                      // Rotate progress, binary angle (can pass 180)
+static unsigned int motion_speed = 0;               // Profile speed, Q4 mm/s
+static unsigned int motion_ticks = 0;
+static unsigned int motion_limit = 0;               // Ticks before giving up (stalled)
+
+extern volatile unsigned char command_complete;
+
+
+//==============================================================================
+// OUTPUT
+// Signed mm/s per wheel -> duty from the wheel model -> motor.c speed
+//==============================================================================
+static void Motion_Wheel(unsigned char wheel, int speed, unsigned int kv) {
+    int output;
+
+    if (speed >= 0) {
+        output = MOTOR_SPEED(Odometry_Wheel_Duty((unsigned int)speed, kv));
+    }
+    else {
+        output = -MOTOR_SPEED(Odometry_Wheel_Duty((unsigned int)(-speed), kv));
+    }
+    Motor_Set_Wheel(wheel, output);
+}
+
+static void Motion_Finish(void) {
+    motion_type = MOTION_IDLE;
+    Motor_Stop();
+    command_complete = TRUE;                        // Process_Queue stops and moves on
+}
+
+
+//==============================================================================
+// PROFILE
+// Speed rises by one accel step per tick up to the cruise speed, and falls by
+// one once it could only just brake to the approach speed in the distance
+// left before the approach zone:  v^2 >= v_app^2 + 2 a (remaining - approach)
+//==============================================================================
+static unsigned int Motion_Profile(long remaining) {
+    unsigned long speed = motion_speed + MOTION_ACCEL_STEP;
+    unsigned long whole, brake;
+    long beyond = (remaining / 1000) - MOTION_APPROACH_MM;     // mm left before the approach
+
+    if (beyond <= 0) {
+        return (unsigned int)MOTION_APPROACH_SPEED << MOTION_SPEED_SHIFT;
+    }
+    if (speed > ((unsigned long)MOTION_MAX_SPEED << MOTION_SPEED_SHIFT)) {
+        speed = (unsigned long)MOTION_MAX_SPEED << MOTION_SPEED_SHIFT;
+    }
+
+    whole = motion_speed >> MOTION_SPEED_SHIFT;
+    brake = ((unsigned long)MOTION_APPROACH_SPEED * MOTION_APPROACH_SPEED) + (2UL * MOTION_ACCEL * (unsigned long)beyond);
+    if ((whole * whole) >= brake) {
+        speed = (motion_speed > MOTION_ACCEL_STEP) ? (motion_speed - MOTION_ACCEL_STEP) : 0;
+    }
+    if (speed < ((unsigned long)MOTION_APPROACH_SPEED << MOTION_SPEED_SHIFT)) {
+        speed = (unsigned long)MOTION_APPROACH_SPEED << MOTION_SPEED_SHIFT;
+    }
+    return (unsigned int)speed;
+}
+
+
+//==============================================================================
+// UPDATE (TB3 CCR0 ISR, after Odometry_Update)
+//==============================================================================
+void Motion_Update(void) {
+    unsigned int heading;
+    long remaining;
+    int speed, correction;
+
+    if (motion_type == MOTION_IDLE) {
+        return;
+    }
+
+    heading = Odometry_Heading();
+    if (motion_type == MOTION_STRAIGHT) {
+        remaining = (long)(motion_target - (Odometry_Distance() - motion_mark));
+    }
+    else {
+        motion_turned += (short)(heading - motion_heading_last);   // Wrap safe per tick (16-bit, also on the host)
+        motion_heading_last = heading;
+        remaining = (((long)motion_target - (motion_turned * motion_dir)) * (long)MOTION_ARC_SCALE) >> 10;
+    }
+
+    if ((remaining <= 0) || (++motion_ticks >= motion_limit)) {
+        Motion_Finish();
+        return;
+    }
+
+    motion_speed = Motion_Profile(remaining);
+    speed = (int)(motion_speed >> MOTION_SPEED_SHIFT);
+
+    if (motion_type == MOTION_STRAIGHT) {
+        // Drifted left (positive) -> left wheel faster, right slower, either direction of travel
+        correction = (int)(((long)(short)(heading - motion_heading_mark) * MOTION_HEADING_GAIN) >> 8);
+        if (correction > speed) correction = speed;
+        if (correction < -speed) correction = -speed;
+        Motion_Wheel(MOTOR_LEFT, (motion_dir * speed) + correction, ODOM_KV_LEFT);
+        Motion_Wheel(MOTOR_RIGHT, (motion_dir * speed) - correction, ODOM_KV_RIGHT);
+    }
+    else {
+        Motion_Wheel(MOTOR_LEFT, -(motion_dir * speed), ODOM_KV_LEFT);
+        Motion_Wheel(MOTOR_RIGHT, motion_dir * speed, ODOM_KV_RIGHT);
+    }
+}
+
+
+//==============================================================================
+// START / STOP (main loop - IoT M/N/H/J)
+//==============================================================================
+static void Motion_Begin(motion_type_t type, int amount, unsigned long target, unsigned int limit_mm) {
+    unsigned short interrupt_state = __get_SR_register() & GIE;
+    unsigned long limit_ms = (((unsigned long)limit_mm * 2000) / MOTION_MAX_SPEED) + MOTION_LIMIT_SLACK_MS;
+
+    DAC_Set_Voltage(MOTION_DAC);
+
+    __disable_interrupt();                          // TB3 ISR must see the whole setup at once
+    motion_dir = (amount < 0) ? -1 : 1;
+    motion_target = target;
+    motion_mark = Odometry_Distance();
+    motion_heading_mark = Odometry_Heading();
+    motion_heading_last = motion_heading_mark;
+    motion_turned = 0;
+    motion_speed = 0;
+    motion_ticks = 0;
+    motion_limit = (unsigned int)((limit_ms * ODOM_TICKS_PER_SEC) / 1000);
+    motion_type = type;
+    __bis_SR_register(interrupt_state);
+}
+
+unsigned char Motion_Start_Straight(int mm) {
+    unsigned int length = (mm < 0) ? (unsigned int)(-mm) : (unsigned int)mm;
+
+    if ((length == 0) || (length > MOTION_MAX_MM)) {
+        return FALSE;
+    }
+    Motion_Begin(MOTION_STRAIGHT, mm, ODOM_MM(length), length);
+    return TRUE;
+}
+
+unsigned char Motion_Start_Rotate(int deg) {
+    unsigned int angle = (deg < 0) ? (unsigned int)(-deg) : (unsigned int)deg;
+    unsigned long target;
+
+    if ((angle == 0) || (angle > MOTION_MAX_DEG)) {
+        return FALSE;
+    }
+    target = ((unsigned long)angle << 16) / 360;
+    Motion_Begin(MOTION_ROTATE, deg, target, (unsigned int)(((target * MOTION_ARC_SCALE) >> 10) / 1000) + 1);
+    return TRUE;
+}
+
+void Motion_Stop(void) {
+    unsigned short interrupt_state = __get_SR_register() & GIE;
+    __disable_interrupt();
+    if (motion_type != MOTION_IDLE) {
+        Motion_Finish();
+    }
+    __bis_SR_register(interrupt_state);
+}
+
+unsigned char Motion_Active(void) {
+    return motion_type != MOTION_IDLE;
+}
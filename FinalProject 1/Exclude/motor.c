@@ -0,0 +1,153 @@
+/*
+ * motor.c
+ *
+ *  Created on: Dec 17, 2025
+ *      Author: Dallas.Owens
+ *
+ *  Description: Wheel output stage.
+ *               Each wheel has a forward and a reverse CCR on TB3; driving
+ *               both at once shorts the bridge. Everything that moves the car
+ *               goes through Motor_Set / Motor_Set_Wheel with a signed speed,
+ *               so only one channel of a wheel is ever non-zero, and a
+ *               change of direction waits out MOTOR_DEAD_MS with the wheel
+ *               off. The per-wheel trim is applied last.
+ *               Counts are worked out in a shadow copy and all four CCRs are
+ *               written together; the TB3 compare latches (timers_b3.c) load
+ *               them at the next period boundary, so both wheels change on
+ *               the same edge.
+ */
+
+#include "msp430.h"
+#include "macros.h"
+#include "motor.h"
+
+
+static unsigned int motor_forward[MOTOR_WHEELS];                // Counts for the next period
+static unsigned int motor_reverse[MOTOR_WHEELS];
+
+static volatile int motor_speed[MOTOR_WHEELS];                  // Asked for (held during dead time)
+static volatile signed char motor_direction[MOTOR_WHEELS];      // Last driven: +1, -1, 0 = settled
+static volatile unsigned char motor_dead[MOTOR_WHEELS];         // Periods left before a reversal
+static unsigned int motor_trim[MOTOR_WHEELS] = { MOTOR_TRIM_LEFT, MOTOR_TRIM_RIGHT };
+
+
+//==============================================================================
+// OUTPUT
+//==============================================================================
+// Every CCR of both latch groups, each time - a group whose CCRs are not all
+// written never loads. A write that straddles the boundary splits forward and
+// reverse by a period, never a wheel's own pair mid-reversal (dead time).
+static void Motor_Output(void) {
+    LEFT_FORWARD_SPEED = motor_forward[MOTOR_LEFT];     // CL1+CL2
+    RIGHT_FORWARD_SPEED = motor_forward[MOTOR_RIGHT];
+    LEFT_REVERSE_SPEED = motor_reverse[MOTOR_LEFT];     // CL3+CL4
+    RIGHT_REVERSE_SPEED = motor_reverse[MOTOR_RIGHT];
+}
+
+static unsigned int Motor_Counts(unsigned char wheel, unsigned int magnitude) {
+    unsigned long counts = ((unsigned long)magnitude * MOTOR_COUNTS_PER_UNIT * motor_trim[wheel]) / 1000;
+    return (counts > WHEEL_PERIOD) ? WHEEL_PERIOD : (unsigned int)counts;
+}
+
+static void Motor_Off(unsigned char wheel) {
+    motor_forward[wheel] = WHEEL_OFF;
+    motor_reverse[wheel] = WHEEL_OFF;
+    if ((motor_direction[wheel] != 0) && (motor_dead[wheel] == 0)) {
+        motor_dead[wheel] = MOTOR_DEAD_PERIODS;     // Settle from here
+    }
+}
+
+static void Motor_Write(unsigned char wheel, int speed) {
+    signed char direction = (speed > 0) ? 1 : -1;
+
+    if (speed > MOTOR_SPEED_MAX) speed = MOTOR_SPEED_MAX;
+    if (speed < -MOTOR_SPEED_MAX) speed = -MOTOR_SPEED_MAX;
+    motor_speed[wheel] = speed;
+
+    if (speed == 0) {
+        Motor_Off(wheel);
+        return;
+    }
+    if ((motor_direction[wheel] != 0) && (motor_direction[wheel] != direction)) {
+        Motor_Off(wheel);                           // Reversal - Motor_Update drives it once settled
+        return;
+    }
+
+    motor_dead[wheel] = 0;                          // Same way (or settled) - no wait
+    motor_direction[wheel] = direction;
+    if (direction > 0) {
+        motor_reverse[wheel] = WHEEL_OFF;
+        motor_forward[wheel] = Motor_Counts(wheel, (unsigned int)speed);
+    }
+    else {
+        motor_forward[wheel] = WHEEL_OFF;
+        motor_reverse[wheel] = Motor_Counts(wheel, (unsigned int)(-speed));
+    }
+}
+
+
+//==============================================================================
+// API (main loop and ISRs)
+//==============================================================================
+void Motor_Set_Wheel(unsigned char wheel, int speed) {
+    unsigned short interrupt_state = __get_SR_register() & GIE;
+
+    if (wheel >= MOTOR_WHEELS) return;
+    __disable_interrupt();
+    Motor_Write(wheel, speed);
+    Motor_Output();
+    __bis_SR_register(interrupt_state);
+}
+
+void Motor_Set(int left, int right) {
+    unsigned short interrupt_state = __get_SR_register() & GIE;
+
+    __disable_interrupt();
+    Motor_Write(MOTOR_LEFT, left);
+    Motor_Write(MOTOR_RIGHT, right);
+    Motor_Output();                                 // Both wheels on the same period edge
+    __bis_SR_register(interrupt_state);
+}
+
+void Motor_Stop(void) {
+    Motor_Set(0, 0);
+}
+
+int Motor_Get(unsigned char wheel) {
+    return (wheel < MOTOR_WHEELS) ? motor_speed[wheel] : 0;
+}
+
+unsigned char Motor_Settling(unsigned char wheel) {
+    return (wheel < MOTOR_WHEELS) && (motor_dead[wheel] != 0);
+}
+
+void Motor_Set_Trim(unsigned char wheel, unsigned int trim) {
+    if (wheel >= MOTOR_WHEELS) return;
+    if (trim < MOTOR_TRIM_MIN) trim = MOTOR_TRIM_MIN;
+    if (trim > MOTOR_TRIM_MAX) trim = MOTOR_TRIM_MAX;
+    motor_trim[wheel] = trim;
+    Motor_Set_Wheel(wheel, motor_speed[wheel]);     // Apply now
+}
+
+
+//==============================================================================
+// DEAD TIME (TB3 CCR0 ISR, once per PWM period)
+//==============================================================================
+void Motor_Update(void) {
+    unsigned char wheel;
+    unsigned char changed = FALSE;
+
+    for (wheel = 0; wheel < MOTOR_WHEELS; wheel++) {
+        if (motor_dead[wheel] == 0) continue;
+        if (--motor_dead[wheel] != 0) continue;
+
+        motor_direction[wheel] = 0;                 // Settled - either way is safe now
+        if (motor_speed[wheel] != 0) {
+            Motor_Write(wheel, motor_speed[wheel]); // Held reversal
+            changed = TRUE;
+        }
+    }
+    if (changed) {
+        Motor_Output();
+    }
+}
@@ -0,0 +1,247 @@
+/*
+ * odometry.c
+ *
+ *  Created on: Dec 14, 2025
+ *      Author: Dallas.Owens
+ *
+ *  Description: Dead reckoning at the PWM rate.
+ *               Every TB3 period each wheel's travel is estimated from its
+ *               signed duty, the motor supply the DAC is set to and the
+ *               wheel model in odometry.h, then integrated into x, y and
+ *               heading (differential drive). Moves that used to be "drive
+ *               for N ms" wait on distance or heading instead, so they cover
+ *               the same ground at any supply setting.
+ */
+
+#include "msp430.h"
+#include "macros.h"
+#include "functions.h"
+#include <string.h>
+#include "timers.h"
+#include "DAC.h"
+#include "odometry.h"
+#include "motion.h"
+#include "motor.h"
+#include "PWM.h"
+
+
+static volatile odom_pose_t odom_pose = { 0 };
+
+static unsigned int odom_mv = 0;                    // Supply odom_supply was worked out for
+static unsigned int odom_ran[4] = { 0 };            // Duties latched at the last tick: L fwd, L rev, R fwd, R rev
+static unsigned int odom_supply = 0;                // Supply mV x 2^16 / WHEEL_PERIOD (duty -> mV, Q16)
+
+extern char adc_char[4];
+
+// sin(0..90 degrees) in 64 steps, Q14
+static const int odom_sine[65] = {
+        0,   402,   804,  1205,  1606,  2006,  2404,  2801,
+     3196,  3590,  3981,  4370,  4756,  5139,  5520,  5897,
+     6270,  6639,  7005,  7366,  7723,  8076,  8423,  8765,
+     9102,  9434,  9760, 10080, 10394, 10702, 11003, 11297,
+    11585, 11866, 12140, 12406, 12665, 12916, 13160, 13395,
+    13623, 13842, 14053, 14256, 14449, 14635, 14811, 14978,
+    15137, 15286, 15426, 15557, 15679, 15791, 15893, 15986,
+    16069, 16143, 16207, 16261, 16305, 16340, 16364, 16379,
+    16384,
+};
+
+
+//==============================================================================
+// MODEL
+//==============================================================================
+// Signed wheel travel this period, um
+static long Odometry_Wheel_Step(unsigned int forward, unsigned int reverse, unsigned long kv_tick) {
+    unsigned int duty = (forward >= reverse) ? (forward - reverse) : (reverse - forward);
+    unsigned int effective = (unsigned int)(((unsigned long)duty * odom_supply) >> 16);     // mV
+    long step;
+
+    if (effective <= ODOM_STALL_MV) {
+        return 0;
+    }
+    step = (long)(((unsigned long)(effective - ODOM_STALL_MV) * kv_tick) >> 16);
+    return (forward >= reverse) ? step : -step;
+}
+
+// Inverse of the model: duty for a wheel speed (mm/s) at the present supply
+unsigned int Odometry_Wheel_Duty(unsigned int speed, unsigned int kv) {
+    unsigned long mv;
+    unsigned long duty;
+
+    if ((speed == 0) || (odom_supply == 0)) {
+        return WHEEL_OFF;
+    }
+    mv = (((unsigned long)speed * 1000) / kv) + ODOM_STALL_MV;
+    duty = (mv << 16) / odom_supply;
+    return (duty > WHEEL_PERIOD) ? WHEEL_PERIOD : (unsigned int)duty;
+}
+
+// 16-bit binary angle -> Q14 sine
+static int Odometry_Sin(unsigned int angle) {
+    unsigned int quadrant = angle >> 14;
+    unsigned int offset = angle & 0x3FFF;
+    unsigned int index, frac;
+    int value;
+
+    if (quadrant & 1) {
+        offset = 0x4000 - offset;                   // Falling half of the quarter wave
+    }
+    index = offset >> 8;                            // 64 steps per quarter
+    frac = offset & 0xFF;
+    value = odom_sine[index];
+    if (frac) {
+        value += (int)(((long)(odom_sine[index + 1] - value) * frac) >> 8);
+    }
+    return (quadrant & 2) ? -value : value;
+}
+
+
+//==============================================================================
+// INTEGRATE (TB3 CCR0, once per PWM period)
+// Midpoint heading for the position step - the turn this period is applied
+// half before and half after the move.
+//==============================================================================
+static void Odometry_Update(void) {
+    long left, right, step, turn;
+    unsigned int mid;
+    unsigned int supply = DAC_Supply_mV();
+
+    if (supply != odom_mv) {                        // Only on a supply change - one divide
+        odom_mv = supply;
+        odom_supply = (unsigned int)(((unsigned long)supply << 16) / WHEEL_PERIOD);    // Setpoint, held by the DAC.c regulator
+    }
+
+    // The period that just ended ran on what the latches loaded at its start -
+    // the CCRs now hold what loaded a count ago, for the period starting now
+    left = Odometry_Wheel_Step(odom_ran[0], odom_ran[1], ODOM_KV_TICK(ODOM_KV_LEFT));
+    right = Odometry_Wheel_Step(odom_ran[2], odom_ran[3], ODOM_KV_TICK(ODOM_KV_RIGHT));
+    odom_ran[0] = LEFT_FORWARD_SPEED;
+    odom_ran[1] = LEFT_REVERSE_SPEED;
+    odom_ran[2] = RIGHT_FORWARD_SPEED;
+    odom_ran[3] = RIGHT_REVERSE_SPEED;
+    if ((left == 0) && (right == 0)) {
+        return;
+    }
+
+    turn = (right - left) * (long)ODOM_HEADING_SCALE;         // Signed, so the half turn keeps its sign
+    mid = (unsigned int)((odom_pose.heading + (unsigned long)(turn >> 1)) >> 16);
+    step = (left + right) / 2;
+
+    odom_pose.x += (step * Odometry_Sin(mid + 0x4000)) >> 14;                  // cos
+    odom_pose.y += (step * Odometry_Sin(mid)) >> 14;
+    odom_pose.heading += (unsigned long)turn;               // Wraps mod 360 degrees
+    odom_pose.distance += (unsigned long)(((left < 0) ? -left : left) + ((right < 0) ? -right : right)) >> 1;
+}
+
+#pragma vector = TIMER_B3_CCR0_VECTOR
+__interrupt void TIMER_B3_CCR0_ISR(void) {          // TB3 CCR0 - PWM period end
+    Odometry_Update();
+    Motion_Update();                                // Moves steer on the estimate just made
+    PWM_Slew_Update();                              // Ramp toward the PWM_ targets for the next period
+    Motor_Update();                                 // Direction-change dead time
+    DAC_Ramp_Update();                              // Supply ramp step (odometry picks it up next period)
+    DAC_Supply_Update();                            // Hold the rail against the battery (every DAC_REG_MS)
+}
+
+
+//==============================================================================
+// ACCESS
+//==============================================================================
+void Odometry_Reset(void) {
+    unsigned short interrupt_state = __get_SR_register() & GIE;
+    __disable_interrupt();
+    odom_pose.x = 0;
+    odom_pose.y = 0;
+    odom_pose.heading = 0;
+    odom_pose.distance = 0;
+    __bis_SR_register(interrupt_state);
+}
+
+void Odometry_Get_Pose(odom_pose_t *pose) {
+    unsigned short interrupt_state = __get_SR_register() & GIE;
+    __disable_interrupt();
+    pose->x = odom_pose.x;
+    pose->y = odom_pose.y;
+    pose->heading = odom_pose.heading;
+    pose->distance = odom_pose.distance;
+    __bis_SR_register(interrupt_state);
+}
+
+unsigned long Odometry_Distance(void) {
+    unsigned long distance;
+    unsigned short interrupt_state = __get_SR_register() & GIE;
+    __disable_interrupt();
+    distance = odom_pose.distance;
+    __bis_SR_register(interrupt_state);
+    return distance;
+}
+
+unsigned int Odometry_Heading(void) {
+    unsigned long heading;
+    unsigned short interrupt_state = __get_SR_register() & GIE;
+    __disable_interrupt();
+    heading = odom_pose.heading;
+    __bis_SR_register(interrupt_state);
+    return (unsigned int)(heading >> 16);
+}
+
+
+//==============================================================================
+// WAITS
+// Marks are raw readings, differences are wrap safe. Heading counts either way
+// round, so one call covers left and right turns.
+//==============================================================================
+unsigned char Odometry_Reached(unsigned long distance_mark, unsigned int mm) {
+    return (Odometry_Distance() - distance_mark) >= ODOM_MM(mm);
+}
+
+unsigned char Odometry_Turned(unsigned int heading_mark, unsigned int deg) {
+    int turned = (short)(Odometry_Heading() - heading_mark);     // 16-bit wrap - int is wider on the host
+    if (turned < 0) turned = -turned;
+    return (unsigned int)turned >= ODOM_DEG(deg);
+}
+
+
+//==============================================================================
+// DISPLAY (IoT O0000)
+// LCD: x, y (cm, signed), heading (degrees), path length (cm).
+// UART: "Odom D0061 H0045" - path cm, heading degrees.
+//==============================================================================
+static int Odometry_Clip(long value) {
+    if (value > 9999) return 9999;
+    if (value < -9999) return -9999;
+    return (int)value;
+}
+
+static void Odometry_Line(char line, const char *label, int value) {
+    strcpy(display_line[line - 1], label);
+    if (value < 0) {
+        display_line[line - 1][5] = '-';
+        value = -value;
+    }
+    HEXtoBCD(value);
+    adc_line(line, 6);
+}
+
+void Odometry_Display(void) {
+    odom_pose_t pose;
+    char response[] = "Odom D0000 H0000\r\n";
+    int heading, distance;
+    unsigned char i;
+
+    Odometry_Get_Pose(&pose);
+    heading = (int)(((pose.heading >> 16) * 360UL) >> 16);
+    distance = Odometry_Clip((long)(pose.distance / 10000));
+
+    Odometry_Line(1, "X cm      ", Odometry_Clip(pose.x / 10000));
+    Odometry_Line(2, "Y cm      ", Odometry_Clip(pose.y / 10000));
+    Odometry_Line(3, "Hdg       ", heading);
+    Odometry_Line(4, "D cm      ", distance);
+    display_changed = TRUE;
+
+    HEXtoBCD(distance);
+    for (i = 0; i < 4; i++) response[6 + i] = adc_char[i];
+    HEXtoBCD(heading);
+    for (i = 0; i < 4; i++) response[12 + i] = adc_char[i];
+    Send_Response(response);
+}
@@ -0,0 +1,168 @@
+/*
+ * pid.c
+ *
+ *  Created on: Dec 8, 2025
+ *      Author: Dallas.Owens
+ *
+ *  Description: Fixed-point PID controller.
+ *               - Q12.4 gains, products and sum held in a saturating 32-bit accumulator
+ *               - Integral clamped to the output range and frozen while the output
+ *                 is saturated in the same direction (anti-windup)
+ *               - Derivative taken on the measurement (no setpoint kick) and low-pass filtered
+ *               - Output clamped to +/- out_max
+ *               The three 16x16 products go through the MPY32 peripheral directly.
+ *               Without MPY32 (host builds) the same math runs in plain C.
+ */
+
+#include "msp430.h"
+#include "macros.h"
+#include "pid.h"
+
+
+void PID_Init(pid_controller_t *pid, int kp, int ki, int kd, int out_max) {
+    PID_Set_Gains(pid, kp, ki, kd);
+    pid->d_filter_shift = PID_D_FILTER_DEFAULT;
+    pid->out_max = out_max;
+    pid->cycles_max = 0;
+    PID_Reset(pid);
+}
+
+
+void PID_Set_Gains(pid_controller_t *pid, int kp, int ki, int kd) {
+    pid->kp = kp;
+    pid->ki = ki;
+    pid->kd = kd;
+}
+
+
+void PID_Reset(pid_controller_t *pid) {
+    pid->integral = 0;
+    pid->last_measurement = 0;
+    pid->d_state = 0;
+    pid->d_filtered = 0;
+    pid->first_update = TRUE;
+    pid->saturated = 0;
+}
+
+
+//==============================================================================
+// SATURATING 32-BIT MATH
+//==============================================================================
+static long PID_Sat_Add(long a, long b) {
+    long sum = (long)((unsigned long)a + (unsigned long)b);     // Wraps instead of undefined overflow
+    if ((a >= 0) && (b >= 0) && (sum < 0)) return PID_ACC_MAX;
+    if ((a < 0) && (b < 0) && (sum >= 0)) return PID_ACC_MIN;
+    return sum;
+}
+
+
+static int PID_Clamp_Int(long value, int limit) {
+    if (value > limit) return limit;
+    if (value < -limit) return -limit;
+    return (int)value;
+}
+
+
+static int PID_Clamp_Diff(long value) {
+    // Differences of two ints can need 17 bits
+    if (value > 32767) return 32767;
+    if (value < -32767) return -32767;
+    return (int)value;
+}
+
+
+#ifdef __MSP430_HAS_MPY32__
+//==============================================================================
+// MPY32 PRODUCTS
+// Signed 16x16 -> 32 (MPYS/OP2, result in RESHI:RESLO, 1 MCLK after OP2 write).
+// Interrupts are held off so a multiply in an ISR can't corrupt ours (and vice
+// versa when this runs in the main loop).
+//==============================================================================
+static void PID_Products(int kp, int error, int ki, int kd, int rate,
+                         long *p_term, long *i_step, long *d_term) {
+    unsigned short interrupt_state = __get_SR_register() & GIE;
+    __disable_interrupt();
+
+    MPY32CTL0 &= ~(MPYSAT | MPYFRAC);   // Plain integer result
+    MPYS = kp;
+    OP2 = error;
+    *p_term = (long)(((unsigned long)RESHI << 16) | RESLO);
+
+    MPYS = ki;
+    OP2 = error;
+    *i_step = (long)(((unsigned long)RESHI << 16) | RESLO);
+
+    MPYS = kd;
+    OP2 = rate;
+    *d_term = (long)(((unsigned long)RESHI << 16) | RESLO);
+
+    __bis_SR_register(interrupt_state);
+}
+#else
+static void PID_Products(int kp, int error, int ki, int kd, int rate,
+                         long *p_term, long *i_step, long *d_term) {
+    *p_term = (long)kp * error;
+    *i_step = (long)ki * error;
+    *d_term = (long)kd * rate;
+}
+#endif
+
+
+//==============================================================================
+// MEASUREMENT RATE
+// Filtered change of the measurement per update. PID_Update calls this; callers
+// that only need the rate (steering table) can call it instead.
+//==============================================================================
+int PID_Rate_Update(pid_controller_t *pid, int measurement) {
+    int rate = 0;
+
+    if (!pid->first_update) {
+        rate = PID_Clamp_Diff((long)measurement - pid->last_measurement);
+    }
+    pid->first_update = FALSE;
+    pid->last_measurement = measurement;
+    pid->d_state += (long)rate - (pid->d_state >> pid->d_filter_shift);
+    pid->d_filtered = (int)(pid->d_state >> pid->d_filter_shift);
+    return pid->d_filtered;
+}
+
+
+//==============================================================================
+// PID UPDATE
+// error = setpoint - measurement, output = Kp*e + I - Kd*d(measurement)
+// Call at a fixed rate - Ki/Kd are per update, not per second.
+//==============================================================================
+int PID_Update(pid_controller_t *pid, int setpoint, int measurement) {
+    unsigned int start = CYCLE_STAMP();         // SMCLK = MCLK, 1 tick = 1 cycle
+    unsigned int end;
+    int error = PID_Clamp_Diff((long)setpoint - measurement);
+    int rate;
+    long p_term, i_step, d_term;
+    long acc;
+    long i_limit = (long)pid->out_max << PID_GAIN_SHIFT;
+    int output;
+
+    rate = PID_Rate_Update(pid, measurement);
+    PID_Products(pid->kp, error, pid->ki, pid->kd, rate, &p_term, &i_step, &d_term);
+
+    // Anti-windup: hold the integrator while the output is pinned in the direction it would grow
+    if (!((pid->saturated > 0) && (i_step > 0)) && !((pid->saturated < 0) && (i_step < 0))) {
+        pid->integral = PID_Sat_Add(pid->integral, i_step);
+        if (pid->integral > i_limit) pid->integral = i_limit;
+        if (pid->integral < -i_limit) pid->integral = -i_limit;
+    }
+
+    acc = PID_Sat_Add(p_term, pid->integral);
+    acc = PID_Sat_Add(acc, -d_term);            // d_term is a 16x16 product, never PID_ACC_MIN
+
+    acc >>= PID_GAIN_SHIFT;                     // Q.4 -> output units
+    output = PID_Clamp_Int(acc, pid->out_max);
+    pid->saturated = (acc > output) ? 1 : ((acc < output) ? -1 : 0);
+
+    end = CYCLE_STAMP();
+    pid->cycles = CYCLES_SINCE(start, end);
+    if (pid->cycles > pid->cycles_max) {
+        pid->cycles_max = pid->cycles;
+    }
+    return output;
+}
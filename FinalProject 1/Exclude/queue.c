@@ -16,7 +16,14 @@
 #include "UART.h"
 #include "queue.h"
 #include "wheels.h"
+#include "steer_ctrl.h"
+#include "autotune.h"
+#include "odometry.h"
+#include "motion.h"
+#include "runlog.h"
 #include "calibration.h"
+#include "DAC.h"
+#include "ADC.h"
 #include  "LED.h"
 #include "PWM.h"
 
@@ -47,6 +54,7 @@ void Process_Queue(void) {
 	if (!command_waiting) { return; }               // RETURN if no commands waiting
 	// COMMAND ACTIVE: Check if command is active - wait for completion
     if(command_active){
+        Runlog_Report_Process();                        // Q: next CSV line once the UART is free
 		if (command_complete) {                 // COMMAND COMPLETE LOGIC
             command_complete = FALSE;                   // Consume flags
             command_active = FALSE;                     
@@ -99,6 +107,28 @@ void Process_Queue(void) {
                 command_timer = COMMAND_DELAY(cmd.duration);
                 break;
 
+                // IoT MOVES IN PHYSICAL UNITS (motion.c ends them with command_complete)
+			case 'M':
+				Send_Response("Forward mm\r\n");
+                if (!Motion_Start_Straight((int)cmd.duration)) { command_complete = TRUE; }
+                command_timer = 0;
+                break;
+			case 'N':
+				Send_Response("Backward mm\r\n");
+                if (!Motion_Start_Straight(-(int)cmd.duration)) { command_complete = TRUE; }
+                command_timer = 0;
+                break;
+			case 'H':
+				Send_Response("Rotate Left deg\r\n");
+                if (!Motion_Start_Rotate((int)cmd.duration)) { command_complete = TRUE; }
+                command_timer = 0;
+                break;
+			case 'J':
+				Send_Response("Rotate Right deg\r\n");
+                if (!Motion_Start_Rotate(-(int)cmd.duration)) { command_complete = TRUE; }
+                command_timer = 0;
+                break;
+
                 // LINE FOLLOWING
 //            case 'S':
 //                Send_Response("Skynet Protocol Invoked\r\n");
@@ -164,6 +194,85 @@ void Process_Queue(void) {
 				command_active = FALSE;  // No timing needed, just display update
 				break;
 
+            case 'V':
+                // Invalidate stored calibration - format V0000
+                Send_Response("Calibration Cleared\r\n");
+                Calibration_Invalidate();
+                strcpy(display_line[0], "Cal Clear ");
+                display_changed = TRUE;
+                command_active = FALSE;  // No timing needed
+                break;
+
+            case 'A':
+                // Show measured ADC channel rates - format A0000
+                Send_Response("ADC Rates\r\n");
+                Display_ADC_Rates();
+                command_active = FALSE;  // No timing needed
+                break;
+
+            case 'G':
+                // Drive state stats - format G0011 (state 11) or G0100 (newest log entry)
+                Send_Response("Drive Stats\r\n");
+                Display_Drive_Stats(cmd.duration);
+                command_active = FALSE;  // No timing needed
+                break;
+
+            case 'K':
+                // Select steering controller - format K0001 (see steer_ctrl.h)
+                if (Steer_Ctrl_Select(cmd.duration)) {
+                    Send_Response("Controller Set\r\n");
+                    strcpy(display_line[1], steer_controllers[steer_ctrl_active].name);
+                }
+                else {
+                    Send_Response("No Controller\r\n");
+                    strcpy(display_line[1], "No Ctrl   ");
+                }
+                display_changed = TRUE;
+                command_active = FALSE;  // No timing needed
+                break;
+
+            case 'U':
+                // Relay auto-tune - U0000 Ziegler-Nichols, U0001 Tyreus-Luyben (next run),
+                // U0002 back to the steer_params.h gains
+                if (!Autotune_Start(cmd.duration)) {
+                    Send_Response("No Method\r\n");
+                }
+                else if (cmd.duration == AUTOTUNE_CLEAR) {
+                    Send_Response("Tune Cleared\r\n");
+                    strcpy(display_line[1], "Tune Clear");
+                }
+                else {
+                    Send_Response("Tune Armed\r\n");
+                    strcpy(display_line[1], "Tune Armed");
+                }
+                display_changed = TRUE;
+                command_active = FALSE;  // No timing needed
+                break;
+
+            case 'O':
+                // Odometry - O0000 show pose, O0001 zero it
+                if (cmd.duration == 1) {
+                    Odometry_Reset();
+                }
+                Odometry_Display();
+                command_active = FALSE;  // No timing needed
+                break;
+
+            case 'Q':
+                // Run log - Q0000 newest run, Q000n n runs back, Q0099 all (CSV, paced)
+                if (!Runlog_Report_Start(cmd.duration)) {
+                    Send_Response("No Run\r\n");
+                    command_complete = TRUE;
+                }
+                command_timer = 0;
+                break;
+
+            case 'W':
+                // Supply calibration - W000n drive to point n, W1000+ meter mV, W0090 save, W0091 defaults
+                DAC_Cal_Command(cmd.duration);
+                command_active = FALSE;  // No timing needed
+                break;
+
             case 'Y':
                 // Setup LEFT - Drive forward 2s, rotate left
                 Send_Response("Setup Left\r\n");
@@ -281,7 +390,13 @@ ParsedCommand Parse_Command(void)
         cmd.direction != 'C' && cmd.direction != 'P' && 
         cmd.direction != 'E' && cmd.direction != 'I' &&  
         cmd.direction != 'D' && cmd.direction != 'S' &&
-        cmd.direction != 'Y' && cmd.direction != 'Z')   
+        cmd.direction != 'Y' && cmd.direction != 'Z' &&
+        cmd.direction != 'V' && cmd.direction != 'A' &&
+        cmd.direction != 'G' && cmd.direction != 'K' &&
+        cmd.direction != 'U' && cmd.direction != 'O' &&
+        cmd.direction != 'M' && cmd.direction != 'N' &&
+        cmd.direction != 'H' && cmd.direction != 'J' &&
+        cmd.direction != 'Q' && cmd.direction != 'W')   
     {
         return cmd;                                                 // Invalid direction
     }
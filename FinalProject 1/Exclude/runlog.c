@@ -0,0 +1,328 @@
+/*
+ * runlog.c
+ *
+ *  Created on: Dec 16, 2025
+ *      Author: Dallas.Owens
+ *
+ *  Description: Lap / run performance recorder.
+ *               Drive_Run_Reset starts a record, the steering ISR feeds it the
+ *               tracking error, and the change to DRIVE_IDLE closes it with the
+ *               per-state dwell times from wheels.c. Closed records go into a
+ *               ring in FRAM (each with its own CRC), so the last RUNLOG_SIZE
+ *               runs survive a reset and can be compared after a session.
+ *               IoT Q sends them to the PC as short CSV lines, one line per
+ *               pass once the previous one has left the UART.
+ */
+
+#include "msp430.h"
+#include "macros.h"
+#include "functions.h"
+#include <string.h>
+#include "steer_ctrl.h"
+#include "runlog.h"
+#include "fram.h"
+
+
+// Ring of the last RUNLOG_SIZE runs, kept across resets.
+// Slots are written in order - the newest is the valid record with the highest seq.
+#pragma PERSISTENT(runlog_ring)
+run_record_t runlog_ring[RUNLOG_SIZE] = { 0 };
+
+// Current run - error sums written by the ADC ISR
+static volatile unsigned char runlog_recording = FALSE;
+static volatile unsigned int run_error_max = 0;
+static volatile unsigned long run_square_sum = 0;
+static volatile unsigned long run_samples = 0;      // Steering updates - an int wraps in ~131 s at 500 Hz
+static unsigned int run_lost_mark = 0;              // line_lost_ counters at the start
+static unsigned int run_recovered_mark = 0;
+static unsigned int run_circle_enter = 0;
+static unsigned int run_circle_exit = 0;
+
+// Read back
+static unsigned char report_slot = 0;
+static unsigned char report_left = 0;               // Runs still to send
+static unsigned char report_line = 0;
+
+extern volatile unsigned int line_lost_events;
+extern volatile unsigned int line_lost_recovered;
+extern volatile unsigned char command_complete;
+extern char adc_char[4];
+
+#define RUNLOG_LINES            (4 + (RUNLOG_STATES / 4))      // Per run: run, circle, lost, err, 4 dwell
+
+
+//==============================================================================
+// FRAM RING
+//==============================================================================
+static unsigned int Runlog_CRC(const run_record_t *record) {
+    return FRAM_CRC(record, RUNLOG_RECORD_WORDS, RUNLOG_CRC_SEED);
+}
+
+static unsigned char Runlog_Valid(unsigned char slot) {
+    return (runlog_ring[slot].seq != 0) && (Runlog_CRC(&runlog_ring[slot]) == runlog_ring[slot].crc);
+}
+
+// Slot of the newest valid run, RUNLOG_SIZE if there are none
+static unsigned char Runlog_Newest(void) {
+    unsigned char newest = RUNLOG_SIZE;
+    unsigned char i;
+
+    for (i = 0; i < RUNLOG_SIZE; i++) {
+        if (!Runlog_Valid(i)) continue;
+        if ((newest == RUNLOG_SIZE) || (runlog_ring[i].seq > runlog_ring[newest].seq)) {
+            newest = i;
+        }
+    }
+    return newest;
+}
+
+static void Runlog_Write(unsigned char slot, const run_record_t *record) {
+    FRAM_Record_Write(&runlog_ring[slot], record, RUNLOG_RECORD_WORDS, record->crc);
+}
+
+static unsigned int Runlog_Sqrt(unsigned long value) {
+    unsigned long root = 0;
+    unsigned long bit = 1UL << 30;
+
+    while (bit > value) bit >>= 2;
+    while (bit) {
+        if (value >= root + bit) {
+            value -= root + bit;
+            root = (root >> 1) + bit;
+        }
+        else {
+            root >>= 1;
+        }
+        bit >>= 2;
+    }
+    return (unsigned int)root;
+}
+
+
+//==============================================================================
+// RECORDING (wheels.c)
+//==============================================================================
+void Runlog_Start(void) {
+    unsigned short interrupt_state = __get_SR_register() & GIE;
+
+    __disable_interrupt();
+    run_error_max = 0;
+    run_square_sum = 0;
+    run_samples = 0;
+    run_lost_mark = line_lost_events;
+    run_recovered_mark = line_lost_recovered;
+    runlog_recording = TRUE;
+    __bis_SR_register(interrupt_state);
+
+    run_circle_enter = 0;
+    run_circle_exit = 0;
+}
+
+// ADC ISR, once per steering update
+void Runlog_Sample(int error) {
+    unsigned int magnitude;
+    unsigned long square;
+
+    if (!runlog_recording) return;
+
+    magnitude = (error < 0) ? (unsigned int)(-error) : (unsigned int)error;
+    if (magnitude > run_error_max) {
+        run_error_max = magnitude;
+    }
+    square = ((unsigned long)magnitude * magnitude) >> RUNLOG_SQ_SHIFT;
+    if (run_square_sum > (0xFFFFFFFFUL - square)) {
+        return;                                     // Saturated - RMS stops moving
+    }
+    run_square_sum += square;
+    run_samples++;
+}
+
+void Runlog_Circle_Enter(unsigned int time) {
+    if (run_circle_enter == 0) {
+        run_circle_enter = time;
+    }
+}
+
+void Runlog_Circle_Exit(unsigned int time) {
+    if (run_circle_exit == 0) {
+        run_circle_exit = time;
+    }
+}
+
+// Change to DRIVE_IDLE, after the last dwell is added
+void Runlog_End(unsigned char end, unsigned int run_time, const unsigned int *dwell, unsigned char states) {
+    run_record_t record = { 0 };
+    unsigned short interrupt_state = __get_SR_register() & GIE;
+    unsigned long square_sum;
+    unsigned long samples;
+    unsigned char newest, slot, i;
+
+    __disable_interrupt();
+    if (!runlog_recording) {
+        __bis_SR_register(interrupt_state);
+        return;
+    }
+    runlog_recording = FALSE;
+    record.error_max = run_error_max;
+    square_sum = run_square_sum;
+    samples = run_samples;
+    record.line_lost = line_lost_events - run_lost_mark;
+    record.line_recovered = line_lost_recovered - run_recovered_mark;
+    __bis_SR_register(interrupt_state);
+
+    if (samples) {
+        record.error_rms = Runlog_Sqrt((square_sum / samples) << RUNLOG_SQ_SHIFT);
+    }
+    if (states > RUNLOG_STATES) {
+        states = RUNLOG_STATES;
+    }
+    for (i = 0; i < states; i++) {
+        record.dwell[i] = dwell[i];
+    }
+    record.run_time = run_time;
+    record.circle_enter = run_circle_enter;
+    record.circle_exit = run_circle_exit;
+    record.controller = steer_ctrl_active;
+    record.end = end;
+
+    newest = Runlog_Newest();
+    if (newest == RUNLOG_SIZE) {
+        slot = 0;
+        record.seq = 1;
+    }
+    else {
+        slot = (newest + 1) % RUNLOG_SIZE;
+        record.seq = runlog_ring[newest].seq + 1;
+        if (record.seq == 0) record.seq = 1;        // 0 marks an empty slot
+    }
+    record.crc = Runlog_CRC(&record);
+    Runlog_Write(slot, &record);
+}
+
+
+//==============================================================================
+// READ BACK (IoT Q)
+// The PC ring (IOT_2_PC) only holds one short line, so Runlog_Report_Process
+// sends the next line each time the UART has finished the last one. Times are
+// 100ms ticks. Per run:
+//     run,<seq>,<lap>,<end>,<controller>
+//     circle,<enter>,<exit>
+//     lost,<events>,<recovered>
+//     err,<max>,<rms>
+//     dw,<first state>,<dwell>,<dwell>,<dwell>,<dwell>    (x4)
+// LCD: the run asked for (the newest for Q0099) - number, lap s, losses, RMS.
+//==============================================================================
+static char *Runlog_Number(char *text, unsigned int value) {
+    char digits[5];
+    unsigned char count = 0;
+
+    *text++ = ',';
+    do {
+        digits[count++] = (char)('0' + (value % 10));
+        value /= 10;
+    } while (value);
+    while (count) {
+        *text++ = digits[--count];
+    }
+    return text;
+}
+
+static void Runlog_Send_Line(const run_record_t *record, unsigned char line) {
+    char response[32];
+    char *text = response;
+    unsigned char first, i;
+
+    switch (line) {
+        case 0:
+            strcpy(text, "run");
+            text = Runlog_Number(text + 3, record->seq);
+            text = Runlog_Number(text, record->run_time);
+            text = Runlog_Number(text, record->end);
+            text = Runlog_Number(text, record->controller);
+            break;
+        case 1:
+            strcpy(text, "circle");
+            text = Runlog_Number(text + 6, record->circle_enter);
+            text = Runlog_Number(text, record->circle_exit);
+            break;
+        case 2:
+            strcpy(text, "lost");
+            text = Runlog_Number(text + 4, record->line_lost);
+            text = Runlog_Number(text, record->line_recovered);
+            break;
+        case 3:
+            strcpy(text, "err");
+            text = Runlog_Number(text + 3, record->error_max);
+            text = Runlog_Number(text, record->error_rms);
+            break;
+        default:
+            first = (line - 4) * 4;
+            strcpy(text, "dw");
+            text = Runlog_Number(text + 2, first);
+            for (i = first; i < first + 4; i++) {
+                text = Runlog_Number(text, record->dwell[i]);
+            }
+            break;
+    }
+    *text++ = '\r';
+    *text++ = '\n';
+    *text = '\0';
+    Send_Response(response);
+}
+
+static void Runlog_Line(char line, const char *label, unsigned int value) {
+    strcpy(display_line[line - 1], label);
+    HEXtoBCD((int)((value > 9999) ? 9999 : value));
+    adc_line(line, 6);
+}
+
+unsigned char Runlog_Report_Start(unsigned int which) {
+    unsigned char newest = Runlog_Newest();
+    unsigned char slot;
+
+    if (newest == RUNLOG_SIZE) {
+        return FALSE;
+    }
+    if (which == RUNLOG_ALL) {
+        slot = newest;
+        report_slot = (newest + 1) % RUNLOG_SIZE;
+        report_left = RUNLOG_SIZE;
+    }
+    else {
+        if (which >= RUNLOG_SIZE) return FALSE;
+        slot = (newest + RUNLOG_SIZE - which) % RUNLOG_SIZE;
+        if (!Runlog_Valid(slot)) return FALSE;
+        report_slot = slot;
+        report_left = 1;
+    }
+    report_line = 0;
+
+    Runlog_Line(1, "Run       ", runlog_ring[slot].seq);
+    Runlog_Line(2, "Lap s     ", runlog_ring[slot].run_time / 10);
+    Runlog_Line(3, "Lost      ", runlog_ring[slot].line_lost);
+    Runlog_Line(4, "Erms      ", runlog_ring[slot].error_rms);
+    display_changed = TRUE;
+    return TRUE;
+}
+
+void Runlog_Report_Process(void) {
+    if (report_left == 0) return;
+    if (UCA1IE & UCTXIE) return;                    // Last line still going out
+
+    while (!Runlog_Valid(report_slot)) {            // Q0099 - skip empty slots
+        report_slot = (report_slot + 1) % RUNLOG_SIZE;
+        if (--report_left == 0) {
+            command_complete = TRUE;
+            return;
+        }
+    }
+
+    Runlog_Send_Line(&runlog_ring[report_slot], report_line);
+    if (++report_line < RUNLOG_LINES) return;
+
+    report_line = 0;
+    report_slot = (report_slot + 1) % RUNLOG_SIZE;
+    if (--report_left == 0) {
+        command_complete = TRUE;                    // Process_Queue moves on
+    }
+}
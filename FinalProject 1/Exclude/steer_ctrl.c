@@ -0,0 +1,147 @@
+/*
+ * steer_ctrl.c
+ *
+ *  Created on: Dec 12, 2025
+ *      Author: Dallas.Owens
+ *
+ *  Description: Steering controller table and the fixed-speed strategies.
+ *               Every controller turns line_position into left/right wheel
+ *               targets; Line_Follow_Steer (wheels.c) clamps them, writes the
+ *               PWM and handles line loss, so a switch mid-run is safe.
+ *               Each one keeps its own parameter block - changing one never
+ *               touches another's gains.
+ */
+
+#include "msp430.h"
+#include "macros.h"
+#include "control.h"
+#include "DAC.h"
+#include "pid.h"
+#include "wheels.h"
+#include "steer_ctrl.h"
+#include "autotune.h"
+
+
+static void Steer_P_Init(void);
+static void Steer_P_Reset(void);
+static void Steer_P_Update(int error, int *left_speed, int *right_speed);
+static void Steer_PID_Init(void);
+static void Steer_PID_Reset(void);
+static void Steer_PID_Update(int error, int *left_speed, int *right_speed);
+
+const steer_controller_t steer_controllers[STEER_CTRL_COUNT] = {
+    { "PD Sched  ", Line_Follow_PD_Init, Line_Follow_PD_Reset, Line_Follow_PD_V1 },
+    { "Prop      ", Steer_P_Init,        Steer_P_Reset,        Steer_P_Update },
+    { "PID       ", Steer_PID_Init,      Steer_PID_Reset,      Steer_PID_Update },
+    { "Relay     ", Autotune_Relay_Init, Autotune_Relay_Reset, Autotune_Relay_Update },
+};
+
+volatile unsigned char steer_ctrl_active = STEER_CTRL_PD;
+steer_p_params_t steer_p_params;
+steer_pid_params_t steer_pid_params;
+
+static pid_controller_t steer_pid_fixed;            // STEER_CTRL_PID state
+
+
+void Steer_Ctrl_Init(void) {
+    unsigned char i;
+    for (i = 0; i < STEER_CTRL_COUNT; i++) {
+        steer_controllers[i].init();
+        steer_controllers[i].reset();
+    }
+}
+
+
+unsigned char Steer_Ctrl_Select(unsigned int index) {
+    if (index >= STEER_CTRL_COUNT) {
+        return FALSE;
+    }
+    steer_controllers[index].reset();               // Fresh history before the ISR sees it
+    steer_ctrl_active = (unsigned char)index;
+    return TRUE;
+}
+
+
+// Motor supply for the fixed-speed controllers (cheap, only written on change)
+static void Steer_Hold_DAC(unsigned int dac) {
+    if (DAC_Get_Voltage() != dac) {
+        DAC_Set_Voltage(dac);
+    }
+}
+
+
+//==============================================================================
+// PROPORTIONAL
+// Centred: both wheels at base. Drifting: the wheel on the line's side slows by
+// |error| x kp (to TIPTOE at most). Past SHARP_TURN_THRESHOLD: inside wheel at
+// TIPTOE. Same sign as the PD - positive error speeds up the right wheel.
+//==============================================================================
+static void Steer_P_Init(void) {
+    steer_p_params.base = STEER_P_BASE;
+    steer_p_params.kp = PID_GAIN(STEER_P_KP);
+    steer_p_params.max_adjust = STEER_P_MAX_ADJUST;
+    steer_p_params.dac = STEER_DAC_STRAIGHT;
+}
+
+static void Steer_P_Reset(void) {
+    // No history
+}
+
+static void Steer_P_Update(int error, int *left_speed, int *right_speed) {
+    int abs_error = (error > 0) ? error : -error;
+    unsigned long adjust;
+    int inside;
+
+    Steer_Hold_DAC(steer_p_params.dac);
+    *left_speed = steer_p_params.base;
+    *right_speed = steer_p_params.base;
+
+    if (abs_error < DEADZONE) {
+        return;
+    }
+    if (abs_error < SHARP_TURN_THRESHOLD) {
+        adjust = ((unsigned long)abs_error * steer_p_params.kp) >> PID_GAIN_SHIFT;
+        if (adjust > steer_p_params.max_adjust) adjust = steer_p_params.max_adjust;
+        inside = (int)steer_p_params.base - (int)adjust;
+        if (inside < TIPTOE) inside = TIPTOE;
+    }
+    else {
+        inside = TIPTOE;
+    }
+
+    if (error > 0) {
+        *left_speed = inside;
+    }
+    else {
+        *right_speed = inside;
+    }
+}
+
+
+//==============================================================================
+// PID
+// One gain set, no deadzone or gain switch: left = base - out, right = base + out.
+// The only strategy with an integrator - for steady curves like the circle.
+//==============================================================================
+static void Steer_PID_Init(void) {
+    steer_pid_params.base = STEER_PID_BASE;
+    steer_pid_params.kp = PID_GAIN(STEER_PID_KP);
+    steer_pid_params.ki = STEER_PID_KI_Q4;
+    steer_pid_params.kd = PID_GAIN(STEER_PID_KD * CONTROL_RATE_SCALE);
+    steer_pid_params.max_correction = STEER_PID_MAX_CORRECTION;
+    steer_pid_params.dac = STEER_DAC_STRAIGHT;
+}
+
+static void Steer_PID_Reset(void) {
+    PID_Init(&steer_pid_fixed, steer_pid_params.kp, steer_pid_params.ki, steer_pid_params.kd,
+             steer_pid_params.max_correction);
+}
+
+static void Steer_PID_Update(int error, int *left_speed, int *right_speed) {
+    int output;
+
+    Steer_Hold_DAC(steer_pid_params.dac);
+    output = -PID_Update(&steer_pid_fixed, 0, error);      // Positive when the line is LEFT, like the PD
+    *left_speed = (int)steer_pid_params.base - output;
+    *right_speed = (int)steer_pid_params.base + output;
+}
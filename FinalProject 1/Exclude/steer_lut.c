@@ -0,0 +1,153 @@
+/*
+ * steer_lut.c
+ *
+ *  Created on: Dec 11, 2025
+ *      Author: Dallas.Owens
+ *
+ *  Description: Steering table for STEER_USE_LUT.
+ *               The generator runs the real controller - PID_Update with the
+ *               steering gains, then Line_Follow_Split - at every (error, rate)
+ *               grid point and stores the wheel offsets in FRAM. It only runs
+ *               when the stored table is missing or was built from different
+ *               parameters (steer_pd_params - defaults or auto-tuned). At
+ *               run time steering is a bilinear interpolation between the
+ *               four surrounding points: no gain switch, no PID.
+ *               Between grid points the deadzone and sharp-turn edges are
+ *               blended over one error step (64) instead of switching.
+ */
+
+#include "msp430.h"
+#include "macros.h"
+#include "control.h"
+#include "pid.h"
+#include "wheels.h"
+#include "steer_ctrl.h"
+#include "steer_lut.h"
+#include "fram.h"
+
+
+volatile unsigned int steer_lut_build_cycles = 0;
+
+// Built at boot, kept across resets until the steering parameters change
+#pragma PERSISTENT(steer_lut)
+steer_lut_t steer_lut = { 0 };
+
+
+static unsigned int Steer_LUT_CRC(void) {
+    return FRAM_CRC(&steer_lut, STEER_LUT_WORDS, STEER_LUT_CRC_SEED);
+}
+
+
+static unsigned char Steer_LUT_Valid(void) {
+    if (steer_lut.version != STEER_LUT_VERSION) return FALSE;
+    if (steer_lut.kp_gentle != steer_pd_params.kp_gentle) return FALSE;
+    if (steer_lut.kp_sharp != steer_pd_params.kp_sharp) return FALSE;
+    if (steer_lut.kd != steer_pd_params.kd) return FALSE;
+    if (steer_lut.max_correction != steer_pd_params.max_correction) return FALSE;
+    if (steer_lut.deadzone != DEADZONE) return FALSE;
+    if (steer_lut.sharp_threshold != SHARP_ERROR_THRESHOLD_V4) return FALSE;
+    return Steer_LUT_CRC() == steer_lut.crc;
+}
+
+
+void Steer_LUT_Init(void) {
+    // Called once at boot, before the control loop can run
+    if (!Steer_LUT_Valid()) {
+        Steer_LUT_Build();
+    }
+}
+
+
+//==============================================================================
+// GENERATOR
+// Each point is one PID_Update on a scratch controller set up so its filtered
+// rate is exactly the grid rate (no filter, last measurement = error - rate).
+// The table (~2.8 KB) is built in place rather than through a RAM image, so
+// program FRAM stays unlocked with interrupts off for the whole build (~700
+// points, a few tens of ms) - boot only.
+//==============================================================================
+void Steer_LUT_Build(void) {
+    unsigned int start = CYCLE_STAMP();
+    unsigned long cycles = 0;
+    unsigned int stamp;
+    fram_lock_t lock;
+    pid_controller_t scratch;
+    unsigned int e, r;
+    int error, rate, abs_error, pd_output;
+
+    FRAM_Unlock(&lock);
+
+    steer_lut.crc = ~steer_lut.crc;             // Invalidate first in case we reset mid-build
+    steer_lut.version = STEER_LUT_VERSION;
+    steer_lut.kp_gentle = steer_pd_params.kp_gentle;
+    steer_lut.kp_sharp = steer_pd_params.kp_sharp;
+    steer_lut.kd = steer_pd_params.kd;
+    steer_lut.max_correction = steer_pd_params.max_correction;
+    steer_lut.deadzone = DEADZONE;
+    steer_lut.sharp_threshold = SHARP_ERROR_THRESHOLD_V4;
+
+    for (e = 0; e <= STEER_LUT_ERR_STEPS; e++) {
+        error = STEER_LUT_ERR_MIN + (int)(e << STEER_LUT_ERR_SHIFT);
+        abs_error = (error > 0) ? error : -error;
+
+        for (r = 0; r <= STEER_LUT_RATE_STEPS; r++) {
+            rate = STEER_LUT_RATE_MIN + (int)(r << STEER_LUT_RATE_SHIFT);
+
+            PID_Init(&scratch, (abs_error > SHARP_ERROR_THRESHOLD_V4) ? steer_pd_params.kp_sharp
+                                                                       : steer_pd_params.kp_gentle,
+                     0, steer_pd_params.kd, steer_pd_params.max_correction);
+            scratch.d_filter_shift = 0;
+            scratch.first_update = FALSE;
+            scratch.last_measurement = error - rate;
+            pd_output = -PID_Update(&scratch, 0, error);
+
+            Line_Follow_Split(error, pd_output, &steer_lut.entry[e][r].left, &steer_lut.entry[e][r].right);
+        }
+        stamp = CYCLE_STAMP();                  // Accumulate per row - one row is well under a PWM period
+        cycles += CYCLES_SINCE(start, stamp);
+        start = stamp;
+    }
+
+    steer_lut.crc = Steer_LUT_CRC();            // Commit
+
+    FRAM_Relock(&lock);
+    steer_lut_build_cycles = (unsigned int)(cycles / 1000);
+}
+
+
+//==============================================================================
+// LOOKUP (Control_Update, ADC ISR)
+//==============================================================================
+static int Steer_LUT_Lerp(int a, int b, unsigned int frac, unsigned char shift) {
+    return a + (int)((((long)b - a) * (long)frac) >> shift);     // Signed - frac would make it unsigned where long is int (host)
+}
+
+void Steer_LUT_Lookup(int error, int rate, int *left_delta, int *right_delta) {
+    const steer_lut_entry_t *lo;
+    const steer_lut_entry_t *hi;
+    long e = (long)error - STEER_LUT_ERR_MIN;
+    long r = (long)rate - STEER_LUT_RATE_MIN;
+    unsigned int ei, ef, ri, rf;
+    int left0, left1, right0, right1;
+
+    // Clamp to the grid - last cell, fraction just under one step
+    if (e < 0) e = 0;
+    if (e >= ((long)STEER_LUT_ERR_STEPS << STEER_LUT_ERR_SHIFT)) e = ((long)STEER_LUT_ERR_STEPS << STEER_LUT_ERR_SHIFT) - 1;
+    if (r < 0) r = 0;
+    if (r >= ((long)STEER_LUT_RATE_STEPS << STEER_LUT_RATE_SHIFT)) r = ((long)STEER_LUT_RATE_STEPS << STEER_LUT_RATE_SHIFT) - 1;
+
+    ei = (unsigned int)e >> STEER_LUT_ERR_SHIFT;
+    ef = (unsigned int)e & ((1 << STEER_LUT_ERR_SHIFT) - 1);
+    ri = (unsigned int)r >> STEER_LUT_RATE_SHIFT;
+    rf = (unsigned int)r & ((1 << STEER_LUT_RATE_SHIFT) - 1);
+
+    lo = &steer_lut.entry[ei][ri];
+    hi = &steer_lut.entry[ei + 1][ri];
+    left0 = Steer_LUT_Lerp(lo[0].left, hi[0].left, ef, STEER_LUT_ERR_SHIFT);
+    left1 = Steer_LUT_Lerp(lo[1].left, hi[1].left, ef, STEER_LUT_ERR_SHIFT);
+    right0 = Steer_LUT_Lerp(lo[0].right, hi[0].right, ef, STEER_LUT_ERR_SHIFT);
+    right1 = Steer_LUT_Lerp(lo[1].right, hi[1].right, ef, STEER_LUT_ERR_SHIFT);
+
+    *left_delta = Steer_LUT_Lerp(left0, left1, rf, STEER_LUT_RATE_SHIFT);
+    *right_delta = Steer_LUT_Lerp(right0, right1, rf, STEER_LUT_RATE_SHIFT);
+}
@@ -14,10 +14,20 @@
 #include <string.h>
 #include "DAC.h"
 #include "calibration.h"
+#include "line_sensor.h"
+#include "control.h"
+#include "pid.h"
+#include "curvature.h"
+#include "steer_lut.h"
+#include "steer_ctrl.h"
+#include "autotune.h"
+#include "odometry.h"
+#include "runlog.h"
 #include "wheels.h"
 #include  "timers.h"
 #include  "LED.h"
 #include "switches.h"
+#include "motor.h"
 #include "PWM.h"
 
 
@@ -40,11 +50,30 @@ typedef enum {
     DRIVE_BACKUP,           // Backing up
     DRIVE_CIRCLE,           // Circling
     DRIVE_EXIT,             // Exiting circle
-    DRIVE_STOP              // Stopped - complete
+    DRIVE_STOP,             // Stopped - complete
+    DRIVE_STATE_COUNT
 } drive_state_t;
 
 drive_state_t drive_state = DRIVE_IDLE;
 
+typedef enum {                  // Why a transition fired (drive log)
+    DRIVE_CAUSE_COMMAND,        // IoT / start function
+    DRIVE_CAUSE_SWITCH,         // SW1/SW2 abort
+    DRIVE_CAUSE_TIMEOUT,        // Time in state elapsed
+    DRIVE_CAUSE_WHITE,          // Left the pad onto white
+    DRIVE_CAUSE_LINE_FOUND,     // A sensor is on the line
+    DRIVE_CAUSE_ALIGNED,        // Both sensors on the line
+    DRIVE_CAUSE_OFF_LINE,       // Not (or no longer) on the line
+    DRIVE_CAUSE_LINE_LOST,      // Search arc failed while tracking
+    DRIVE_CAUSE_CIRCLE,         // Curvature says circle
+    DRIVE_CAUSE_DONE            // Course complete
+} drive_cause_t;
+
+typedef void (*drive_hook_t)(void);
+
+static void Drive_Run_Reset(void);
+static void Drive_Change_State(drive_state_t to, drive_cause_t cause, drive_hook_t action);
+
 
 typedef enum {
 	SETUP_INIT,
@@ -75,7 +104,6 @@ setup_state_t setup_state = SETUP_INIT;
 volatile unsigned int drive_timer = 0;                       // Timer for state pauses
 unsigned char drive_pause_complete = FALSE;         // 10-20 second pause flag
 unsigned int circle_lap_count = 0;                  // Circle lap counter
-drive_state_t next_drive_state = DRIVE_IDLE;       // State to transition to after brake delay
 
 // GLOBALS
 extern char display_line[4][11];
@@ -106,13 +134,22 @@ extern unsigned char command_enabled;
 extern volatile unsigned char ebraking;
 unsigned char first_turn = TRUE;
 unsigned char circle_found = FALSE;
-unsigned int circle_detect_timer = 0;
-unsigned int in_potential_circle = FALSE;
 char pad_exit_direction = '\0';
 
 volatile unsigned int setup_timer = 0;
 volatile unsigned char process_setup = FALSE;
 unsigned char setup_direction = '\0';
+static unsigned long setup_distance_mark = 0;       // Odometry at the start of the current setup move
+static unsigned int setup_heading_mark = 0;
+static unsigned char last_low_confidence = TRUE;     // Online calibration confidence shown on display
+
+// LINE LOSS SEARCH (Line_Follow_Search)
+static volatile signed char search_side = 0;        // +1 line went car-left, -1 car-right, 0 tracking
+static unsigned int search_updates = 0;
+volatile unsigned int line_lost_events = 0;
+volatile unsigned int line_lost_recovered = 0;
+volatile unsigned int line_lost_updates = 0;
+volatile unsigned int line_lost_updates_max = 0;
 
 
 
@@ -122,6 +159,7 @@ void Line_Follow_Setup_LEFT(void) {
     command_enabled = FALSE;
     setup_timer = 0;
     setup_direction = 'L';
+    setup_distance_mark = Odometry_Distance();
 
     DAC_Set_Voltage(DAC_MOTOR_SLOW);
     PWM_FORWARD();
@@ -140,6 +178,7 @@ void Line_Follow_Setup_RIGHT(void) {
     command_enabled = FALSE;
     setup_timer = 0;
     setup_direction = 'R';
+    setup_distance_mark = Odometry_Distance();
 
     DAC_Set_Voltage(DAC_MOTOR_SLOW);
     PWM_FORWARD();
@@ -158,7 +197,8 @@ void Line_Follow_Setup_Process(void) {
     switch (setup_state) {
     case SETUP_INIT:
         // Going forward (already started in entry function)
-        if (setup_timer >= DRIVE_DELAY_MS(3000)) {
+        if (Odometry_Reached(setup_distance_mark, SETUP_FORWARD_MM) ||
+            (setup_timer >= DRIVE_DELAY_MS(SETUP_FORWARD_LIMIT_MS))) {
             setup_timer = 0;
             setup_state = DRIVE_PAST;
         }
@@ -169,6 +209,7 @@ void Line_Follow_Setup_Process(void) {
         Wheels_Safe_Stop();
         if (setup_timer >= DRIVE_DELAY_MS(500)) {
             setup_timer = 0;
+            setup_heading_mark = Odometry_Heading();
 
             if (setup_direction == 'L') {
                 PWM_ROTATE_LEFT();
@@ -183,7 +224,8 @@ void Line_Follow_Setup_Process(void) {
 
     case ROTATE_LEFT:
         // Rotating left (already started)
-        if (setup_timer >= DRIVE_DELAY_MS(300)) {
+        if (Odometry_Turned(setup_heading_mark, SETUP_TURN_DEG) ||
+            (setup_timer >= DRIVE_DELAY_MS(SETUP_TURN_LIMIT_MS))) {
             setup_timer = 0;
             setup_state = SETUP_COMPLETE;
         }
@@ -191,7 +233,8 @@ void Line_Follow_Setup_Process(void) {
 
     case ROTATE_RIGHT:
         // Rotating right (already started)
-        if (setup_timer >= DRIVE_DELAY_MS(300)) {
+        if (Odometry_Turned(setup_heading_mark, SETUP_TURN_DEG) ||
+            (setup_timer >= DRIVE_DELAY_MS(SETUP_TURN_LIMIT_MS))) {
             setup_timer = 0;
             setup_state = SETUP_COMPLETE;
         }
@@ -219,27 +262,35 @@ void Line_Follow_Setup_Process(void) {
 
 
 
-void Line_Follow_Start_LEFT_TURN(void)  // Exit pad turning LEFT
-{
-    if (!calibration_complete) {
+static unsigned char Line_Follow_Ready(void) {
+    // Online calibration lets the car start uncalibrated - thresholds adapt while driving
+    if (!calibration_complete && !online_calibration_enabled) {
         strcpy(display_line[0], "ERROR:    ");
         strcpy(display_line[1], "Must      ");
         strcpy(display_line[2], "calibrate ");
         strcpy(display_line[3], "first!    ");
         display_changed = 1;
-        return;
+        return FALSE;
     }
+    IR_Calibrate_Online_Reset();
+    last_low_confidence = calibration_low_confidence;
+    return TRUE;
+}
 
-    drive_state = DRIVE_TURN_LEFT;
+
+void Line_Follow_Start_LEFT_TURN(void)  // Exit pad turning LEFT
+{
+    if (!Line_Follow_Ready()) return;
+
+    Drive_Run_Reset();
     command_enabled = FALSE;
     process_line_follow = TRUE;
-    drive_timer = 0;
     display_menu = FALSE;
     pad_exit_direction = 'L';
 
-    Sample_ADC();
+    Control_Start();                        // Scans + steering at CONTROL_RATE_HZ
     DAC_Set_Voltage(DAC_MOTOR_SLOW);
-    PWM_Opening_Curve_Left();  // Start turning left in arc
+    Drive_Change_State(DRIVE_TURN_LEFT, DRIVE_CAUSE_COMMAND, NULL);    // Start turning left in arc
 
     TB1CCTL1 &= ~CCIFG;
     TB1CCTL1 |= CCIE;
@@ -248,25 +299,17 @@ void Line_Follow_Start_LEFT_TURN(void)  // Exit pad turning LEFT
 
 void Line_Follow_Start_RIGHT_TURN(void)  // Exit pad turning RIGHT
 {
-    if (!calibration_complete) {
-        strcpy(display_line[0], "ERROR:    ");
-        strcpy(display_line[1], "Must      ");
-        strcpy(display_line[2], "calibrate ");
-        strcpy(display_line[3], "first!    ");
-        display_changed = 1;
-        return;
-    }
+    if (!Line_Follow_Ready()) return;
 
-    drive_state = DRIVE_TURN_RIGHT;
+    Drive_Run_Reset();
     command_enabled = FALSE;
     process_line_follow = TRUE;
-    drive_timer = 0;
     display_menu = FALSE;
     pad_exit_direction = 'R';
 
-    Sample_ADC();
+    Control_Start();                        // Scans + steering at CONTROL_RATE_HZ
     DAC_Set_Voltage(DAC_MOTOR_SLOW);
-    PWM_Opening_Curve_Right();  // Start turning right in arc
+    Drive_Change_State(DRIVE_TURN_RIGHT, DRIVE_CAUSE_COMMAND, NULL);    // Start turning right in arc
 
     TB1CCTL1 &= ~CCIFG;
     TB1CCTL1 |= CCIE;
@@ -278,30 +321,19 @@ void Line_Follow_Start_RIGHT_TURN(void)  // Exit pad turning RIGHT
 
 void Line_Follow_Start_Autonomous(void)                         // Entry point for autonomous line following
 {                                                               // TRIGGERED BY: IoT command "AUTONOMOUS" or SW2 press
-    if (!calibration_complete) {
-        strcpy(display_line[0], "ERROR:    ");
-        strcpy(display_line[1], "Must      ");
-        strcpy(display_line[2], "calibrate ");
-        strcpy(display_line[3], "first!    ");
-        display_changed = 1;
-        return;
-    }
+    if (!Line_Follow_Ready()) return;
 
-    drive_state = DRIVE_START;
+    Drive_Run_Reset();
     command_enabled = FALSE;
     process_line_follow = TRUE;
-    drive_timer = 0;
     display_menu = FALSE;
 
     // drive_pause_complete = FALSE;
     // circle_lap_count = 0;
 
-    strcpy(display_line[0], "BL Start  ");
-    display_changed = 1;
-
-    Sample_ADC();
+    Control_Start();                        // Scans + steering at CONTROL_RATE_HZ
     DAC_Set_Voltage(DAC_MOTOR_SLOW);                          // Start driving toward line
-    PWM_FORWARD();
+    Drive_Change_State(DRIVE_START, DRIVE_CAUSE_COMMAND, NULL);
     
     TB1CCTL1 &= ~CCIFG;                     // Clear possible pending interrupt
     TB1CCTL1 |=  CCIE;                      // CCR1 enable interrupt
@@ -309,336 +341,494 @@ void Line_Follow_Start_Autonomous(void)                         // Entry point f
 }
 
 
-void Line_Follow_Process(void)                                                  // Called from main loop when process_line_follow flag set by ISR
-{                                                                               // drive_timer increments each call(100ms intervals)
-	if (!process_line_follow) return;
+//==============================================================================
+// DRIVE STATE MACHINE
+// drive_states[] gives each state an entry, during and exit hook.
+// drive_transitions[] lists what can leave each state. Every call the current
+// state's rows are tried in table order: the first whose timeout has passed
+// (drive_timer, 100ms ticks) and whose guard is TRUE fires - exit hook, row
+// action, entry hook of the new state. A row back to the same state is an
+// internal step: action only, drive_timer restarts, nothing logged.
+// If no row fires, the state's during hook runs.
+//==============================================================================
+typedef unsigned char (*drive_guard_t)(void);
+
+typedef struct {
+    drive_hook_t entry;
+    drive_hook_t during;                // Every call no transition fires
+    drive_hook_t exit;
+} drive_state_desc_t;
+
+typedef struct {
+    drive_state_t from;
+    drive_guard_t guard;                // NULL = timeout only
+    unsigned int timeout;               // DRIVE_DELAY_MS() in state before the guard is tried
+    drive_hook_t action;                // NULL = none
+    drive_state_t to;
+    drive_cause_t cause;
+} drive_transition_t;
+
+typedef struct {
+    unsigned char state;                // State entered
+    unsigned char cause;                // drive_cause_t
+    unsigned int time;                  // Run time at entry, 100ms ticks
+} drive_log_t;
+
+#define SEARCH_LIMIT_UPDATES    ((unsigned int)(((unsigned long)STEER_SEARCH_MS * CONTROL_RATE_HZ) / 1000))
+
+// Sensor snapshot for the guards, refreshed once per call
+static unsigned char left_on_line = FALSE;
+static unsigned char right_on_line = FALSE;
+
+// TRANSITION LOG / STATS (per run, cleared by Drive_Run_Reset)
+static drive_log_t drive_log[DRIVE_LOG_SIZE];
+static unsigned char drive_log_next = 0;
+static unsigned char drive_log_count = 0;
+static unsigned int drive_run_time = 0;                         // 100ms ticks, sum of completed dwells
+static unsigned int drive_dwell[DRIVE_STATE_COUNT];             // 100ms ticks spent in each state
+static unsigned int drive_entries[DRIVE_STATE_COUNT];
+unsigned int drive_dispatch_cycles = 0;                         // Last Line_Follow_Process dispatch (MCLK cycles)
+unsigned int drive_dispatch_cycles_max = 0;
+static unsigned long drive_distance_mark = 0;                   // Odometry at the start of a distance move
+
+
+// ----------------------------- GUARDS -----------------------------
+static unsigned char Drive_Guard_White(void) {
+    return (CAR_Left_Detect < (LEFT_WHITE_VALUE + 50)) && (CAR_Right_Detect < (RIGHT_WHITE_VALUE + 50));
+}
 
-    if (drive_state == DRIVE_IDLE) {
-        return;
+static unsigned char Drive_Guard_Any_Line(void) {
+    return left_on_line || right_on_line;
+}
+
+static unsigned char Drive_Guard_Reversed_Line(void) {
+    // PWM_REVERSE_PULSE - the car is still coasting forward until the dead time is out
+    return !PWM_Reversing() && (left_on_line || right_on_line);
+}
+
+static unsigned char Drive_Guard_Both_Line(void) {
+    return left_on_line && right_on_line;
+}
+
+static unsigned char Drive_Guard_First_Aligned(void) {
+    return left_on_line && right_on_line && first_turn;
+}
+
+static unsigned char Drive_Guard_Not_Both(void) {
+    return !left_on_line || !right_on_line;
+}
+
+static unsigned char Drive_Guard_Far_Off(void) {
+    return (CAR_Left_Detect < (LEFT_THRESHOLD - 100)) && (CAR_Right_Detect < (RIGHT_THRESHOLD - 100));
+}
+
+static unsigned char Drive_Guard_Away(void) {
+    return Odometry_Reached(drive_distance_mark, DRIVE_EXIT_MM);
+}
+
+static unsigned char Drive_Guard_Brake_Done(void) {
+    return !ebraking;
+}
+
+static unsigned char Drive_Guard_Unsettled(void) {
+    return !drive_pause_complete;
+}
+
+static unsigned char Drive_Guard_Search_Failed(void) {
+    // Line_Follow_Search (ISR) has been arcing since the line went
+    return drive_pause_complete && line_lost && (search_side != 0) && (search_updates >= SEARCH_LIMIT_UPDATES);
+}
+
+static unsigned char Drive_Guard_Circle(void) {
+    // Curvature_Check integrates travel since its last call - only this row calls it
+    return drive_pause_complete && !line_lost && !circle_found && Curvature_Check();
+}
+
+
+// ------------------------- HOOKS / ACTIONS -------------------------
+static void Drive_Enter_Turn_Left(void) {
+    PWM_Opening_Curve_Left();                   // Wide left arc - BOTH WHEELS MOVING
+}
+
+static void Drive_Enter_Turn_Right(void) {
+    PWM_Opening_Curve_Right();                  // Wide right arc - BOTH WHEELS MOVING
+}
+
+static void Drive_Enter_Start(void) {
+    PWM_FORWARD();                              // Seek the black line
+    strcpy(display_line[0], "BL Start  ");
+    display_changed = TRUE;
+}
+
+static void Drive_Intercept(void) {
+    if (left_on_line) {                         // Which sensor detected line first
+        left_first = TRUE;
     }
+    else if (right_on_line) {
+        right_first = TRUE;
+    }
+    PWM_EBRAKE();                               // 50ms reverse pulse to ebrake
+}
 
-    if (SW1_pressed || SW2_pressed){
-        SW1_pressed = FALSE;
-        SW2_pressed = FALSE;
+static void Drive_During_Brake_Recover(void) {
+    if (!ebraking) {                            // 50ms pulse done - hold still for the presentation
         Wheels_Safe_Stop();
-        process_line_follow = FALSE;
-        drive_state = DRIVE_IDLE;
-        display_menu = TRUE;
-        command_enabled = TRUE;
+        strcpy(display_line[0], "INTERCEPT ");
+        display_changed = TRUE;
     }
+}
 
-    unsigned char left_on_line = (CAR_Left_Detect > LEFT_THRESHOLD);            // Greater than threshold == On Line
-    unsigned char right_on_line = (CAR_Right_Detect > RIGHT_THRESHOLD);         // (less than thresh is off or drifting)
-
-    //DEBUG DISPLAY
-    // if(left_on_line || right_on_line){
-    //     strcpy(display_line[2], "          ");
-    //     if(left_on_line){
-    //         display_line[2][9] = 'L';
-    //     }
-    //     if (right_on_line){
-    //         display_line[2][0] = 'R';
-    //     }
-    //     display_changed = TRUE;
-    // }
-
-    switch (drive_state) 
-    {
-    case DRIVE_TURN_LEFT:
-        if (CAR_Left_Detect < (LEFT_WHITE_VALUE + 50) &&
-            CAR_Right_Detect < (RIGHT_WHITE_VALUE + 50)) {
-            // White detected - transition to seeking black line
-            PWM_FORWARD();
-            drive_state = DRIVE_START;
-            drive_timer = 0;
-
-            strcpy(display_line[0], "BL Start  ");
-            display_changed = TRUE;
-        }
-        else {
-            // Continue wide left arc - BOTH WHEELS MOVING
-            PWM_Opening_Curve_Left();  //
-        }
-        break;
+static void Drive_Enter_Raw_Align(void) {
+    strcpy(display_line[0], "BL Turn   ");
+    display_changed = TRUE;
+}
 
-    case DRIVE_TURN_RIGHT:
-        if (CAR_Left_Detect < (LEFT_WHITE_VALUE + 50) &&
-            CAR_Right_Detect < (RIGHT_WHITE_VALUE + 50)) {
-            // White detected - transition to seeking black line
-            PWM_FORWARD();
-            drive_state = DRIVE_START;
-            drive_timer = 0;
-            
-            strcpy(display_line[0], "BL Start  ");
-            display_changed = TRUE;
-        }
-        else {
-            // Continue wide right arc - BOTH WHEELS MOVING
-            PWM_Opening_Curve_Right();  //
-        }
-        break;
+static void Drive_During_Raw_Align(void) {
+    // Turn the car parallel to the line (perpendicular and angled approaches)
+    if (left_on_line || right_on_line) {
+        Wheels_Safe_Stop();
+    }
+    else if (pad_exit_direction == 'L') {
+        PWM_ROTATE_RIGHT();
+    }
+    else if (pad_exit_direction == 'R') {
+        PWM_ROTATE_LEFT();
+    }
+    else if (right_first) {
+        PWM_ROTATE_LEFT();
+    }
+    else if (left_first) {
+        PWM_ROTATE_RIGHT();
+    }
+}
 
-    case DRIVE_START:
-        if (left_on_line || right_on_line) {
-            if(left_on_line) {
-                left_first = TRUE;
-                // strcpy(display_line[1], "L First   ");       //DEBUG
-            }
-            else if (right_on_line) {
-                right_first = TRUE;
-                // strcpy(display_line[1], "R First   ");    //DEBUG
-            }
-            if (left_first && right_first) {
-            }
-            // Line detected - 50ms reverse pulse to ebrake
-            PWM_EBRAKE();
+static void Drive_Raw_Aligned(void) {
+    Wheels_Safe_Stop();
+    left_first = FALSE;                         // Reset tracking for next alignment if needed
+    right_first = FALSE;
+}
 
-            drive_state = DRIVE_BRAKE_RECOVER;                          // Wait 500ms for motor recovery
-            drive_timer = 0;
-        }
-        break;
+static void Drive_Enter_Tune_Align(void) {
+    DAC_Set_Voltage(DAC_MOTOR_CRAWL);
+}
 
-    case DRIVE_BRAKE_RECOVER:
-        // After 50ms intercept brake pulse, wait 500ms total for motor recovery
-        // Motors are already stopped by Wheels_Intercept_Brake()
-        if (!ebraking){ // 50ms
-            // Stop motors using PWM function
-            Wheels_Safe_Stop();
-            strcpy(display_line[0], "INTERCEPT ");
-            display_changed = TRUE;
-            // 500ms safety delay elapsed - safe to proceed with alignment
-            if (drive_timer >= DRIVE_DELAY_MS(PRESENTATION_DELAY)) {
-                drive_state = DRIVE_RAW_ALIGN;
-                drive_timer = 0;
-                strcpy(display_line[0], "BL Turn   ");
-                display_changed = TRUE;
-            }
-        }
-        break;
+static void Drive_Tune_Align_Step(void) {
+    // Every 500ms nudge toward whichever side sees more line
+    if (left_on_line && !right_on_line) {
+        PWM_ROTATE_LEFT();
+    }
+    else if (!left_on_line && right_on_line) {
+        PWM_ROTATE_RIGHT();
+    }
+    else if (CAR_Left_Detect > CAR_Right_Detect) {
+        PWM_ROTATE_LEFT();
+    }
+    else {
+        PWM_ROTATE_RIGHT();
+    }
+}
+
+static void Drive_Presented(void) {
+    strcpy(display_line[0], "BL Travel ");
+    display_changed = TRUE;
+    first_turn = FALSE;
+}
 
+static void Drive_Enter_Pause(void) {
+    drive_pause_complete = FALSE;
+}
 
-        case DRIVE_RAW_ALIGN:
-        // After intercept brake, align the car to be parallel with the line
-        // This handles perpendicular and angled approaches
-
-            if (!left_on_line && !right_on_line) {
-                if (pad_exit_direction != '\0') {
-                    switch (pad_exit_direction) {
-                    case 'L':
-                        PWM_ROTATE_RIGHT();
-                        break;
-                    case 'R':
-                        PWM_ROTATE_LEFT();
-                        break;
-                    }
-                }
-                else {
-                    if (right_first) {
-                        PWM_ROTATE_LEFT();
-                    }
-                    else if (left_first) {
-                        PWM_ROTATE_RIGHT();
-                    }
-                }
-            }
-        else{
-            Wheels_Safe_Stop();
-            if (drive_timer >= DRIVE_DELAY_MS(500)) {
-                next_drive_state = DRIVE_TRAVEL;
-                drive_state = DRIVE_TUNE_ALIGN;
-                // drive_state = DRIVE_BRAKE_DELAY;
-                drive_timer = 0;
-                drive_pause_complete = FALSE;
-                left_first = FALSE;   // Reset tracking for next alignment if needed
-                right_first = FALSE;
-                // strcpy(display_line[0], "BL Travel ");
-                // display_changed = TRUE;
-            }
-            }
-        break;
+static void Drive_Enter_Travel(void) {
+    DAC_Set_Voltage(DAC_MOTOR_SLOW);
+    drive_pause_complete = FALSE;
+}
 
-    case DRIVE_TUNE_ALIGN:
-        DAC_Set_Voltage(DAC_MOTOR_CRAWL);
-        if(left_on_line && right_on_line){
-            Wheels_Safe_Stop();
-            // next_drive_state = DRIVE_TRAVEL;
-            if (first_turn){
-                drive_state  = DRIVE_TRAVEL_DELAY;
-            }
-            drive_state = DRIVE_BRAKE_DELAY;
-            drive_timer = 0;
-            drive_pause_complete = FALSE;
-        }
-        else if (drive_timer >= DRIVE_DELAY_MS(500)){
-            drive_timer = 0;
-            if(left_on_line && !right_on_line){
-                PWM_ROTATE_LEFT();
-            }
-            else if(!left_on_line && right_on_line){
-                PWM_ROTATE_RIGHT();
-            }
-            else if((CAR_Left_Detect < (LEFT_THRESHOLD - 100)) && (CAR_Right_Detect < (RIGHT_THRESHOLD - 100))){
-                // Both far off line - back up
-                PWM_REVERSE_PULSE();
-                drive_state = DRIVE_BACKUP;
-            }
-            else{
-                if(CAR_Left_Detect > CAR_Right_Detect){
-                    PWM_ROTATE_LEFT();
-                }
-                else{
-                    PWM_ROTATE_RIGHT();
-                }
-            }
-        }
-        break;
+static void Drive_Travel_Settled(void) {
+    drive_pause_complete = TRUE;                // Steering takes over (control_steering below)
+    Curvature_Reset();
+}
 
-    case DRIVE_TRAVEL_DELAY:
-        if (drive_timer >= DRIVE_DELAY_MS(PRESENTATION_DELAY)){
-            drive_state = DRIVE_BRAKE_DELAY;
-            drive_timer = 0;
-            strcpy(display_line[0], "BL Travel ");
-            display_changed = TRUE;
-            first_turn = FALSE;
-        }
-        break;
+static void Drive_Exit_Travel(void) {
+    control_steering = FALSE;                   // Keep the ISR off the wheels from here on
+}
 
-    case DRIVE_BRAKE_DELAY:
-        if (drive_timer >= DRIVE_DELAY_MS(500)) {
-            drive_timer = 0;
+static void Drive_Search_Failed(void) {
+    search_side = 0;                            // Arc failed - not a recovery
+    PWM_REVERSE_PULSE();
+    Curvature_Reset();
+}
 
-            // 500ms brake delay complete - transition to next state
-            if (!right_on_line || !left_on_line){
-                drive_state = DRIVE_TUNE_ALIGN;
-            }
-            else {
-                DAC_Set_Voltage(DAC_MOTOR_SLOW);
-                drive_state = DRIVE_TRAVEL;
-                drive_pause_complete = FALSE;
-            }
-        }
-        break;
+static void Drive_Enter_Circle(void) {
+    Wheels_Safe_Stop();
+    Curvature_Reset();
+    circle_found = TRUE;
+    Runlog_Circle_Enter(drive_run_time);
+    strcpy(display_line[0], "BL Circle ");
+    display_changed = TRUE;
+}
 
-    case DRIVE_TRAVEL:
-        if (!drive_pause_complete) {
-            if (drive_timer >= DRIVE_DELAY_MS(500)) {
-                drive_pause_complete = TRUE;
-                drive_timer = 0;
-                circle_detect_timer = 0;        // Reset circle detection
-                in_potential_circle = FALSE;
-            }
-        }
-        else if (!left_on_line && !right_on_line) {
-            // Line lost - stop and search
-            if (drive_timer >= DRIVE_DELAY_MS(500)) {
-                PWM_REVERSE_PULSE();
-                drive_state = DRIVE_BACKUP;
-                drive_timer = 0;
-                circle_detect_timer = 0;        // Reset on line lost
-                in_potential_circle = FALSE;
+static void Drive_Enable_Commands(void) {
+    command_enabled = TRUE;                     // Wait for X (exit) while aligned on the circle
+}
+
+static void Drive_Enter_Exit(void) {
+    Wheels_Safe_Stop();
+    Runlog_Circle_Exit(drive_run_time);
+    strcpy(display_line[0], "BL Exit   ");
+    display_changed = TRUE;
+}
+
+static void Drive_Away(void) {
+    DAC_Set_Voltage(DAC_MOTOR_SLOW);            // Drive away 2+ feet
+    PWM_FORWARD();
+    drive_distance_mark = Odometry_Distance();
+}
+
+static void Drive_Finish(void) {
+    // Course complete
+    Wheels_Safe_Stop();
+    DAC_Set_Voltage(DAC_MOTOR_OFF);
+    if (!calibration_low_confidence) {
+        Calibration_Save();                     // Keep end-of-run thresholds for next boot
+    }
+
+    strcpy(display_line[0], " BL Stop  ");
+    strcpy(display_line[1], "Dont Drink");
+    strcpy(display_line[2], "and Derive");
+    display_changed = TRUE;
+
+    process_line_follow = FALSE;
+    command_enabled = TRUE;
+    Control_Stop();
+//    display_menu = TRUE;
+
+    TB1CCTL1 &= ~CCIFG;
+    TB1CCTL1 &= ~CCIE;
+}
+
+static void Drive_Abort(void) {
+    Control_Stop();
+    Wheels_Safe_Stop();
+    process_line_follow = FALSE;
+    display_menu = TRUE;
+    command_enabled = TRUE;
+}
+
+
+// ------------------------------ TABLES ------------------------------
+// Indexed by drive_state_t                 entry                   during                      exit
+static const drive_state_desc_t drive_states[DRIVE_STATE_COUNT] = {
+    /* DRIVE_IDLE          */ { NULL,                   NULL,                       NULL },
+    /* DRIVE_TURN_LEFT     */ { Drive_Enter_Turn_Left,  Drive_Enter_Turn_Left,      NULL },
+    /* DRIVE_TURN_RIGHT    */ { Drive_Enter_Turn_Right, Drive_Enter_Turn_Right,     NULL },
+    /* DRIVE_START         */ { Drive_Enter_Start,      NULL,                       NULL },
+    /* DRIVE_BRAKE_RECOVER */ { NULL,                   Drive_During_Brake_Recover, NULL },
+    /* DRIVE_RAW_ALIGN     */ { Drive_Enter_Raw_Align,  Drive_During_Raw_Align,     NULL },
+    /* DRIVE_TUNE_ALIGN    */ { Drive_Enter_Tune_Align, NULL,                       NULL },
+    /* DRIVE_TRAVEL_DELAY  */ { NULL,                   NULL,                       NULL },
+    /* DRIVE_BRAKE_DELAY   */ { Drive_Enter_Pause,      NULL,                       NULL },
+    /* DRIVE_INTERCEPT     */ { NULL,                   NULL,                       NULL },
+    /* DRIVE_TURN          */ { NULL,                   NULL,                       NULL },
+    /* DRIVE_TRAVEL        */ { Drive_Enter_Travel,     NULL,                       Drive_Exit_Travel },
+    /* DRIVE_BACKUP        */ { NULL,                   NULL,                       NULL },
+    /* DRIVE_CIRCLE        */ { Drive_Enter_Circle,     NULL,                       NULL },
+    /* DRIVE_EXIT          */ { Drive_Enter_Exit,       NULL,                       NULL },
+    /* DRIVE_STOP          */ { NULL,                   NULL,                       NULL },
+};
+
+// Rows for a state are tried top to bottom
+static const drive_transition_t drive_transitions[] = {
+//    from                 guard                       timeout                             action                  to                  cause
+    { DRIVE_TURN_LEFT,     Drive_Guard_White,          0,                                  NULL,                   DRIVE_START,        DRIVE_CAUSE_WHITE },
+    { DRIVE_TURN_RIGHT,    Drive_Guard_White,          0,                                  NULL,                   DRIVE_START,        DRIVE_CAUSE_WHITE },
+    { DRIVE_START,         Drive_Guard_Any_Line,       0,                                  Drive_Intercept,        DRIVE_BRAKE_RECOVER, DRIVE_CAUSE_LINE_FOUND },
+    { DRIVE_BRAKE_RECOVER, Drive_Guard_Brake_Done,     DRIVE_DELAY_MS(PRESENTATION_DELAY), NULL,                   DRIVE_RAW_ALIGN,    DRIVE_CAUSE_TIMEOUT },
+    { DRIVE_RAW_ALIGN,     Drive_Guard_Any_Line,       DRIVE_DELAY_MS(500),                Drive_Raw_Aligned,      DRIVE_TUNE_ALIGN,   DRIVE_CAUSE_LINE_FOUND },
+    { DRIVE_TUNE_ALIGN,    Drive_Guard_First_Aligned,  0,                                  Wheels_Safe_Stop,       DRIVE_TRAVEL_DELAY, DRIVE_CAUSE_ALIGNED },
+    { DRIVE_TUNE_ALIGN,    Drive_Guard_Both_Line,      0,                                  Wheels_Safe_Stop,       DRIVE_BRAKE_DELAY,  DRIVE_CAUSE_ALIGNED },
+    { DRIVE_TUNE_ALIGN,    Drive_Guard_Far_Off,        DRIVE_DELAY_MS(500),                PWM_REVERSE_PULSE,      DRIVE_BACKUP,       DRIVE_CAUSE_OFF_LINE },
+    { DRIVE_TUNE_ALIGN,    NULL,                       DRIVE_DELAY_MS(500),                Drive_Tune_Align_Step,  DRIVE_TUNE_ALIGN,   DRIVE_CAUSE_TIMEOUT },
+    { DRIVE_TRAVEL_DELAY,  NULL,                       DRIVE_DELAY_MS(PRESENTATION_DELAY), Drive_Presented,        DRIVE_BRAKE_DELAY,  DRIVE_CAUSE_TIMEOUT },
+    { DRIVE_BRAKE_DELAY,   Drive_Guard_Not_Both,       DRIVE_DELAY_MS(500),                NULL,                   DRIVE_TUNE_ALIGN,   DRIVE_CAUSE_OFF_LINE },
+    { DRIVE_BRAKE_DELAY,   NULL,                       DRIVE_DELAY_MS(500),                NULL,                   DRIVE_TRAVEL,       DRIVE_CAUSE_TIMEOUT },
+    { DRIVE_TRAVEL,        Drive_Guard_Unsettled,      DRIVE_DELAY_MS(500),                Drive_Travel_Settled,   DRIVE_TRAVEL,       DRIVE_CAUSE_TIMEOUT },
+    { DRIVE_TRAVEL,        Drive_Guard_Search_Failed,  0,                                  Drive_Search_Failed,    DRIVE_BACKUP,       DRIVE_CAUSE_LINE_LOST },
+    { DRIVE_TRAVEL,        Drive_Guard_Circle,         0,                                  NULL,                   DRIVE_CIRCLE,       DRIVE_CAUSE_CIRCLE },
+    { DRIVE_CIRCLE,        NULL,                       DRIVE_DELAY_MS(PRESENTATION_DELAY), Drive_Enable_Commands,  DRIVE_TUNE_ALIGN,   DRIVE_CAUSE_TIMEOUT },
+    { DRIVE_EXIT,          NULL,                       DRIVE_DELAY_MS(PRESENTATION_DELAY), Drive_Away,             DRIVE_STOP,         DRIVE_CAUSE_TIMEOUT },
+    { DRIVE_STOP,          Drive_Guard_Away,           0,                                  Drive_Finish,           DRIVE_IDLE,         DRIVE_CAUSE_DONE },
+    { DRIVE_STOP,          NULL,                       DRIVE_DELAY_MS(DRIVE_EXIT_LIMIT_MS), Drive_Finish,          DRIVE_IDLE,         DRIVE_CAUSE_TIMEOUT },
+    { DRIVE_BACKUP,        Drive_Guard_Reversed_Line,  0,                                  Wheels_Safe_Stop,       DRIVE_TUNE_ALIGN,   DRIVE_CAUSE_LINE_FOUND },
+};
+#define DRIVE_TRANSITION_COUNT  (sizeof(drive_transitions) / sizeof(drive_transitions[0]))
+
+
+// ----------------------------- DISPATCH -----------------------------
+static void Drive_Run_Reset(void) {
+    unsigned char i;
+    for (i = 0; i < DRIVE_STATE_COUNT; i++) {
+        drive_dwell[i] = 0;
+        drive_entries[i] = 0;
+    }
+    drive_log_next = 0;
+    drive_log_count = 0;
+    drive_run_time = 0;
+    drive_dispatch_cycles_max = 0;
+    drive_state = DRIVE_IDLE;
+    drive_timer = 0;
+    Runlog_Start();
+}
+
+static void Drive_Add_Dwell(void) {
+    unsigned int ticks = drive_timer;
+    drive_dwell[drive_state] += ticks;
+    drive_run_time += ticks;
+    drive_timer = 0;
+}
+
+// Leave the current state for 'to': exit hook, action, log, entry hook
+static void Drive_Change_State(drive_state_t to, drive_cause_t cause, drive_hook_t action) {
+    if (drive_states[drive_state].exit) {
+        drive_states[drive_state].exit();
+    }
+    if (action) {
+        action();
+    }
+    Drive_Add_Dwell();
+
+    drive_log[drive_log_next].state = (unsigned char)to;
+    drive_log[drive_log_next].cause = (unsigned char)cause;
+    drive_log[drive_log_next].time = drive_run_time;
+    drive_log_next = (drive_log_next + 1) % DRIVE_LOG_SIZE;
+    if (drive_log_count < DRIVE_LOG_SIZE) {
+        drive_log_count++;
+    }
+
+    if (to == DRIVE_IDLE) {
+        Runlog_End((cause == DRIVE_CAUSE_DONE) ? RUNLOG_END_DONE :
+                   (cause == DRIVE_CAUSE_TIMEOUT) ? RUNLOG_END_TIMEOUT : RUNLOG_END_ABORT,
+                   drive_run_time, drive_dwell, DRIVE_STATE_COUNT);
+    }
+
+    drive_state = to;
+    drive_entries[to]++;
+    if (drive_states[to].entry) {
+        drive_states[to].entry();
+    }
+}
+
+static void Drive_Dispatch(void) {
+    unsigned int start = CYCLE_STAMP();
+    unsigned int end;
+    const drive_transition_t *row;
+    unsigned char i;
+
+    for (i = 0; i < DRIVE_TRANSITION_COUNT; i++) {
+        row = &drive_transitions[i];
+        if (row->from != drive_state) continue;
+        if (drive_timer < row->timeout) continue;
+        if (row->guard && !row->guard()) continue;
+
+        if (row->to == drive_state) {           // Internal step
+            if (row->action) {
+                row->action();
             }
+            Drive_Add_Dwell();
         }
         else {
-            drive_timer = 0;
-
-            // Calculate error to detect turning direction
-            int left_drift = CAR_Left_Detect - LEFT_THRESHOLD;
-            int right_drift = CAR_Right_Detect - RIGHT_THRESHOLD;
-            int error = left_drift - right_drift;
-
-            // Circle detection
-            // Positive error = drifting LEFT, which = turning RIGHT (clockwise)
-            if (!circle_found) {
-                if (error > 50) {  // Turning right
-                    circle_detect_timer++;
-                    if (!in_potential_circle && circle_detect_timer >= DRIVE_DELAY_MS(1000)) {
-                        in_potential_circle = TRUE;  // 1 second of right turn detected
-                    }
-                    // After 3 seconds of sustained right turn, we're in circle
-                    if (in_potential_circle && circle_detect_timer >= DRIVE_DELAY_MS(3000)) {
-						Wheels_Safe_Stop();
-                        drive_state = DRIVE_CIRCLE;
-                        drive_timer = 0;
-                        circle_detect_timer = 0;
-                        in_potential_circle = FALSE;
-                        circle_found = TRUE;
-
-
-                        strcpy(display_line[0], "BL Circle ");
-                        display_changed = TRUE;
-                    }
-                }
-                else {
-                    // Not turning right consistently - reset detection
-                    circle_detect_timer = 0;
-                    in_potential_circle = FALSE;
-                }
-            }
-
-            Line_Follow_PD_V1();
-            //strcpy(display_line[0], "BL Travel ");
-            display_changed = TRUE;
+            Drive_Change_State(row->to, row->cause, row->action);
         }
         break;
+    }
+    if ((i == DRIVE_TRANSITION_COUNT) && drive_states[drive_state].during) {
+        drive_states[drive_state].during();
+    }
 
-	case DRIVE_CIRCLE:
-		if (drive_timer >= DRIVE_DELAY_MS(PRESENTATION_DELAY)) {
-			drive_timer = 0;
-            drive_state = DRIVE_TUNE_ALIGN;
-            command_enabled = TRUE;
-		}
-        break;
+    // Only meaningful below one PWM period (6.25ms) - Calibration_Save on DRIVE_STOP is longer
+    end = CYCLE_STAMP();
+    drive_dispatch_cycles = CYCLES_SINCE(start, end);
+    if (drive_dispatch_cycles > drive_dispatch_cycles_max) {
+        drive_dispatch_cycles_max = drive_dispatch_cycles;
+    }
+}
 
 
-    case DRIVE_EXIT:
-        // Exit circle and drive away 2+ feet
-        strcpy(display_line[0], "BL Exit   ");
-        display_changed = TRUE;
-        Wheels_Safe_Stop();
+void Line_Follow_Process(void)                                                  // Called from main loop when process_line_follow flag set by ISR
+{                                                                               // drive_timer increments every 100ms (TB1 CCR1)
+	if (!process_line_follow) return;
 
-        if (drive_timer >= DRIVE_DELAY_MS(PRESENTATION_DELAY)) {
-            drive_timer = 0;
-            DAC_Set_Voltage(DAC_MOTOR_SLOW);
-            PWM_FORWARD();
-            drive_state = DRIVE_STOP;
-        }
-        break;
+    if (drive_state == DRIVE_IDLE) {
+        return;
+    }
 
+    if (SW1_pressed || SW2_pressed){
+        SW1_pressed = FALSE;
+        SW2_pressed = FALSE;
+        Drive_Change_State(DRIVE_IDLE, DRIVE_CAUSE_SWITCH, Drive_Abort);
+        return;
+    }
 
-    case DRIVE_STOP:
-        // Course complete
-        if (drive_timer >= DRIVE_DELAY_MS(3000)) {
-            Wheels_Safe_Stop();
-            DAC_Set_Voltage(DAC_MOTOR_OFF);
+    IR_Calibrate_Online_Update();                                               // Track black/white drift while driving
+    // line_norm[] / line_position / line_lost are refreshed every scan by Control_Update()
+    if (calibration_low_confidence != last_low_confidence) {
+        last_low_confidence = calibration_low_confidence;
+        strcpy(display_line[2], calibration_low_confidence ? "Cal: LOW  " : "Cal: OK   ");
+        display_changed = TRUE;
+    }
 
-            strcpy(display_line[0], " BL Stop  ");
-            strcpy(display_line[1], "Dont Drink");
-            strcpy(display_line[2], "and Derive");
-            display_changed = TRUE;
+    left_on_line = (CAR_Left_Detect > LEFT_THRESHOLD);                          // Greater than threshold == On Line
+    right_on_line = (CAR_Right_Detect > RIGHT_THRESHOLD);                       // (less than thresh is off or drifting)
 
-            process_line_follow = FALSE;
-            command_enabled = TRUE;
-//            display_menu = TRUE;
+    Drive_Dispatch();
+    Autotune_Process();                                                         // Relay cycles in -> new PD gains
 
-            TB1CCTL1 &= ~CCIFG;
-            TB1CCTL1 &= ~CCIE;
-        }
-        break;
+    // High-rate steering only while tracking - any state change above hands the wheels back
+    control_steering = (drive_state == DRIVE_TRAVEL) && drive_pause_complete && process_line_follow;
+}
 
 
-    case DRIVE_BACKUP:
-        if( right_on_line || left_on_line ){
-            Wheels_Safe_Stop();
-            drive_state = DRIVE_TUNE_ALIGN;
-            drive_timer = 0;
-        }
-        break;
+//==============================================================================
+// DRIVE STATS DISPLAY (IoT G command)
+//     index < DRIVE_STATE_COUNT => that state's dwell (100ms ticks), entries and
+//                                  the worst dispatch cost (MCLK cycles)
+//     index >= DRIVE_LOG_BASE   => transition log, DRIVE_LOG_BASE = newest
+//==============================================================================
+static void Drive_Stat_Line(char line, const char *label, unsigned int value) {
+    strcpy(display_line[line - 1], label);
+    HEXtoBCD((value > 9999) ? 9999 : (int)value);
+    adc_line(line, 6);
+}
+
+void Display_Drive_Stats(unsigned int index) {
+    unsigned int age;
+    unsigned char slot;
+
+    if (index < DRIVE_STATE_COUNT) {
+        Drive_Stat_Line(1, "State     ", index);
+        Drive_Stat_Line(2, "Dwell     ", drive_dwell[index] + ((index == drive_state) ? drive_timer : 0));
+        Drive_Stat_Line(3, "Enter     ", drive_entries[index]);
+        Drive_Stat_Line(4, "Disp      ", drive_dispatch_cycles_max);
     }
+    else if ((index >= DRIVE_LOG_BASE) && ((index - DRIVE_LOG_BASE) < drive_log_count)) {
+        age = index - DRIVE_LOG_BASE;
+        slot = (unsigned char)((drive_log_next + DRIVE_LOG_SIZE - 1 - age) % DRIVE_LOG_SIZE);
+        Drive_Stat_Line(1, "Log       ", age);
+        Drive_Stat_Line(2, "State     ", drive_log[slot].state);
+        Drive_Stat_Line(3, "Time      ", drive_log[slot].time);
+        Drive_Stat_Line(4, "Cause     ", drive_log[slot].cause);
+    }
+    else {
+        strcpy(display_line[0], "Drive     ");
+        strcpy(display_line[1], "No Entry  ");
+        strcpy(display_line[2], "          ");
+        strcpy(display_line[3], "          ");
+    }
+    display_changed = TRUE;
 }
 
 void Line_Follow_Exit_Circle(void){                             // FN done!
-    drive_state = DRIVE_EXIT;
-    Wheels_Safe_Stop();                                 // Safely stop all motors
+    control_steering = FALSE;
+    Drive_Change_State(DRIVE_EXIT, DRIVE_CAUSE_COMMAND, NULL);  // Entry safely stops all motors
     DAC_Set_Voltage(DAC_MOTOR_OFF);
 }
 
@@ -647,67 +837,127 @@ void Line_Follow_Exit_Circle(void){                             // FN done!
 //      PD CONTROLLER LOGIC - THE GOOD STUFF!
 // =============================================================================
 // REMEMBER:   int error = left_drift - right_drift;   AKA: POSITIVE when line is LEFT
+// Called from Control_Update() (ADC ISR) at CONTROL_RATE_HZ
 // =============================================================================
-void Line_Follow_PD_V1 (void){
-    static int previous_error = 0;
-    static unsigned char first_run = TRUE;
-    // PD Controller Constants (same as V4)
-	// MOVE TO MACROS WHEN DONE TUNING
-    #define Kp_GENTLE_V4                (150)                       // Proportional gain for small corrections
-    #define Kp_SHARP_V4                 (300)                       // Proportional gain for sharp turns
-    #define Kd_V4                       (20)                        // Derivative gain
-    #define BASE_SPEED_STRAIGHT_V4      (CRAWL)                     // Speed when centered
-    #define BASE_SPEED_TURN_V4          (TIPTOE)                    // Slower speed in turns
-    #define MAX_CORRECTION_V4           (25000)                     // Maximum PWM correction
-    #define SHARP_ERROR_THRESHOLD_V4    (SHARP_TURN_THRESHOLD)      // When to use aggressive response
-    
-    // Calculate drift 
-    int left_drift = CAR_Left_Detect - LEFT_THRESHOLD;
-    int right_drift = CAR_Right_Detect - RIGHT_THRESHOLD;
-    
-    // error calc [proportional] (positive = drifting left, negative = drifting right)
-    int error = left_drift - right_drift;
-    int abs_error = (error > 0) ? error : -error;
-    
-    // derivative calc (reaction speed)
-    int derivative = 0;
-    if (!first_run) {
-        derivative = error - previous_error;
+// PD Controller Constants (tuning values in steer_params.h, gains in wheels.h)
+#define SPEED_ACCEL_STEP            (STEER_ACCEL / CONTROL_RATE_HZ)     // PWM counts per update
+#define SPEED_DECEL_STEP            (STEER_DECEL / CONTROL_RATE_HZ)
+
+pid_controller_t steer_pid;
+steer_pd_params_t steer_pd_params;                  // Gains in use (Q12.4) - Line_Follow_PD_Init loads the defaults
+static pid_controller_t steer_history;              // Error rate only, kept for every controller (line loss side)
+volatile unsigned int steer_cycles = 0;             // Last Line_Follow_Steer cost (MCLK cycles)
+volatile unsigned int steer_cycles_max = 0;
+static unsigned int steer_load = 0;                 // Filtered |error|, in error units
+static unsigned int steer_speed = MIN_AUTO_SPEED;   // Scheduled base speed (PWM counts)
+
+void Line_Follow_PD_Init(void) {
+    steer_pd_params.kp_gentle = Kp_GENTLE_V4;
+    steer_pd_params.kp_sharp = Kp_SHARP_V4;
+    steer_pd_params.ki = Ki_V4;
+    steer_pd_params.kd = Kd_V4;
+    steer_pd_params.max_correction = MAX_CORRECTION_V4;
+}
+
+void Line_Follow_PD_Reset(void) {
+    PID_Init(&steer_pid, steer_pd_params.kp_gentle, steer_pd_params.ki, steer_pd_params.kd,
+             steer_pd_params.max_correction);
+    steer_load = MAX_ERROR;                         // Start slow, accelerate once tracking settles
+    steer_speed = MIN_AUTO_SPEED;
+}
+
+void Line_Follow_Steer_Reset(void) {
+    PID_Init(&steer_history, 0, 0, 0, 0);
+    search_side = 0;
+    steer_cycles_max = 0;
+    steer_controllers[steer_ctrl_active].reset();
+}
+
+
+// =============================================================================
+// LINE LOSS SEARCH
+// The last measurement and filtered rate are the error history: project
+// them STEER_LOST_LOOKAHEAD updates ahead to pick the side the line left on
+// (a line drifting toward centre when lost has crossed to the other side).
+// Then pivot toward it on the inside wheel. Line_Follow_Process bounds the arc.
+// =============================================================================
+void Line_Follow_Search(void) {
+    long predicted;
+
+    if (search_side == 0) {                         // First update of this excursion
+        predicted = (long)steer_history.last_measurement + ((long)steer_history.d_filtered * STEER_LOST_LOOKAHEAD);
+        if (predicted == 0) {
+            predicted = line_position;              // No history - side the centroid held
+        }
+        search_side = (predicted > 0) ? 1 : -1;
+        search_updates = 0;
+        line_lost_events++;
+#if STEER_SEARCH
+        DAC_Set_Voltage(STEER_DAC_CURVE);
+#endif
     }
-    else {
-        first_run = FALSE;
+    if (search_updates < 0xFFFF) {
+        search_updates++;
     }
-    previous_error = error;
-    
-    // STRONG Kp: Base not enought for sharp turns, Stronger Kp - slower speed
-    int Kp_active;
-    unsigned int base_speed;
-    
-    if (abs_error > SHARP_ERROR_THRESHOLD_V4) {        // SHARP TURN
 
-        Kp_active = Kp_SHARP_V4;
-        base_speed = BASE_SPEED_TURN_V4;
+#if STEER_SEARCH
+    if (search_side > 0) {                          // Same wheel sense as the PD for positive error
+        Motor_Set(MOTOR_SPEED(STEER_SEARCH_INNER), MOTOR_SPEED(STEER_SEARCH_OUTER));
     }
-    else {                                              // GENTLE CORRECTION
-        Kp_active = Kp_GENTLE_V4;
-        base_speed = BASE_SPEED_STRAIGHT_V4;
+    else {
+        Motor_Set(MOTOR_SPEED(STEER_SEARCH_OUTER), MOTOR_SPEED(STEER_SEARCH_INNER));
     }
-    
-    int pd_output = (Kp_active * error) + (Kd_V4 * derivative);    // PD calculation
-    
-    if (pd_output > MAX_CORRECTION_V4) {            // Clamp to avoid ridiculous changes
-        pd_output = MAX_CORRECTION_V4;
+#endif
+}
+
+
+// =============================================================================
+// SPEED SCHEDULE
+// Base speed and motor supply follow one curve of the filtered error load:
+// fast on straights, slow (and lower voltage) in curves. Speed changes are
+// rate limited - braking is allowed faster than accelerating.
+// =============================================================================
+static unsigned int Line_Follow_Speed_Schedule(int abs_error) {
+    int rate = steer_pid.d_filtered;                // Measurement change per update (filtered)
+    unsigned long load;
+    unsigned int target;
+    unsigned int dac;
+
+    steer_load += ((int)abs_error - (int)steer_load) >> STEER_ERROR_FILTER_SHIFT;
+
+    if (rate < 0) rate = -rate;
+    load = steer_load + (((unsigned long)rate * CONTROL_RATE_SCALE) / STEER_RATE_DIV);
+    if (load > MAX_ERROR) load = MAX_ERROR;
+
+    target = MAX_AUTO_SPEED - (unsigned int)(((unsigned long)(MAX_AUTO_SPEED - MIN_AUTO_SPEED) * load) / MAX_ERROR);
+
+    if (target > steer_speed) {                     // Acceleration limit
+        steer_speed = ((target - steer_speed) > SPEED_ACCEL_STEP) ? (steer_speed + SPEED_ACCEL_STEP) : target;
     }
-    else if (pd_output < -MAX_CORRECTION_V4) {
-        pd_output = -MAX_CORRECTION_V4;
+    else {                                          // Deceleration limit
+        steer_speed = ((steer_speed - target) > SPEED_DECEL_STEP) ? (steer_speed - SPEED_DECEL_STEP) : target;
     }
-    
-    // Calculate target speeds
-    int left_speed, right_speed;
-    
+
+    // Supply tracks the same point on the curve (lower DAC code = higher voltage)
+    dac = STEER_DAC_CURVE - (unsigned int)(((unsigned long)(STEER_DAC_CURVE - STEER_DAC_STRAIGHT)
+                                            * (steer_speed - MIN_AUTO_SPEED)) / (MAX_AUTO_SPEED - MIN_AUTO_SPEED));
+    if (dac != DAC_Get_Voltage()) {
+        DAC_Set_Voltage(dac);
+    }
+    return steer_speed;
+}
+
+// =============================================================================
+// WHEEL SPLIT
+// How a correction is shared between the wheels for a given error. Kept apart
+// from the PD so the steering table (steer_lut.c) is built from the same rule.
+// =============================================================================
+void Line_Follow_Split(int error, int pd_output, int *left_delta, int *right_delta) {
+    int abs_error = (error > 0) ? error : -error;
+
     if (abs_error < DEADZONE) {        // centered Dont adjust
-        left_speed = base_speed;
-        right_speed = base_speed;
+        *left_delta = 0;
+        *right_delta = 0;
     }
 
     // REMOVE BELOW AND REPLACE WITH HARDER KPs IF CANNOT TUNE
@@ -722,30 +972,92 @@ void Line_Follow_PD_V1 (void){
         if (error > 0) {
             // Drifting LEFT - need sharp RIGHT turn
             // LEFT wheel maintains/increases speed, RIGHT wheel slows/stops
-            left_speed = base_speed - (pd_output / 2);   // Outside wheel faster
-            right_speed = base_speed + pd_output;        // Inside wheel much slower
-            
-            // PIVOT on extra sharp
-            if (right_speed < TIPTOE) {
-                right_speed = WHEEL_OFF;
-            }
+            *left_delta = -(pd_output / 2);     // Outside wheel faster
+            *right_delta = pd_output;           // Inside wheel much slower
         }
         else {
             // Drifting RIGHT - need sharp LEFT turn
             // RIGHT wheel maintains/increases speed, LEFT wheel slows/stops
-            right_speed = base_speed + (pd_output / 2);  // Outside wheel faster
-            left_speed = base_speed - pd_output;         // Inside wheel much slower
-            
-            // For very sharp turns, stop inside wheel completely
-            if (left_speed < TIPTOE) {
-                left_speed = WHEEL_OFF;
-            }
+            *right_delta = pd_output / 2;       // Outside wheel faster
+            *left_delta = -pd_output;           // Inside wheel much slower
         }
     }
     else {                                              // GENTLE CORRECTION
-        left_speed = base_speed - pd_output;
-        right_speed = base_speed + pd_output;
+        *left_delta = -pd_output;
+        *right_delta = pd_output;
+    }
+}
+
+// Scheduled-speed PD (steer_controllers[STEER_CTRL_PD])
+void Line_Follow_PD_V1(int error, int *left_speed, int *right_speed) {
+    int abs_error = (error > 0) ? error : -error;
+    unsigned int base_speed;
+    int left_delta, right_delta;
+
+#if STEER_USE_LUT
+    // Table holds Line_Follow_Split of the PD for every (error, rate) grid point
+    int rate = PID_Rate_Update(&steer_pid, error);
+    base_speed = Line_Follow_Speed_Schedule(abs_error);
+    Steer_LUT_Lookup(error, rate, &left_delta, &right_delta);
+#else
+    // STRONG Kp: Base not enought for sharp turns, Stronger Kp - slower speed
+    if (abs_error > SHARP_ERROR_THRESHOLD_V4) {        // SHARP TURN
+        steer_pid.kp = steer_pd_params.kp_sharp;
+    }
+    else {                                              // GENTLE CORRECTION
+        steer_pid.kp = steer_pd_params.kp_gentle;
+    }
+
+    // PID drives line_position toward 0 (output = Kp*(0 - pos) - Kd*d(pos)/dt).
+    // Negate so pd_output keeps the old sign: positive when the line is LEFT.
+    int pd_output = -PID_Update(&steer_pid, 0, error);
+    base_speed = Line_Follow_Speed_Schedule(abs_error);   // Uses this update's filtered rate
+    Line_Follow_Split(error, pd_output, &left_delta, &right_delta);
+#endif
+
+    // Calculate target speeds
+    *left_speed = (int)base_speed + left_delta;
+    *right_speed = (int)base_speed + right_delta;
+
+    if (abs_error > SHARP_ERROR_THRESHOLD_V4) {         // PIVOT on extra sharp - stop inside wheel
+        if ((error > 0) && (*right_speed < TIPTOE)) {
+            *right_speed = WHEEL_OFF;
+        }
+        else if ((error < 0) && (*left_speed < TIPTOE)) {
+            *left_speed = WHEEL_OFF;
+        }
+    }
+}
+
+
+// =============================================================================
+// STEERING UPDATE
+// Common to every controller: line loss bookkeeping, the active controller's
+// wheel targets, clamps, PWM, curvature.
+// =============================================================================
+void Line_Follow_Steer(void) {
+    unsigned int start = CYCLE_STAMP();
+    unsigned int end;
+
+    // error calc [proportional] (positive = drifting left, negative = drifting right)
+    // Centroid of every normalized sensor (-LINE_POS_LOST..+LINE_POS_LOST), 0 = centred
+    int error = line_position;
+    int left_speed, right_speed;
+
+    if (search_side != 0) {                         // Back on the line after a search arc
+        search_side = 0;
+        line_lost_recovered++;
+        line_lost_updates = search_updates;
+        if (search_updates > line_lost_updates_max) {
+            line_lost_updates_max = search_updates;
+        }
+        PID_Reset(&steer_history);                  // Rate across the gap is meaningless
+        steer_controllers[steer_ctrl_active].reset();
     }
+    PID_Rate_Update(&steer_history, error);
+    Runlog_Sample(error);
+
+    steer_controllers[steer_ctrl_active].update(error, &left_speed, &right_speed);
 
     // Clamp to valid range
     if (left_speed < WHEEL_OFF) left_speed = WHEEL_OFF;                 
@@ -753,14 +1065,18 @@ void Line_Follow_PD_V1 (void){
     if (right_speed < WHEEL_OFF) right_speed = WHEEL_OFF;
     if (right_speed > MAX_AUTO_SPEED) right_speed = MAX_AUTO_SPEED;
     
-    // I dont know... because why not?
-    LEFT_REVERSE_SPEED = WHEEL_OFF;
-    RIGHT_REVERSE_SPEED = WHEEL_OFF;
-    DAC_Set_Voltage(DAC_MOTOR_CRAWL);
-    
     // should only pivot on sharp turn case, else clamp minimum to TIPTOE
-    LEFT_FORWARD_SPEED = (left_speed > 0 && left_speed < TIPTOE) ? TIPTOE : left_speed;
-    RIGHT_FORWARD_SPEED = (right_speed > 0 && right_speed < TIPTOE) ? TIPTOE : right_speed;
+    if (left_speed > 0 && left_speed < TIPTOE) left_speed = TIPTOE;
+    if (right_speed > 0 && right_speed < TIPTOE) right_speed = TIPTOE;
+    Motor_Set(MOTOR_SPEED(left_speed), MOTOR_SPEED(right_speed));
+
+    Curvature_Update(left_speed, right_speed);
+
+    end = CYCLE_STAMP();
+    steer_cycles = CYCLES_SINCE(start, end);
+    if (steer_cycles > steer_cycles_max) {
+        steer_cycles_max = steer_cycles;
+    }
 }
 
 
@@ -37,6 +37,64 @@
 #define DAC_STEP_LARGE      (100)				// ~0.4V per step
 #define DAC_RAMP_STEP       (DAC_STEP_LARGE)
 
+// Ramp Engine
+// DAC_Ramp / DAC_Ramp_To move SAC3DAT one step toward the target every
+// period_ms, from the TB3 period tick (odometry.c ISR) - nothing waits on it.
+// Targets are clamped to DAC_SAFE_MAX..DAC_MIN like DAC_Set_Voltage.
+#define DAC_TICK_US         ((WHEEL_PERIOD + 1) / 8)    // 6250us at SMCLK 8 MHz
+#define DAC_RAMP_MS         (50)                        // Default time per step
+#define DAC_RAMP_TICKS(ms)  ((unsigned int)((((unsigned long)(ms) * 1000) + DAC_TICK_US - 1) / DAC_TICK_US))
+
+// Voltage Calibration
+// Measured (code, mV) points across the safe range, code ascending (so mV
+// descending). Built-in values are the annotations above; the IoT W workflow
+// re-measures them with a meter on the motor supply and stores them in FRAM:
+//     W000n        drive the supply to point n's code (n < DAC_CAL_POINTS)
+//     W1000-W9999  meter reading (mV) for that point
+//     W0090        save the table (must still fall as the code rises)
+//     W0091        back to the built-in table
+//     W0092        supply regulation report (below)
+//     W0093        supply regulation on / off
+#define DAC_CAL_POINTS      (6)
+#define DAC_CAL_VERSION     (1)
+#define DAC_CAL_CRC_SEED    (0xFFFF)
+#define DAC_CAL_MV_MIN      (1000)              // Lowest meter reading accepted
+#define DAC_CAL_CMD_SAVE    (90)
+#define DAC_CAL_CMD_DEFAULT (91)
+
+typedef struct {
+    unsigned int code;
+    unsigned int mv;
+} dac_cal_point_t;
+
+typedef struct {
+    unsigned int version;
+    dac_cal_point_t point[DAC_CAL_POINTS];
+    unsigned int crc;
+} dac_cal_record_t;
+
+#define DAC_CAL_RECORD_WORDS ((sizeof(dac_cal_record_t) / sizeof(unsigned int)) - 1)   // Words covered by CRC
+
+// Supply Regulation
+// The table gives the rail for a code on the bench; under load and as the
+// battery drains the converter falls short of it. DAC_Supply_Update reads the
+// rail back (V_DAC, ADC A10), filters it and trims the code so the rail holds
+// the voltage of the code that was asked for. The trim is an integrator in mV
+// that carries over between speed changes, limited in size and rate, and the
+// code it produces still has to stay inside DAC_SAFE_MAX..DAC_MIN.
+#define DAC_REG_ENABLE      (TRUE)              // Regulation on at boot
+#define DAC_SENSE_FULL_MV   (6600)              // Rail at ADC full scale: V_DAC 1:2 divider, AVCC 3.3V ref
+#define DAC_REG_MS          (50)                // Update period (TB3 tick)
+#define DAC_REG_FILTER      (2)                 // Reading filter: 1/4 new per update
+#define DAC_REG_SETTLE      (4)                 // Updates held off after a new setpoint...
+#define DAC_REG_RESETTLE_MV (100)               // ...that moved more than this (speed schedule moves are smaller)
+#define DAC_REG_DEADBAND_MV (20)                // |error| left alone
+#define DAC_REG_STEP_MV     (25)                // Most the trim moves per update
+#define DAC_REG_TRIM_MV     (600)               // Most the trim may add or take away
+#define DAC_REG_CODE_STEP   (10)                // Most the code moves per update (~25-40 mV)
+#define DAC_REG_CMD_REPORT  (92)
+#define DAC_REG_CMD_TOGGLE  (93)
+
 // OLD VALUES
 #define DAC_BEGIN			(2150)      // Starting voltage: 2.0V
 #define DAC_LIMIT			(950)       // Target voltage limit: 5.87V		(875 - 6.054V)
@@ -48,19 +106,38 @@
 
 // Global Variables
 extern volatile unsigned int DAC_data;
-extern volatile unsigned char dac_voltage_set;
+extern volatile unsigned char dac_voltage_set;      // TRUE once a ramp reaches its target
+
+typedef void (*dac_ramp_done_t)(void);              // Runs in the TB3 ISR when a ramp finishes
 
 
 // Function Prototypes
 void Init_DAC(void);
 void DAC_Set_Voltage(unsigned int target_value);
-unsigned int DAC_Get_Voltage(void);
+unsigned int DAC_Get_Voltage(void);                 // Code asked for, before the regulator's trim
 unsigned char DAC_Ready(void);
 
-//void DAC_Ramp_ISR(void);
+void DAC_Ramp(unsigned int target_value);           // DAC_RAMP_STEP every DAC_RAMP_MS
+void DAC_Ramp_To(unsigned int target_value, unsigned int step, unsigned int period_ms, dac_ramp_done_t done);
+void DAC_Ramp_Stop(void);                           // Hold where it is
+unsigned char DAC_Ramping(void);
+void DAC_Ramp_Update(void);                         // TB3 CCR0 ISR
+
+// Millivolts (calibration table, fixed-point interpolation)
+unsigned char DAC_Cal_Load(void);                   // Boot: FRAM table over the built-in one
+unsigned int DAC_Code_For_mV(unsigned int millivolts);  // Clamped to DAC_SAFE_MAX..DAC_MIN
+unsigned int DAC_mV_For_Code(unsigned int code);    // Any code (end segments extended)
+unsigned char DAC_Set_Voltage_mV(unsigned int millivolts);  // FALSE if it had to clamp
+void DAC_Ramp_mV(unsigned int millivolts);
+void DAC_Cal_Command(unsigned int value);           // IoT W
+
+// Supply regulation
+unsigned int DAC_Supply_mV(void);                   // Rail the code was asked for (held by the regulator)
+void DAC_Supply_Update(void);                       // TB3 CCR0 ISR, after DAC_Ramp_Update
+void DAC_Supply_Enable(unsigned char enable);       // Off: trim dropped, table code restored
+void DAC_Supply_Report(void);                       // Regulation error (W0092)
 
 void DAC_Increase_Speed(unsigned int target_dac);
 void DAC_Decrease_Speed(unsigned int target_dac);
-unsigned int DAC_Battery_Adjust(unsigned int V_BAT_current);
 
 #endif /* DAC_H_ */
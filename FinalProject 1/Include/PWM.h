@@ -8,6 +8,8 @@
 #ifndef PWM_H_
 #define PWM_H_
 
+#include "motor.h"
+
 // Direction change delay timing
 #define DIRECTION_CHANGE_DELAY_MS    (500)   // 500ms delay when changing direction
 #define INTERCEPT_BRAKE_PULSE_MS     (50)    // 50ms reverse pulse for intercept stop
@@ -17,6 +19,28 @@
 #define MOTOR_FORWARD   (1)
 #define MOTOR_REVERSE   (2)
 
+// SLEW (TB3 CCR0, once per PWM period)
+// The PWM_ movement functions set a target speed per wheel (motor.h units)
+// and the output stage steps toward it: rest -> full speed takes PWM_ACCEL_MS,
+// full -> rest PWM_DECEL_MS. Both wheels are scaled to arrive together so
+// the wheel ratio (and heading) holds through the ramp. A wheel starting from
+// rest jumps straight to PWM_BREAKAWAY (about where it starts to turn) so both
+// wheels start moving together; a reversal slows to a stop and waits out the
+// motor.c dead time. Wheels_Safe_Stop, PWM_EBRAKE, PWM_REVERSE_PULSE and the
+// _IMMEDIATE functions bypass it.
+#define PWM_USE_SLEW            (1)         // 0: targets go straight to motor.c
+#define PWM_ACCEL_MS            (250)       // 0 -> MOTOR_SPEED_MAX
+#define PWM_DECEL_MS            (120)
+#define PWM_BREAKAWAY           (MOTOR_SPEED(CRAWL))
+#define PWM_SLEW_STEP(ms)       ((unsigned int)(((unsigned long)MOTOR_SPEED_MAX * MOTOR_PERIOD_US) / ((unsigned long)(ms) * 1000)))
+
+// BRAKE PULSES
+// PWM_EBRAKE and PWM_REVERSE_PULSE reverse wheels that may be driving forward,
+// so motor.c holds them off for its dead time first. The EBRAKE pulse (TB2
+// CCR2, 8us counts) is timed from the call, so it is lengthened by the dead
+// time whenever a wheel has to wait - the reverse itself still lasts
+// INTERCEPT_BRAKE_PULSE_MS.
+#define PWM_DEAD_TB2            ((unsigned int)(((unsigned long)MOTOR_DEAD_PERIODS * MOTOR_PERIOD_US) / 8))
 
 extern volatile unsigned char safety_stop;
 
@@ -27,6 +51,13 @@ void Init_PWM(void);
 void Set_Wheel_Speeds(unsigned int left_fwd, unsigned int left_rev, 
                       unsigned int right_fwd, unsigned int right_rev);
 void Wheels_Safe_Stop(void);
+
+// Output stage
+void PWM_Set_Target(int left, int right);          // Signed wheel speeds, ramped
+void PWM_Set_Immediate(int left, int right);       // No ramp, cancels one in progress
+void PWM_Slew_Update(void);                         // TB3 CCR0 ISR
+unsigned char PWM_Slewing(void);
+unsigned char PWM_Reversing(void);                  // A wheel is waiting out the dead time
 void Wheels_Intercept_Brake(void);
 
 // Higher-level movement functions with direction management
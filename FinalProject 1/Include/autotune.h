@@ -0,0 +1,79 @@
+/*
+ * autotune.h
+ *
+ *  Created on: Dec 13, 2025
+ *      Author: Dallas.Owens
+ *
+ *  Description: Relay-feedback auto-tune for the PD steering gains
+ */
+
+#ifndef AUTOTUNE_H_
+#define AUTOTUNE_H_
+
+#include "control.h"
+#include "steer_params.h"
+
+// EXPERIMENT
+// The relay holds the car in a limit cycle about the line. The first cycles
+// are settling and are thrown away, the rest are averaged. Nothing counts
+// before AUTOTUNE_SETTLE_MS either - coming out of the align the first swings
+// are quick, so the long one that gets the car back onto the line can land
+// past the skipped cycles and inflate both the amplitude and the period.
+#define AUTOTUNE_SKIP_CYCLES    (2)
+#define AUTOTUNE_SETTLE_MS      (3000)
+#define AUTOTUNE_SETTLE         ((unsigned int)(((unsigned long)CONTROL_RATE_HZ * AUTOTUNE_SETTLE_MS) / 1000))
+#define AUTOTUNE_CYCLES         (8)         // Averaged cycles
+#define AUTOTUNE_TIMEOUT_MS     (15000)     // Give up without a steady oscillation
+#define AUTOTUNE_TIMEOUT        ((unsigned int)(((unsigned long)CONTROL_RATE_HZ * AUTOTUNE_TIMEOUT_MS) / 1000))
+
+// TUNING RULES (U000n)
+//   Ku = 4d / (pi x sqrt(a^2 - h^2))     d relay, a oscillation amplitude, h hysteresis
+//   Ziegler-Nichols PD:  Kp = 0.8 Ku,    Td = Tu / 8
+//   Tyreus-Luyben:       Kp = Ku / 2.2,  Td = Tu / 6.3   (less overshoot)
+// Kd = Kp x Td with Td in updates, the unit PID_Update's rate is in.
+// The sharp gain keeps the hand tuned sharp/gentle ratio.
+#define AUTOTUNE_ZN             (0)
+#define AUTOTUNE_TL             (1)
+#define AUTOTUNE_CLEAR          (2)         // Forget the stored gains, back to steer_params.h
+
+// FRAM RECORD
+#define AUTOTUNE_RECORD_VERSION (1)
+#define AUTOTUNE_CRC_SEED       (0xFFFF)
+#define AUTOTUNE_RECORD_WORDS   ((sizeof(autotune_record_t) / sizeof(unsigned int)) - 1)   // Words covered by CRC
+
+
+typedef enum {
+    AUTOTUNE_IDLE,
+    AUTOTUNE_RUNNING,                   // Relay selected, measuring in the ADC ISR
+    AUTOTUNE_MEASURED,                  // Cycles in - main loop derives the gains
+    AUTOTUNE_FAILED                     // Timeout or no usable amplitude
+} autotune_state_t;
+
+typedef struct {
+    unsigned int version;               // AUTOTUNE_RECORD_VERSION, 0 = invalidated
+    unsigned int rate_hz;               // CONTROL_RATE_HZ at tune time - Tu and Kd are per update
+    unsigned int method;                // AUTOTUNE_ZN / AUTOTUNE_TL
+    int ku;                             // Ultimate gain, Q12.4
+    unsigned int tu;                    // Ultimate period, updates
+    int amplitude;                      // Measured error amplitude
+    int kp_gentle;                      // Gains derived from them, Q12.4
+    int kp_sharp;
+    int kd;
+    unsigned int crc;                   // CRC16 of all words above - keep LAST
+} autotune_record_t;
+
+
+extern volatile autotune_state_t autotune_state;
+extern autotune_record_t autotune_result;           // Last tune (or the stored one after boot)
+
+
+void Autotune_Relay_Init(void);                     // steer_controllers[STEER_CTRL_RELAY]
+void Autotune_Relay_Reset(void);
+void Autotune_Relay_Update(int error, int *left_speed, int *right_speed);
+
+unsigned char Autotune_Load(void);                  // Boot - stored gains over the defaults
+unsigned char Autotune_Start(unsigned int method);  // IoT U000n, FALSE if no such method
+void Autotune_Process(void);                        // Main loop - gains once the cycles are in
+
+
+#endif /* AUTOTUNE_H_ */
@@ -8,9 +8,30 @@
 #ifndef CALIBRATION_H_
 #define CALIBRATION_H_
 
+#include "ADC.h"
 
 #define SAMPLES        (10)    // Number of samples to average during calibration
 
+// ONLINE CALIBRATION
+#define ONLINE_SCALE_SHIFT      (4)     // Envelope stored in 1/16 counts so the slow decay never truncates to zero
+#define ONLINE_DECAY_SHIFT      (8)     // Envelope edges relax 1/256 of the span per sample (~9s half-life at 100ms)
+#define ONLINE_MIN_SPAN         (100)   // Minimum black/white contrast (counts) before a sensor's threshold is trusted
+#define ONLINE_MIN_SAMPLES      (20)    // Samples seen before confidence can be reported (2s at 100ms)
+
+// SENSOR NORMALIZATION (raw counts -> 0..NORM_FULL_SCALE, white = 0, black = full scale)
+#define NORM_FULL_SCALE         (1000)
+#define NORM_RECIP_SHIFT        (12)    // Reciprocal is Q12: (NORM_FULL_SCALE << 12) / span
+#define NORM_MIN_SPAN           (63)    // Smallest span whose Q12 reciprocal fits in 16 bits
+#define NORM_SPAN_TOLERANCE     (4)     // Span drift (counts) tolerated before the reciprocal is recomputed
+
+// FRAM CALIBRATION RECORD
+// Loading at boot skips the manual routine: 2 SW presses + 2 x SAMPLES (1s each)
+// + 3 x 2s result screens = ~8s plus car placement, vs. a (1 + 3 x LINE_SENSOR_COUNT)
+// word CRC check (<20us for 6 sensors)
+#define CALIB_RECORD_VERSION    (2)     // Bump when calib_record_t layout changes (2 = per-sensor arrays)
+#define CALIB_CRC_SEED          (0xFFFF)
+#define CALIB_RECORD_WORDS      ((sizeof(calib_record_t) / sizeof(unsigned int)) - 1)   // Words covered by CRC
+
 
 typedef enum {
     CALIB_IDLE,
@@ -24,26 +45,44 @@ typedef enum {
     CALIB_COMPLETE                      // Done
 } calib_state_t;
 
+typedef struct {
+    unsigned int version;               // CALIB_RECORD_VERSION, 0 = invalidated
+    unsigned int black[LINE_SENSOR_COUNT];
+    unsigned int white[LINE_SENSOR_COUNT];
+    unsigned int threshold[LINE_SENSOR_COUNT];
+    unsigned int crc;                   // CRC16 of all words above - keep LAST
+} calib_record_t;
+
 extern calib_state_t calib_state;
 
 extern volatile unsigned int calib_timer;
 extern unsigned char calib_sample_count;
-extern unsigned long calib_left_sum;
-extern unsigned long calib_right_sum;
+extern unsigned long calib_sum[LINE_SENSOR_COUNT];
 
 extern volatile unsigned char process_calibration;
 
-// CALIBRATION Value storage
-extern unsigned int LEFT_BLACK_VALUE;
-extern unsigned int LEFT_WHITE_VALUE ;
-extern unsigned int RIGHT_BLACK_VALUE;
-extern unsigned int RIGHT_WHITE_VALUE;
-extern unsigned int LEFT_THRESHOLD;
-extern unsigned int RIGHT_THRESHOLD;
+// CALIBRATION Value storage (indexed like ADC_Line_Detect, car-left -> car-right)
+extern unsigned int LINE_BLACK_VALUE[LINE_SENSOR_COUNT];
+extern unsigned int LINE_WHITE_VALUE[LINE_SENSOR_COUNT];
+extern unsigned int LINE_THRESHOLD[LINE_SENSOR_COUNT];
+
+// Centre pair - the two sensors the 2-sensor code and displays were written for
+#define LEFT_BLACK_VALUE        (LINE_BLACK_VALUE[LINE_CENTER_LEFT])
+#define LEFT_WHITE_VALUE        (LINE_WHITE_VALUE[LINE_CENTER_LEFT])
+#define LEFT_THRESHOLD          (LINE_THRESHOLD[LINE_CENTER_LEFT])
+#define RIGHT_BLACK_VALUE       (LINE_BLACK_VALUE[LINE_CENTER_RIGHT])
+#define RIGHT_WHITE_VALUE       (LINE_WHITE_VALUE[LINE_CENTER_RIGHT])
+#define RIGHT_THRESHOLD         (LINE_THRESHOLD[LINE_CENTER_RIGHT])
 
 extern volatile unsigned char calibrating;
 extern unsigned char calibration_complete;
 
+extern unsigned int LINE_NORM_RECIP[LINE_SENSOR_COUNT];
+extern unsigned int line_norm[LINE_SENSOR_COUNT];
+
+extern unsigned char online_calibration_enabled;
+extern unsigned char calibration_low_confidence;
+
 //extern unsigned char exit_circle;
 
 
@@ -51,5 +90,17 @@ void IR_Calibrate_Menu(void);
 void IR_Calibrate_Process(void);
 void Display_Calibration(void);
 
+void IR_Calibrate_Online_Reset(void);
+void IR_Calibrate_Online_Update(void);
+
+void IR_Normalize_Update(void);
+unsigned int IR_Normalize(unsigned int sample, unsigned int white, unsigned int black,
+                          unsigned int threshold, unsigned int recip);
+void IR_Normalize_Sample(void);
+
+unsigned char Calibration_Load(void);
+void Calibration_Save(void);
+void Calibration_Invalidate(void);
+
 
 #endif /* CALIBRATION_H_ */
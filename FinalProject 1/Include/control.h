@@ -0,0 +1,53 @@
+/*
+ * control.h
+ *
+ *  Created on: Dec 7, 2025
+ *      Author: Dallas.Owens
+ *
+ *  Description: Fixed-rate steering loop run on ADC scan completion
+ */
+
+#ifndef CONTROL_H_
+#define CONTROL_H_
+
+#include "ADC.h"
+
+// CONTROL RATE
+// The TB1 CCR0 tick starts one ADC scan per period; the steering update runs in
+// the ADC ISR as soon as the last line sensor is converted.
+// CONTROL_DIVIDER > 1 steers on every Nth scan only - 1 on the car. The
+// simulator builds with 50 (10 Hz) to stand in for the old 100ms main loop.
+#ifndef CONTROL_DIVIDER
+#define CONTROL_DIVIDER         (1)
+#endif
+#define CONTROL_RATE_HZ         (ADC_SCAN_RATE_HZ / CONTROL_DIVIDER)       // Scan rate set in ADC.h
+#define CONTROL_TICK_INTERVAL   (500000 / ADC_SCAN_RATE_HZ)                // TB1 ticks (500 kHz) per scan
+#define CONTROL_PERIOD_CYCLES   (8000000 / ADC_SCAN_RATE_HZ)               // MCLK cycles per scan
+#define CONTROL_BUDGET_CYCLES   (CONTROL_PERIOD_CYCLES / 4)                // 25% of the CPU for steering
+
+#if (ADC_SCAN_RATE_HZ < 200) || (ADC_SCAN_RATE_HZ > 1000)
+#error "ADC_SCAN_RATE_HZ must be 200-1000"
+#endif
+#if (CONTROL_RATE_HZ < 10) || ((CONTROL_RATE_HZ % 10) != 0)
+#error "CONTROL_RATE_HZ must be a multiple of 10 Hz (CONTROL_RATE_SCALE)"
+#endif
+
+// Error changes per update are CONTROL_RATE_HZ / 10 times smaller than at the
+// old 100ms rate - scale derivative gains by this to keep the same response
+#define CONTROL_RATE_SCALE      (CONTROL_RATE_HZ / 10)
+
+
+extern volatile unsigned char control_active;          // Scans feed the steering update
+extern volatile unsigned char control_steering;        // Update may write the wheel PWM (set by drive state machine)
+extern volatile unsigned int control_cycles;           // Last update cost (MCLK cycles)
+extern volatile unsigned int control_cycles_max;
+extern volatile unsigned int control_overruns;         // Updates over CONTROL_BUDGET_CYCLES
+extern volatile unsigned int control_missed_ticks;     // Ticks skipped because a scan was still running
+
+
+void Control_Start(void);
+void Control_Stop(void);
+void Control_Update(void);                             // ADC ISR only
+
+
+#endif /* CONTROL_H_ */
@@ -0,0 +1,56 @@
+/*
+ * curvature.h
+ *
+ *  Created on: Dec 10, 2025
+ *      Author: Dallas.Owens
+ *
+ *  Description: Path curvature estimate from the wheel commands and the
+ *               circle detector built on it
+ */
+
+#ifndef CURVATURE_H_
+#define CURVATURE_H_
+
+#include "control.h"
+#include "odometry.h"
+
+// CURVATURE UNITS
+// curvature = (right - left) / (right + left) x CURVE_SCALE over the recent path.
+// 0 = straight, +CURVE_SCALE = pivot on the left wheel. Positive is the way the
+// steering turns for a positive line_position (the circle direction).
+#define CURVE_SCALE             (1000)
+#define CURVE_WINDOW_SHIFT      (7)         // Path window, 128 updates (256ms at 500 Hz)
+#define CURVE_MIN_SUM           (((long)TIPTOE) << CURVE_WINDOW_SHIFT)  // Less commanded travel reads as straight
+
+// CIRCLE DETECTION (checked every 100ms in DRIVE_TRAVEL)
+// Hysteresis: confidence builds above CURVE_ENTER, holds between EXIT and ENTER,
+// drains below CURVE_EXIT. Detected once confidence and arc length are both met,
+// so a faster car commits in less time and one gentle sample no longer restarts it.
+// On a circle of radius R the wheels differ by track / R, so the estimate sits at
+// track / 2R (156 for the course circle); the steering ripples it by about +/-100.
+// Thresholds are fractions of that - ENTER at 2/3 is met on average up to ~1.5x
+// the course radius, EXIT at 1/3 is under the ripple's dips. Sim, TRAVEL -> CIRCLE:
+// R 300-800 mm in 4.2-4.7 s (was 41-182 s up to R 450, never past it).
+#define CURVE_CIRCLE_R_MM       (450)       // Course circle radius
+#define CURVE_CIRCLE            ((int)(((long)ODOM_TRACK_MM * CURVE_SCALE) / (2 * CURVE_CIRCLE_R_MM)))
+#define CURVE_ENTER             ((CURVE_CIRCLE * 2) / 3)    // Curvature that counts toward a circle (103)
+#define CURVE_EXIT              (CURVE_CIRCLE / 3)          // Curvature below which confidence drains (51)
+#define CIRCLE_CONF_MAX         (20)
+#define CIRCLE_CONF_MIN         (10)        // 0.5s above CURVE_ENTER at the least
+#define CIRCLE_CONF_GAIN        (2)         // Per check above CURVE_ENTER
+#define CIRCLE_CONF_DECAY       (1)         // Per check below CURVE_EXIT
+#define CIRCLE_MIN_ARC_MS       (2000)      // Arc to cover, as ms of travel at MIN_AUTO_SPEED
+#define CIRCLE_MIN_ARC          ((unsigned long)MIN_AUTO_SPEED * (CONTROL_RATE_HZ / 10) * (CIRCLE_MIN_ARC_MS / 100))
+
+
+extern int curvature;                               // Last Curvature_Check estimate
+extern unsigned char circle_confidence;
+extern unsigned long circle_arc;                    // Travel while curving, PWM counts x updates
+
+
+void Curvature_Reset(void);
+void Curvature_Update(unsigned int left, unsigned int right);     // Control_Update (ADC ISR) only
+unsigned char Curvature_Check(void);                // TRUE once the car is on the circle
+
+
+#endif /* CURVATURE_H_ */
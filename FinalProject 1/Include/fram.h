@@ -0,0 +1,34 @@
+/*
+ * fram.h
+ *
+ *  Created on: Dec 18, 2025
+ *      Author: Dallas.Owens
+ *
+ *  Description: CRC-checked records in program FRAM (.TI.persistent)
+ */
+
+#ifndef FRAM_H_
+#define FRAM_H_
+
+// SYSCFG0 low byte: PFWP, DFWP and the FRWPOA boundary _FRWP_ENABLE sets at
+// startup. Saved and put back whole - writing only PFWP/DFWP back would move
+// the protected region to address 0.
+#define FRAM_PROTECT_BITS       (0x00FF)
+
+typedef struct {
+    unsigned short interrupt_state;     // GIE on entry
+    unsigned int protect;               // SYSCFG0 & FRAM_PROTECT_BITS on entry
+} fram_lock_t;
+
+
+// A record is words ending in the CRC16 of the words before it (keep it last)
+unsigned int FRAM_CRC(const void *data, unsigned int words, unsigned int seed);
+void FRAM_Record_Write(void *record, const void *image, unsigned int words, unsigned int crc);
+
+// Building a record in place (too big for a RAM copy): interrupts stay off
+// between the two
+void FRAM_Unlock(fram_lock_t *lock);
+void FRAM_Relock(const fram_lock_t *lock);
+
+
+#endif /* FRAM_H_ */
@@ -0,0 +1,33 @@
+/*
+ * line_sensor.h
+ *
+ *  Created on: Dec 6, 2025
+ *      Author: Dallas.Owens
+ *
+ *  Description: Weighted-centroid line position across the IR sensor array
+ */
+
+#ifndef LINE_SENSOR_H_
+#define LINE_SENSOR_H_
+
+#include "ADC.h"
+
+// Line position units: centre = 0, outermost car-left sensor = +LINE_POS_MAX,
+// outermost car-right sensor = -LINE_POS_MAX (same sign as the old left - right error)
+#define LINE_POS_MAX            (1000)
+#define LINE_SENSOR_PITCH       ((2 * LINE_POS_MAX) / (LINE_SENSOR_COUNT - 1))  // Position units between sensors
+#define LINE_POS_LOST           (LINE_POS_MAX + (LINE_SENSOR_PITCH / 2))       // Held while the line is lost
+#define LINE_NOISE_FLOOR        (100)   // Normalized reading treated as white (0..NORM_FULL_SCALE)
+#define LINE_LOST_WEIGHT        (150)   // Total weight above the floor below which the line is lost
+#define LINE_EDGE_WEIGHT        (900)   // End sensor weight at which the line is right under it
+
+
+extern int line_position;
+extern unsigned char line_lost;
+extern volatile unsigned int line_position_cycles;
+
+
+int Line_Position_Update(void);
+
+
+#endif /* LINE_SENSOR_H_ */
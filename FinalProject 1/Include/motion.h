@@ -0,0 +1,47 @@
+/*
+ * motion.h
+ *
+ *  Created on: Dec 15, 2025
+ *      Author: Dallas.Owens
+ *
+ *  Description: Distance and heading move primitives on the odometry
+ *               estimate (IoT M/N/H/J)
+ */
+
+#ifndef MOTION_H_
+#define MOTION_H_
+
+#include "odometry.h"
+
+// PROFILE (wheel speed, mm/s)
+// Accelerate at MOTION_ACCEL to MOTION_MAX_SPEED, brake at the same rate so the
+// car arrives at MOTION_APPROACH_SPEED MOTION_APPROACH_MM out, then creep in.
+// Rotations run the same profile on the wheel arc (track x pi x degrees / 360).
+#define MOTION_MAX_SPEED        (250)       // Right wheel tops out near 270 at DAC_MOTOR_SLOW
+#define MOTION_ACCEL            (500)       // mm/s per second, up and down
+#define MOTION_APPROACH_SPEED   (60)
+#define MOTION_APPROACH_MM      (15)
+#define MOTION_DAC              (DAC_MOTOR_SLOW)
+#define MOTION_MAX_MM           (5000)      // Longest move accepted
+#define MOTION_MAX_DEG          (720)
+
+// HEADING HOLD (straight moves)
+// Wheel speed difference per 16-bit binary angle of drift, Q8:
+// 14 -> ~10 mm/s per degree
+#define MOTION_HEADING_GAIN     (14)
+
+// FIXED POINT
+#define MOTION_SPEED_SHIFT      (4)                                         // Profile speed kept in Q4 mm/s
+#define MOTION_ACCEL_STEP       (((unsigned long)MOTION_ACCEL << MOTION_SPEED_SHIFT) / ODOM_TICKS_PER_SEC)
+#define MOTION_ARC_SCALE        (((unsigned long)ODOM_TRACK_MM * 3142) >> 6)    // Wheel arc um = angle x this >> 10
+#define MOTION_LIMIT_SLACK_MS   (2000)      // Stall limit: twice the time at full speed, plus this
+
+
+void Motion_Update(void);                           // Odometry tick (TB3 CCR0 ISR)
+unsigned char Motion_Start_Straight(int mm);        // + forward, - backward. FALSE if out of range
+unsigned char Motion_Start_Rotate(int deg);         // + left (counter-clockwise), - right
+void Motion_Stop(void);
+unsigned char Motion_Active(void);
+
+
+#endif /* MOTION_H_ */
@@ -0,0 +1,50 @@
+/*
+ * motor.h
+ *
+ *  Created on: Dec 17, 2025
+ *      Author: Dallas.Owens
+ *
+ *  Description: Signed per-wheel motor output - the only writer of the four
+ *               wheel CCRs
+ */
+
+#ifndef MOTOR_H_
+#define MOTOR_H_
+
+#define MOTOR_LEFT              (0)
+#define MOTOR_RIGHT             (1)
+#define MOTOR_WHEELS            (2)
+
+// SPEED
+// -1000..1000 per wheel, + forward. 1000 = PERCENT_100 duty, so one unit is
+// 50 TB3 counts and the speed macros map exactly (SLOW -> 600, FAST -> 900).
+#define MOTOR_SPEED_MAX         (1000)
+#define MOTOR_COUNTS_PER_UNIT   (PERCENT_100 / MOTOR_SPEED_MAX)
+#define MOTOR_SPEED(counts)     ((int)(((counts) + (MOTOR_COUNTS_PER_UNIT / 2)) / MOTOR_COUNTS_PER_UNIT))
+
+// TRIM (per mille of the duty, 1000 = as commanded)
+// For motor mismatch. The PWM_ presets already carry the old hand-matched
+// left/right values, so both start at 1000.
+#define MOTOR_TRIM_LEFT         (1000)
+#define MOTOR_TRIM_RIGHT        (1000)
+#define MOTOR_TRIM_MIN          (500)
+#define MOTOR_TRIM_MAX          (1500)
+
+// DEAD TIME
+// A wheel that was driven one way is held off this long before it may be
+// driven the other way (counted in PWM periods by Motor_Update).
+#define MOTOR_PERIOD_US         ((WHEEL_PERIOD + 1) / 8)                // 6250us at SMCLK 8 MHz
+#define MOTOR_DEAD_MS           (20)
+#define MOTOR_DEAD_PERIODS      ((unsigned char)(((MOTOR_DEAD_MS * 1000UL) + MOTOR_PERIOD_US - 1) / MOTOR_PERIOD_US))
+
+
+void Motor_Set(int left, int right);                // Both wheels, one latch load (next period)
+void Motor_Set_Wheel(unsigned char wheel, int speed);
+void Motor_Stop(void);                              // Both wheels off now (dead time still applies to a reversal)
+int Motor_Get(unsigned char wheel);                 // Last speed asked for
+unsigned char Motor_Settling(unsigned char wheel);  // In dead time
+void Motor_Set_Trim(unsigned char wheel, unsigned int trim);
+void Motor_Update(void);                            // Once per PWM period (TB3 CCR0 ISR)
+
+
+#endif /* MOTOR_H_ */
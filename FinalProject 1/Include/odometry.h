@@ -0,0 +1,66 @@
+/*
+ * odometry.h
+ *
+ *  Created on: Dec 14, 2025
+ *      Author: Dallas.Owens
+ *
+ *  Description: Dead-reckoning pose from the commanded wheel duty, the motor
+ *               supply and elapsed time - no encoders on the car
+ */
+
+#ifndef ODOMETRY_H_
+#define ODOMETRY_H_
+
+// TICK
+// TB3 CCR0 (end of every PWM period) - the duty just applied is the one the
+// wheels saw, whatever set it (steering ISR, PWM_ functions, IoT commands).
+#define ODOM_TICK_US            ((WHEEL_PERIOD + 1) / 8)                // 6250us at SMCLK 8 MHz
+#define ODOM_TICKS_PER_SEC      (1000000UL / ODOM_TICK_US)              // 160
+
+// WHEEL MODEL
+// Effective motor voltage = supply (from the DAC code) x duty. Below the stall
+// voltage the wheel doesn't turn; above it speed is linear:
+//     v (mm/s) = kv x (effective V - stall V)
+// Calibrate on the car: drive straight with F, compare O0000 with a tape
+// measure and scale both kv; a rotation that reads short/long fixes the track.
+// Right is weaker - the right kv makes PWM_FORWARD (SLOW left, FAST right at
+// DAC_MOTOR_SLOW) drive straight.
+#define ODOM_KV_LEFT            (150)       // mm/s per volt above stall
+#define ODOM_KV_RIGHT           (84)
+#define ODOM_STALL_MV           (900)       // Effective voltage that just starts a wheel
+#define ODOM_TRACK_MM           (140)       // Wheel centre to wheel centre
+
+// DERIVED (fixed point)
+// Per-tick gain, Q16 um per mV. Heading is a 32-bit binary angle (2^32 = 360
+// degrees) so it wraps by itself: d(heading) = (dR - dL) x 2^32 / (2 pi track).
+#define ODOM_KV_TICK(kv)        (((unsigned long)(kv) << 16) / ODOM_TICKS_PER_SEC)
+#define ODOM_HEADING_SCALE      (683565276UL / ((unsigned long)ODOM_TRACK_MM * 1000))  // 2^32 / 2pi / track (um)
+
+// UNITS FOR WAITS
+#define ODOM_MM(mm)             ((unsigned long)(mm) * 1000)            // Distance is kept in um
+#define ODOM_DEG(deg)           ((unsigned int)(((unsigned long)(deg) << 16) / 360))   // Heading, 16-bit binary angle
+
+
+typedef struct {
+    long x;                             // um, +x = heading 0 (direction at last reset)
+    long y;                             // um, +y = to the left
+    unsigned long heading;              // 2^32 = 360 degrees, counter-clockwise positive
+    unsigned long distance;             // Path length, um (mean of both wheels, either direction)
+} odom_pose_t;
+
+
+void Odometry_Reset(void);                          // Pose and distance to zero
+void Odometry_Get_Pose(odom_pose_t *pose);          // Consistent copy (the ISR writes 32-bit values)
+unsigned long Odometry_Distance(void);
+unsigned int Odometry_Heading(void);                // 16-bit binary angle
+
+// Distance / heading waits - take a mark when the move starts, poll until TRUE
+unsigned char Odometry_Reached(unsigned long distance_mark, unsigned int mm);
+unsigned char Odometry_Turned(unsigned int heading_mark, unsigned int deg);
+
+unsigned int Odometry_Wheel_Duty(unsigned int speed, unsigned int kv);   // mm/s -> TB3 counts (ISR)
+
+void Odometry_Display(void);                        // IoT O0000
+
+
+#endif /* ODOMETRY_H_ */
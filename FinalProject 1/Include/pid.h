@@ -0,0 +1,56 @@
+/*
+ * pid.h
+ *
+ *  Created on: Dec 8, 2025
+ *      Author: Dallas.Owens
+ *
+ *  Description: Fixed-point PID controller (Q12.4 gains, 32-bit accumulator)
+ */
+
+#ifndef PID_H_
+#define PID_H_
+
+// GAIN FORMAT
+// Gains are signed Q12.4: PID_GAIN(50) = 50.0, PID_GAIN_FRAC(25, 2) = 12.5
+// Range -2048.0 .. +2047.9375 - enough for Kd scaled to a 1 kHz loop (7 x 100)
+#define PID_GAIN_SHIFT          (4)
+#define PID_GAIN(whole)         ((int)((whole) << PID_GAIN_SHIFT))
+#define PID_GAIN_FRAC(num, den) ((int)(((long)(num) << PID_GAIN_SHIFT) / (den)))
+
+#define PID_ACC_MAX             (0x7FFFFFFFL)
+#define PID_ACC_MIN             (-PID_ACC_MAX - 1)
+
+// DERIVATIVE FILTER
+// First order low pass on the measurement rate, state kept as rate << d_filter_shift
+// so it settles on the exact rate either sign: s += raw - (s >> shift), d = s >> shift
+// 0 = unfiltered, 2 = ~4 sample time constant (8ms at 500 Hz)
+#define PID_D_FILTER_DEFAULT    (2)
+
+
+typedef struct {
+    int kp;                             // Q12.4 gains - change any time
+    int ki;
+    int kd;
+    unsigned char d_filter_shift;       // Derivative low-pass strength
+
+    int out_max;                        // Output clamp (+/-)
+    long integral;                      // Q.4, clamped to +/- (out_max << PID_GAIN_SHIFT)
+    int last_measurement;               // Derivative on measurement - no kick on setpoint steps
+    long d_state;                       // Filter state, Q(d_filter_shift)
+    int d_filtered;                     // d_state >> d_filter_shift
+    unsigned char first_update;
+
+    signed char saturated;              // Last output clamped high (1) / low (-1) - integrator held that way
+    unsigned int cycles;                // Last PID_Update cost (MCLK cycles)
+    unsigned int cycles_max;
+} pid_controller_t;
+
+
+void PID_Init(pid_controller_t *pid, int kp, int ki, int kd, int out_max);
+void PID_Set_Gains(pid_controller_t *pid, int kp, int ki, int kd);
+void PID_Reset(pid_controller_t *pid);
+int PID_Rate_Update(pid_controller_t *pid, int measurement);   // Filtered d(measurement) only
+int PID_Update(pid_controller_t *pid, int setpoint, int measurement);
+
+
+#endif /* PID_H_ */
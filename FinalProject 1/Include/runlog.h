@@ -0,0 +1,62 @@
+/*
+ * runlog.h
+ *
+ *  Created on: Dec 16, 2025
+ *      Author: Dallas.Owens
+ *
+ *  Description: Per-run performance record, kept in an FRAM ring of the last
+ *               few runs and read back over UART (IoT Q)
+ */
+
+#ifndef RUNLOG_H_
+#define RUNLOG_H_
+
+// RING
+#define RUNLOG_SIZE             (8)         // Runs kept (FRAM)
+#define RUNLOG_STATES           (16)        // Dwell slots, >= DRIVE_STATE_COUNT (wheels.c)
+#define RUNLOG_ALL              (99)        // Q0099 - every stored run, oldest first
+#define RUNLOG_CRC_SEED         (0xFFFF)
+
+// TRACKING ERROR
+// line_position squared is summed per steering update (CONTROL_RATE_HZ); the
+// shift keeps ~270k updates of up to ~1000^2 - 9 minutes at 500 Hz, pinned
+// at full error - inside 32 bits. Past that the sum saturates.
+#define RUNLOG_SQ_SHIFT         (6)
+
+// HOW THE RUN ENDED
+#define RUNLOG_END_ABORT        (0)         // SW1/SW2
+#define RUNLOG_END_DONE         (1)         // Course complete
+#define RUNLOG_END_TIMEOUT      (2)         // Exit distance never reached
+
+// Times are 100ms drive ticks from the start of the run
+typedef struct {
+    unsigned int seq;                       // Run number, 0 = empty slot
+    unsigned int run_time;                  // Start to stop (lap time)
+    unsigned int dwell[RUNLOG_STATES];      // Time in each drive_state
+    unsigned int circle_enter;              // 0 = circle never reached
+    unsigned int circle_exit;               // 0 = never left it
+    unsigned int line_lost;                 // Search arcs started
+    unsigned int line_recovered;            // ... that found the line again
+    unsigned int error_max;                 // |line_position|, steering updates only
+    unsigned int error_rms;
+    unsigned char controller;               // steer_ctrl_active
+    unsigned char end;                      // RUNLOG_END_
+    unsigned int crc;
+} run_record_t;
+
+#define RUNLOG_RECORD_WORDS     ((sizeof(run_record_t) / sizeof(unsigned int)) - 1)    // Words covered by CRC
+
+
+// Run hooks (wheels.c)
+void Runlog_Start(void);                            // Drive_Run_Reset
+void Runlog_Sample(int error);                      // Line_Follow_Steer (ADC ISR)
+void Runlog_Circle_Enter(unsigned int time);
+void Runlog_Circle_Exit(unsigned int time);
+void Runlog_End(unsigned char end, unsigned int run_time, const unsigned int *dwell, unsigned char states);
+
+// Read back (IoT Q) - Q0000 newest, Q000n n runs back, Q0099 all
+unsigned char Runlog_Report_Start(unsigned int which);
+void Runlog_Report_Process(void);                   // Process_Queue while the Q command is active
+
+
+#endif /* RUNLOG_H_ */
@@ -0,0 +1,76 @@
+/*
+ * steer_ctrl.h
+ *
+ *  Created on: Dec 12, 2025
+ *      Author: Dallas.Owens
+ *
+ *  Description: Line follow steering controllers - one interface, several
+ *               strategies compiled in, picked at run time (IoT command K)
+ */
+
+#ifndef STEER_CTRL_H_
+#define STEER_CTRL_H_
+
+#include "steer_params.h"
+
+// CONTROLLERS (index into steer_controllers[], K000n)
+#define STEER_CTRL_PD           (0)     // Scheduled-speed PD, sharp/gentle gains (wheels.c)
+#define STEER_CTRL_P            (1)     // Fixed-speed proportional, slows the inside wheel (old Line_Follow_Proportional)
+#define STEER_CTRL_PID          (2)     // Fixed-speed symmetric PID with integral
+#define STEER_CTRL_RELAY        (3)     // Bang-bang relay - auto-tune experiment (autotune.c)
+#define STEER_CTRL_COUNT        (4)
+
+
+typedef struct {
+    char name[11];                                          // LCD label, 10 chars
+    void (*init)(void);                                     // Load the parameter block defaults
+    void (*reset)(void);                                    // Clear history - run start, after a line loss
+    void (*update)(int error, int *left_speed, int *right_speed);   // ADC ISR, CONTROL_RATE_HZ
+} steer_controller_t;
+
+// PARAMETER BLOCKS (gains Q12.4, see pid.h)
+typedef struct {
+    int kp_gentle;
+    int kp_sharp;
+    int ki;
+    int kd;
+    int max_correction;
+} steer_pd_params_t;
+
+typedef struct {
+    unsigned int base;                  // Both wheels when centred
+    int kp;                             // Inside wheel slow-down per error unit
+    unsigned int max_adjust;
+    unsigned int dac;                   // Motor supply
+} steer_p_params_t;
+
+typedef struct {
+    unsigned int base;
+    int kp;
+    int ki;
+    int kd;
+    int max_correction;
+    unsigned int dac;
+} steer_pid_params_t;
+
+typedef struct {
+    unsigned int base;
+    int amplitude;                      // +/- wheel offset
+    int hysteresis;                     // Error band before the relay switches
+    unsigned int dac;
+} steer_relay_params_t;
+
+
+extern const steer_controller_t steer_controllers[STEER_CTRL_COUNT];
+extern volatile unsigned char steer_ctrl_active;
+extern steer_pd_params_t steer_pd_params;
+extern steer_p_params_t steer_p_params;
+extern steer_pid_params_t steer_pid_params;
+extern steer_relay_params_t steer_relay_params;
+
+
+void Steer_Ctrl_Init(void);                         // Boot - every controller's defaults
+unsigned char Steer_Ctrl_Select(unsigned int index);    // FALSE if no such controller
+
+
+#endif /* STEER_CTRL_H_ */
@@ -0,0 +1,62 @@
+/*
+ * steer_lut.h
+ *
+ *  Created on: Dec 11, 2025
+ *      Author: Dallas.Owens
+ *
+ *  Description: Steering table - PD wheel offsets precomputed over an
+ *               (error, rate) grid, stored in FRAM
+ */
+
+#ifndef STEER_LUT_H_
+#define STEER_LUT_H_
+
+#include "steer_params.h"
+
+// GRID
+// Error points every 64 position units over +/-1280 (covers LINE_POS_MAX + half
+// a pitch on the 6 sensor board). Rate points every 8 units over +/-64 per update.
+// Steps are powers of two so index and fraction are a shift and a mask.
+#define STEER_LUT_ERR_SHIFT     (6)
+#define STEER_LUT_ERR_STEPS     (40)
+#define STEER_LUT_ERR_MIN       (-((STEER_LUT_ERR_STEPS / 2) << STEER_LUT_ERR_SHIFT))
+#define STEER_LUT_RATE_SHIFT    (3)
+#define STEER_LUT_RATE_STEPS    (16)
+#define STEER_LUT_RATE_MIN      (-((STEER_LUT_RATE_STEPS / 2) << STEER_LUT_RATE_SHIFT))
+
+#define STEER_LUT_VERSION       (1)     // Bump when the grid or entry layout changes
+#define STEER_LUT_CRC_SEED      (0xFFFF)
+#define STEER_LUT_WORDS         ((sizeof(steer_lut_t) / sizeof(unsigned int)) - 1)  // Words covered by CRC
+
+#if STEER_USE_LUT && (STEER_KI != 0)
+#error "STEER_USE_LUT needs STEER_KI = 0"
+#endif
+
+
+typedef struct {
+    int left;                           // Offset from base speed (PWM counts)
+    int right;
+} steer_lut_entry_t;
+
+typedef struct {
+    unsigned int version;               // STEER_LUT_VERSION
+    int kp_gentle;                      // Parameters the table was built from -
+    int kp_sharp;                       //   a mismatch at boot rebuilds it
+    int kd;
+    int max_correction;
+    int deadzone;
+    int sharp_threshold;
+    steer_lut_entry_t entry[STEER_LUT_ERR_STEPS + 1][STEER_LUT_RATE_STEPS + 1];
+    unsigned int crc;                   // Must stay last
+} steer_lut_t;
+
+
+extern volatile unsigned int steer_lut_build_cycles;   // Boot build time / 1000 (MCLK), 0 = table was valid
+
+
+void Steer_LUT_Init(void);                              // Boot - rebuild if stale
+void Steer_LUT_Build(void);
+void Steer_LUT_Lookup(int error, int rate, int *left_delta, int *right_delta);
+
+
+#endif /* STEER_LUT_H_ */
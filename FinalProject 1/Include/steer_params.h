@@ -0,0 +1,147 @@
+/*
+ * steer_params.h
+ *
+ *  Created on: Dec 9, 2025
+ *      Author: Dallas.Owens
+ *
+ *  Description: Line following steering parameters - the only place the PD
+ *               tuning lives. Values were hand tuned on the car. Each one can
+ *               be overridden from the build (-DSTEER_KP_GENTLE=60) or by
+ *               replacing this file, so tuning runs don't touch wheels.c.
+ *
+ *  Units:  error / thresholds - line_position (centre 0, outer sensor +/-1000)
+ *          gains              - PWM counts per error unit (whole numbers)
+ *          speeds             - TB3 CCR counts (WHEEL_PERIOD = 50005)
+ */
+
+#ifndef STEER_PARAMS_H_
+#define STEER_PARAMS_H_
+
+// GAINS
+#ifndef STEER_KP_GENTLE
+#define STEER_KP_GENTLE             (50)        // Proportional gain for small corrections   (raw 150)
+#endif
+#ifndef STEER_KP_SHARP
+#define STEER_KP_SHARP              (100)       // Proportional gain for sharp turns         (raw 300)
+#endif
+#ifndef STEER_KI
+#define STEER_KI                    (0)         // Integral gain per update - off, PD as tuned
+#endif
+#ifndef STEER_KD
+#define STEER_KD                    (7)         // Derivative gain per 100ms of change       (raw 20)
+#endif
+
+// ERROR BANDS
+#ifndef STEER_DEADZONE
+#define STEER_DEADZONE              (150)       // Raw 50   // No correction inside this band
+#endif
+#ifndef STEER_SHARP_THRESHOLD
+#define STEER_SHARP_THRESHOLD       (450)       // Raw 150  // Switch to sharp gain / turn speed
+#endif
+
+// SPEED SCHEDULE
+// Base speed slides from STEER_MAX_SPEED (load 0) to STEER_MIN_SPEED (load >= MAX_ERROR)
+// where load = filtered |error| + filtered |error rate| / STEER_RATE_DIV.
+// DAC supply follows the same curve from STEER_DAC_STRAIGHT to STEER_DAC_CURVE.
+#ifndef STEER_MAX_SPEED
+#define STEER_MAX_SPEED             (LINE_SPEED)        // Base speed on a straight
+#endif
+// The curve end must stay above stall: 30% duty at 4.08V is ~1.22V on the
+// wheels against ODOM_STALL_MV (0.9V). TIPTOE at 3.44V was ~0.52V - the car
+// stalled into every curve (sim: circle lap 155.5s -> 72.4s, oval 226.6s -> 112.9s).
+#ifndef STEER_MIN_SPEED
+#define STEER_MIN_SPEED             (15000)             // Base speed in the tightest curve
+#endif
+#ifndef STEER_DAC_STRAIGHT
+#define STEER_DAC_STRAIGHT          (DAC_MOTOR_SLOW)    // 4.08V on a straight
+#endif
+#ifndef STEER_DAC_CURVE
+#define STEER_DAC_CURVE             (DAC_MOTOR_SLOW)    // 4.08V in the tightest curve - lower stalls the inside wheel first
+#endif
+#ifndef STEER_ERROR_FILTER_SHIFT
+#define STEER_ERROR_FILTER_SHIFT    (4)                 // |error| low pass, 16 updates (32ms at 500 Hz)
+#endif
+#ifndef STEER_RATE_DIV
+#define STEER_RATE_DIV              (2)                 // Error change per 100ms counts half as much as error
+#endif
+#ifndef STEER_ACCEL
+#define STEER_ACCEL                 (25000)             // Max base speed increase, PWM counts per second
+#endif
+#ifndef STEER_DECEL
+#define STEER_DECEL                 (100000)            // Max base speed decrease - brake into curves quickly
+#endif
+#ifndef STEER_MAX_CORRECTION
+#define STEER_MAX_CORRECTION        (25000)             // Maximum PWM correction
+#endif
+
+// OTHER CONTROLLERS (steer_ctrl.c, selected with K000n)
+// Fixed base speed, no schedule. Supply held at STEER_DAC_STRAIGHT, where CRAWL
+// is under stall - no base below STEER_MIN_SPEED (make -C tools/sim controllers).
+#ifndef STEER_P_BASE
+#define STEER_P_BASE                (STEER_MIN_SPEED)   // Proportional: both wheels when centred - faster weaves 5+ mm
+#endif
+#ifndef STEER_P_KP
+#define STEER_P_KP                  (7)                 // Inside wheel slow-down per error unit (raw 20)
+#endif
+#ifndef STEER_P_MAX_ADJUST
+#define STEER_P_MAX_ADJUST          (15000)
+#endif
+#ifndef STEER_PID_BASE
+#define STEER_PID_BASE              (17500)             // PID: both wheels when centred
+#endif
+#ifndef STEER_PID_KP
+#define STEER_PID_KP                (20)
+#endif
+#ifndef STEER_PID_KI_Q4
+#define STEER_PID_KI_Q4             (1)                 // Q12.4 - 1/16 count per error unit per update
+#endif
+#ifndef STEER_PID_KD
+#define STEER_PID_KD                (5)                 // Per 100ms of change, like STEER_KD
+#endif
+#ifndef STEER_PID_MAX_CORRECTION
+#define STEER_PID_MAX_CORRECTION    (15000)
+#endif
+#ifndef STEER_RELAY_BASE
+#define STEER_RELAY_BASE            (STEER_MIN_SPEED)   // Relay (auto-tune): both wheels before the offset
+#endif
+#ifndef STEER_RELAY_AMPLITUDE
+#define STEER_RELAY_AMPLITUDE       (6000)              // +/- wheel offset - keep the swing inside the sensor bar
+#endif
+#ifndef STEER_RELAY_HYSTERESIS
+#define STEER_RELAY_HYSTERESIS      (60)                // Error band the relay ignores - above sensor noise
+#endif
+
+// STEERING TABLE
+// 1 = steer from a table of the PD output built at boot (steer_lut.c) instead of
+// running the PD every update. Needs STEER_KI = 0 - the table has no integrator.
+#ifndef STEER_USE_LUT
+#define STEER_USE_LUT               (0)
+#endif
+
+// LINE LOSS RECOVERY
+// On loss the steering update arcs toward the side the line was heading
+// (last error + STEER_LOST_LOOKAHEAD updates of its filtered rate) and takes
+// back over the moment any sensor sees it. After STEER_SEARCH_MS the drive
+// state machine falls back to reversing.
+// STEER_SEARCH 0 leaves the wheels on their last command instead - what the car
+// did before the search (with STEER_SEARCH_MS 500), kept for the simulator.
+#ifndef STEER_SEARCH
+#define STEER_SEARCH                (1)
+#endif
+// The search spins rather than pivots: CRAWL on one wheel is under stall at
+// 4.08V, and a pivot turns the bar too slowly to find the line inside the bound.
+#ifndef STEER_SEARCH_OUTER
+#define STEER_SEARCH_OUTER          (LINE_SPEED)        // Outside wheel during the search arc
+#endif
+#ifndef STEER_SEARCH_INNER
+#define STEER_SEARCH_INNER          (-15000)            // Inside wheel, reversed - turns about a point just inside it
+#endif
+#ifndef STEER_SEARCH_MS
+#define STEER_SEARCH_MS             (600)               // Arc bound before reversing
+#endif
+#ifndef STEER_LOST_LOOKAHEAD
+#define STEER_LOST_LOOKAHEAD        (25)                // Updates of error trend to project (50ms at 500 Hz)
+#endif
+
+
+#endif /* STEER_PARAMS_H_ */
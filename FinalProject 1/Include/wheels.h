@@ -10,20 +10,53 @@
 #ifndef WHEELS_H_
 #define WHEELS_H_
 
+#include "steer_params.h"
+
 //==============================================================================
 // EXTERNAL VARIABLES
 //==============================================================================
 extern volatile unsigned char process_line_follow;
 extern volatile unsigned int drive_timer;
+extern volatile unsigned int line_lost_events;          // Excursions while tracking
+extern volatile unsigned int line_lost_recovered;       // ... found again by the search arc
+extern volatile unsigned int line_lost_updates;         // Length of the last recovered excursion (updates)
+extern volatile unsigned int line_lost_updates_max;
+extern volatile unsigned int steer_cycles;              // Last steering update cost (MCLK cycles)
+extern volatile unsigned int steer_cycles_max;
 
-#define DEADZONE                    (50)        // Previously 100   // Sensor deadzone threshold
+// Error thresholds are in normalized sensor units (0..NORM_FULL_SCALE per sensor, error = left - right)
+// Raw-count equivalents assume a ~330 count black/white span (x3)
+// Steering tuning lives in steer_params.h
+#define DEADZONE                    (STEER_DEADZONE)
 #define Kp                          (20)        // 10 worked pretty well
-#define SHARP_TURN_THRESHOLD        (150) 
+#define SHARP_TURN_THRESHOLD        (STEER_SHARP_THRESHOLD)
+// Circle detection thresholds live in curvature.h
+
+
+#define MAX_AUTO_SPEED              (STEER_MAX_SPEED)   // Max speed during autonomous line following
+#define MIN_AUTO_SPEED              (STEER_MIN_SPEED)   // Min speed during autonomous line following
+#define MAX_ERROR                    (900)          // Raw 300 (600 previously) // Max sensor error for speed scaling
+
+// PD GAINS (Q12.4, see pid.h) - per normalized error unit, per update at CONTROL_RATE_HZ
+#define Kp_GENTLE_V4                PID_GAIN(STEER_KP_GENTLE)
+#define Kp_SHARP_V4                 PID_GAIN(STEER_KP_SHARP)
+#define Ki_V4                       PID_GAIN(STEER_KI)
+#define Kd_V4                       PID_GAIN(STEER_KD * CONTROL_RATE_SCALE)
+#define MAX_CORRECTION_V4           (STEER_MAX_CORRECTION)
+#define SHARP_ERROR_THRESHOLD_V4    (SHARP_TURN_THRESHOLD)              // When to use aggressive response
 
+// DISTANCE MOVES (odometry.h) - the time limits only catch a stalled car
+// With the default wheel model these match the old fixed delays at DAC_MOTOR_SLOW.
+#define DRIVE_EXIT_MM               (700)       // Drive away from the circle, 2+ feet (was 3s)
+#define DRIVE_EXIT_LIMIT_MS         (6000)
+#define SETUP_FORWARD_MM            (700)       // Pad setup straight (was 3s)
+#define SETUP_FORWARD_LIMIT_MS      (6000)
+#define SETUP_TURN_DEG              (20)        // Pad setup rotation (was 300ms)
+#define SETUP_TURN_LIMIT_MS         (600)
 
-#define MAX_AUTO_SPEED              (LINE_SPEED)   // Max speed during autonomous line following
-#define MIN_AUTO_SPEED              (CRAWL)       // Min speed during autonomous line following
-#define MAX_ERROR                    (300)          // 600 previously // Max sensor error for speed scaling
+// DRIVE STATE LOG
+#define DRIVE_LOG_SIZE              (16)        // Transitions kept per run (RAM ring)
+#define DRIVE_LOG_BASE              (100)       // G0100 = newest log entry, G0101 the one before...
 
 //==============================================================================
 // FUNCTION PROTOTYPES
@@ -34,6 +67,14 @@ void Line_Follow_Start_Autonomous(void);    // Entry point - start autonomous mo
 void Line_Follow_Process(void);             // Main state machine (call from main loop)
 void Line_Follow_Exit_Circle(void);         // IoT command to exit circle (command X)
 void Line_Follow_Stop(void);                // Emergency stop
+void Line_Follow_Steer(void);               // Steering update (Control_Update, ADC ISR)
+void Line_Follow_Steer_Reset(void);         // Clear steering history before a run
+void Line_Follow_PD_Init(void);             // Scheduled PD controller (steer_ctrl.h)
+void Line_Follow_PD_Reset(void);
+void Line_Follow_PD_V1(int error, int *left_speed, int *right_speed);
+void Line_Follow_Split(int error, int pd_output, int *left_delta, int *right_delta);   // Correction -> wheel offsets
+void Line_Follow_Search(void);              // Line lost while tracking (Control_Update, ADC ISR)
+void Display_Drive_Stats(unsigned int index);   // State dwell / drive log on the LCD (command G)
 
 
 #endif /* WHEELS_H_ */
@@ -13,12 +13,16 @@
 #include "functions.h"
 #include "ports.h"
 #include "bootup.h"
-//#include "DAC.h"
+#include "DAC.h"
 #include  <string.h>
 #include "timers.h"
 #include "led.h"
 #include  "UART.h"
 #include "switches.h"
+#include "calibration.h"
+#include "steer_lut.h"
+#include "steer_ctrl.h"
+#include "autotune.h"
 
 // Boot Sequence State Variables
 volatile unsigned char power_sequence = BOOT_INIT;          // Current boot stage
@@ -54,6 +58,14 @@ void Bootup_Sequence(void)
     {
         // ========== BOOT INITIALIZATION ==========
     case BOOT_INIT:
+        Calibration_Load();                     // FRAM calibration -> drive-ready without IR_Calibrate_Menu
+        Steer_Ctrl_Init();                      // Steering controller parameter defaults
+        Autotune_Load();                        // Auto-tuned PD gains from FRAM over the defaults
+        DAC_Cal_Load();                         // Measured supply table from FRAM (DAC_Set_Voltage_mV)
+#if STEER_USE_LUT
+        Steer_LUT_Init();                       // Rebuild the steering table if the gains changed
+#endif
+
         // Start unified boot timer
         TB2CCR0 = TB2R + TB2CCR0_INTERVAL;      // Set first interrupt
         TB2CCTL0 |= CCIE;                       // Enable TB2 CCR0 interrupt
@@ -143,6 +155,7 @@ void Bootup_Sequence(void)
         TB2CCTL0 &= ~CCIE;                      // Disable boot timer
 
         strcpy(display_line[0], "DAS BOOTED");
+        strcpy(display_line[1], calibration_complete ? "Cal Loaded" : "Cal None  ");
         display_changed = TRUE;
 
         boot_complete = TRUE;                   // Fiinish bootup cycle, pass control to main loop
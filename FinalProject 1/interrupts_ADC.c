@@ -12,11 +12,14 @@
 #include "timers.h"
 #include "LED.h"
 #include "ADC.h"
+#include "control.h"
 
 volatile unsigned int ADC_Thumb;
+volatile unsigned int ADC_Supply;
 volatile unsigned int ADC_Left_Detect;
 volatile unsigned int ADC_Right_Detect;
-volatile unsigned char ADC_Channel;
+volatile unsigned int ADC_Line_Detect[LINE_SENSOR_COUNT];     // Car-left -> car-right
+volatile unsigned char ADC_Channel;                           // Scan slot of the conversion in progress
 
 volatile unsigned char display_thumb;
 volatile unsigned char display_left_detect;
@@ -29,13 +32,83 @@ volatile unsigned long last_adc_isr_time = 0;
 
 extern volatile unsigned long tb0_ccr0_hits;
 
+// Line sensor inputs, car-left -> car-right
+static const unsigned int adc_line_input[LINE_SENSOR_COUNT] = { LINE_SENSOR_CHANNELS };
+
+// Slow channels sharing the last slot of each scan
+#if ADC_SLOW_COUNT
+static const unsigned int adc_slow_input[ADC_SLOW_COUNT] = {
+#if ADC_SCAN_THUMB
+    ADC_THUMB_INPUT,
+#endif
+#if ADC_SCAN_SUPPLY
+    ADC_SUPPLY_INPUT,
+#endif
+};
+static const unsigned char adc_slow_divisor[ADC_SLOW_COUNT] = {
+#if ADC_SCAN_THUMB
+    ADC_THUMB_DIVISOR,
+#endif
+#if ADC_SCAN_SUPPLY
+    ADC_SUPPLY_DIVISOR,
+#endif
+};
+static unsigned char adc_slow_countdown[ADC_SLOW_COUNT];
+#endif
+static unsigned char adc_slot_owner = ADC_SLOW_NONE;        // Who gets the shared slot this scan
+static unsigned char adc_extra_sensor = 0;                  // Next line sensor to get a shared slot
+
+// Effective rate measurement - conversions counted over ADC_SCAN_RATE_HZ scans (~1s)
+static unsigned int adc_rate_count[ADC_RATE_CHANNELS];
+static unsigned int adc_rate_scans = 0;
+volatile unsigned int adc_rate_hz[ADC_RATE_CHANNELS];
+
+
+static unsigned char ADC_Shared_Slot_Owner(void) {
+    unsigned char owner = ADC_SLOW_NONE;
+#if ADC_SLOW_COUNT
+    unsigned char i;
+    for (i = 0; i < ADC_SLOW_COUNT; i++) {
+        if (adc_slow_countdown[i]) {
+            adc_slow_countdown[i]--;
+        }
+        if ((adc_slow_countdown[i] == 0) && (owner == ADC_SLOW_NONE)) {
+            owner = i;                                      // First due channel wins, others wait a scan
+            adc_slow_countdown[i] = adc_slow_divisor[i];
+        }
+    }
+#endif
+    return owner;
+}
 
 
+static void ADC_Line_Scan_Done(void) {
+    unsigned char i;
+    ADC_Right_Detect = ADC_Line_Detect[LINE_CENTER_LEFT];   // CAR_Left_Detect
+    ADC_Left_Detect = ADC_Line_Detect[LINE_CENTER_RIGHT];   // CAR_Right_Detect
+    display_left_detect = TRUE;
+    display_right_detect = TRUE;
+    if (control_active) {
+        Control_Update();                                   // Steering runs on every fresh scan
+    }
+
+    if (++adc_rate_scans >= ADC_SCAN_RATE_HZ) {             // ~1s of scans - publish and restart
+        adc_rate_scans = 0;
+        for (i = 0; i < ADC_RATE_CHANNELS; i++) {
+            adc_rate_hz[i] = adc_rate_count[i];
+            adc_rate_count[i] = 0;
+        }
+    }
+}
 
 
 #pragma vector=ADC_VECTOR
 __interrupt void ADC_ISR(void)
 {
+    unsigned char channel;
+    unsigned int result;
+    unsigned char start_next = FALSE;
+
     adc_isr_hits++;       // debug flag
     adc_isr_start_time = TB0R;
     last_adc_isr_time = tb0_ccr0_hits;
@@ -65,44 +138,60 @@ __interrupt void ADC_ISR(void)
         if (!sample_adc) { return; }
         
         ADCCTL0 &= ~ADCENC;
-        switch (ADC_Channel++)                       // Cycle through ADC Channel case each tick
-        {
-        case 0: // V_DETECT_LEFT
-            ADCMCTL0 &= ~ADCINCH_2;
-            ADCMCTL0 = ADCINCH_3;
-            ADC_Left_Detect = ADCMEM0;                      // Move result into Global
-            ADC_Left_Detect = (ADC_Left_Detect >> 2);       // Divide the result by 4
-            display_left_detect = TRUE;
-            ADCCTL0 |= ADCSC;                               // Start next conversion
-            break;
-
-        case 1: // V_DETECT_RIGHT
-            IR_OFF();
-            ADCMCTL0 &= ~ADCINCH_3;
-            ADCMCTL0 = ADCINCH_5;
-            ADC_Right_Detect = ADCMEM0;                     // Move result into Global
-            ADC_Right_Detect = (ADC_Right_Detect >> 2);     // Divide the result by 4
-		    display_right_detect = TRUE;
-            ADCCTL0 |= ADCSC;
-            break;
-
-        case 2: // V_THUMB
-            ADCMCTL0 &= ~ADCINCH_5;
-            ADCMCTL0 = ADCINCH_2;
-            ADC_Thumb = ADCMEM0;                            // V_THUMB
-            ADC_Thumb = (ADC_Thumb >> 2);                   // Divide the result by 4
-            ADC_Channel = 0;
-		    display_thumb = TRUE;
-            //display_changed = TRUE;
-            break;
-
-        default:
-            IR_OFF();
-            sample_adc = 0;
-            ADC_Channel = 0;
-            break;
+        channel = ADC_Channel;
+        result = (ADCMEM0 >> 2);                            // Divide the result by 4
+
+        if (channel < LINE_SENSOR_COUNT) {                  // LINE SENSOR
+            ADC_Line_Detect[channel] = result;
+            adc_rate_count[ADC_RATE_LINE(channel)]++;
+            channel++;
+            if (channel < LINE_SENSOR_COUNT) {
+                ADCMCTL0 = adc_line_input[channel];
+            }
+            else {                                          // Line pass done - hand out the shared slot
+                adc_slot_owner = ADC_Shared_Slot_Owner();
+                if (adc_slot_owner == ADC_SLOW_NONE) {
+                    ADCMCTL0 = adc_line_input[adc_extra_sensor];
+                }
+#if ADC_SLOW_COUNT
+                else {
+                    ADC_Line_Scan_Done();                   // Line data complete - slow channel is not
+                    ADCMCTL0 = adc_slow_input[adc_slot_owner];
+                }
+#endif
+            }
+            start_next = TRUE;
         }
+        else {                                              // SHARED SLOT
+            if (adc_slot_owner == ADC_SLOW_NONE) {          // Extra line sample - average it in
+                ADC_Line_Detect[adc_extra_sensor] = (ADC_Line_Detect[adc_extra_sensor] + result) >> 1;
+                adc_rate_count[ADC_RATE_LINE(adc_extra_sensor)]++;
+                if (++adc_extra_sensor >= LINE_SENSOR_COUNT) {
+                    adc_extra_sensor = 0;
+                }
+                ADC_Line_Scan_Done();
+            }
+#if ADC_SCAN_THUMB
+            else if (adc_slot_owner == ADC_SLOW_THUMB) {    // V_THUMB
+                ADC_Thumb = result;
+                adc_rate_count[ADC_RATE_THUMB]++;
+                display_thumb = TRUE;
+            }
+#endif
+#if ADC_SCAN_SUPPLY
+            else if (adc_slot_owner == ADC_SLOW_SUPPLY) {   // V_DAC - read by DAC_Supply_Update
+                ADC_Supply = result;
+                adc_rate_count[ADC_RATE_SUPPLY]++;
+            }
+#endif
+            channel = 0;                                    // Scan done - next one started by timer
+            ADCMCTL0 = adc_line_input[0];
+        }
+        ADC_Channel = channel;
         ADCCTL0 |= ADCENC;
+        if (start_next) {
+            ADCCTL0 |= ADCSC;                               // Start next conversion
+        }
         break;
         
     default:
@@ -91,6 +91,15 @@
 #define LCD_BACKLITE_DIM		(PERCENT(60))
 #define LCD_BACKLITE_OFF		(0)
 
+// CYCLE MEASUREMENT ________________________
+// TB3 counts SMCLK (= MCLK, 8 MHz) up to WHEEL_PERIOD, so TB3R doubles as a cycle
+// counter for anything shorter than one PWM period (6.25ms). Off-target builds
+// (no TB3) define CYCLE_STAMP() themselves, e.g. as 0.
+#ifndef CYCLE_STAMP
+#define CYCLE_STAMP()           (TB3R)
+#endif
+#define CYCLES_SINCE(start, end) (((end) >= (start)) ? ((end) - (start)) : ((end) + (WHEEL_PERIOD + 1) - (start)))
+
 
 // TEST MACROS ______________________
 #define TOGGLE_PROBE()			do{P3OUT ^= TEST_PROBE; } while(0)        // Toggle test probe to read on PCB test point
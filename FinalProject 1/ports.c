@@ -236,11 +236,9 @@ void Init_Port5(void){
 
     P5SELC |=  SENS2_R;
 
-//    P5SEL0 &= ~V_DAC;           // (0)   V_DAC GPIO operation
-//    P5SEL1 &= ~V_DAC;           // (0)   V_DAC GPIO operation
-//    P5OUT  &= ~V_DAC;           // (0)   Initial Value = Low / Off
-//    P5DIR  &= ~V_DAC;           // (0)   Direction = input
-//    P5SELC |=  V_DAC;
+    P5OUT  &= ~V_DAC;           // (0)   Initial Value = Low / Off
+    P5DIR  &= ~V_DAC;           // (0)   Direction = input
+    P5SELC |=  V_DAC;           // (11)  A10 - supply regulation (DAC.c)
 
 //    P5SEL0 &= ~V3_3;            // (0)   V3_3 GPIO operation
 //    P5SEL1 &= ~V3_3;            // (0)   V3_3 GPIO operation
@@ -89,7 +89,7 @@
 // PORT 5 PINS
 #define SENS2_L         (0x01)      // 0 - SENS2_L
 #define SENS2_R         (0x02)      // 1 - SENS2_R
-//#define V_DAC           (0x04)      // 2 - V_DAC
+#define V_DAC           (0x04)      // 2 - V_DAC (A10, motor rail sense)
 //#define V3_3            (0x08)      // 3 - 3.3 V
 //#define IOT_BOOT_CPU    (0x10)      // 4 - IOT_BOOT_CPU
 
@@ -29,26 +29,34 @@ void Init_Timer_B3(void)
 // TB3.3    -    P6.2 L_REVERSE
 // TB3.4    -    P6.3 R_REVERSE
 // TB3.5    -    P6.4 LCD_BACKLITE
+//
+// Wheel CCRs are double buffered: writes go to TB3CCRn and reach the compare
+// latches together when TB3R rolls over to 0, so a period never runs half old
+// and half new duty. Grouped in pairs - CL1+CL2 (both forward) and CL3+CL4
+// (both reverse) - a group only loads once every CCR in it has been written,
+// which motor.c does on every change (Motor_Output).
 //------------------------------------------------------------------------------
     TB3CTL = TBSSEL__SMCLK;                 // SMCLK
+    TB3CTL |= TBCLGRP_1;                    // Latch groups CL1+2, CL3+4, CL5+6
     TB3CTL |= MC__UP;                       // Up Mode
     TB3CTL |= TBCLR;                        // Clear TAR
 
     PWM_PERIOD = WHEEL_PERIOD;              // PWM Period    [Set this to 50005]
+    TB3CCTL0 = CCIE;                        // Period end - odometry tick (odometry.c)
 
-    TB3CCTL1 = OUTMOD_7;                    // CCR1 reset/set
+    TB3CCTL1 = OUTMOD_7 | CLLD_1;           // CCR1 reset/set, CL1+2 load at TB3R = 0
     LEFT_FORWARD_SPEED = WHEEL_OFF;         // P6.1 Left Forward PWM duty cycle
 
     TB3CCTL2 = OUTMOD_7;                    // CCR2 reset/set
     RIGHT_FORWARD_SPEED = WHEEL_OFF;        // P6.2 Right Forward PWM duty cycle
 
-    TB3CCTL3 = OUTMOD_7;                    // CCR3 reset/set
+    TB3CCTL3 = OUTMOD_7 | CLLD_1;           // CCR3 reset/set, CL3+4 load at TB3R = 0
     LEFT_REVERSE_SPEED = WHEEL_OFF;         // P6.3 Left Reverse PWM duty cycle
 
     TB3CCTL4 = OUTMOD_7;                    // CCR4 reset/set
     RIGHT_REVERSE_SPEED = WHEEL_OFF;        // P6.4 Right Reverse PWM duty cycle
 
-    TB3CCTL5 = OUTMOD_7;                    // CCR5 reset/set
+    TB3CCTL5 = OUTMOD_7;                    // CCR5 reset/set, CL5+6 load at once (backlight)
     LCD_BACKLITE_DIMING = PERCENT_80;       // P6.5 LCD_BACKLITE On Diming percent
 //------------------------------------------------------------------------------
 }
@@ -0,0 +1,36 @@
+/*
+ * host_target.h
+ *
+ *  Created on: Dec 18, 2025
+ *      Author: Dallas.Owens
+ *
+ *  Description: Force-included first in every host build (-include).
+ *               The sources count on MSP430 widths: long is 32 bits, where
+ *               an LP64 host has 64 - saturation and wrap checks on long
+ *               would never fire. The C library headers the sources and
+ *               tools use are pulled in first, then long is narrowed to the
+ *               host's 32-bit int for everything after. int itself stays
+ *               32 bits; code that needs 16-bit wrap casts to it explicitly.
+ *               __interrupt is here rather than in msp430.h because
+ *               functions.h uses it before some sources include the device
+ *               header.
+ */
+
+#ifndef HOST_TARGET_H_
+#define HOST_TARGET_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <math.h>
+
+#define long int
+
+#define __interrupt                             // ISRs are plain functions the tools call
+
+#endif /* HOST_TARGET_H_ */
@@ -0,0 +1,123 @@
+/*
+ * msp430.h (host)
+ *
+ *  Created on: Dec 18, 2025
+ *      Author: Dallas.Owens
+ *
+ *  Description: Stand-in for the TI device header on host builds (tools/).
+ *               Registers are plain variables (msp430_host.c) and the
+ *               intrinsics work on a host status register, so driver code
+ *               compiles unchanged and tests can read back what it wrote.
+ *               No MPY32 - pid.c takes its plain C path.
+ */
+
+#ifndef HOST_MSP430_H_
+#define HOST_MSP430_H_
+
+#define HOST_REGISTERS(R) \
+    R(TB0CTL) R(TB0R) R(TB0IV) R(TB0EX0) R(TB0CCTL0) R(TB0CCTL1) R(TB0CCTL2) R(TB0CCR0) R(TB0CCR1) R(TB0CCR2) \
+    R(TB1CTL) R(TB1R) R(TB1IV) R(TB1EX0) R(TB1CCTL0) R(TB1CCTL1) R(TB1CCTL2) R(TB1CCR0) R(TB1CCR1) R(TB1CCR2) \
+    R(TB2CTL) R(TB2R) R(TB2IV) R(TB2EX0) R(TB2CCTL0) R(TB2CCTL1) R(TB2CCTL2) R(TB2CCR0) R(TB2CCR1) R(TB2CCR2) \
+    R(TB3CTL) R(TB3R) R(TB3IV) R(TB3EX0) R(TB3CCTL0) R(TB3CCTL1) R(TB3CCTL2) R(TB3CCTL3) R(TB3CCTL4) R(TB3CCTL5) \
+    R(TB3CCTL6) R(TB3CCR0) R(TB3CCR1) R(TB3CCR2) R(TB3CCR3) R(TB3CCR4) R(TB3CCR5) R(TB3CCR6) \
+    R(ADCCTL0) R(ADCCTL1) R(ADCCTL2) R(ADCMCTL0) R(ADCMEM0) R(ADCIE) R(ADCIFG) R(ADCIV) \
+    R(SAC3DAC) R(SAC3DAT) R(SAC3OA) R(SAC3PGA) \
+    R(SYSCFG0) R(CRCINIRES) R(CRCDI) R(CRCDIRB) \
+    R(UCA0IE) R(UCA0IFG) R(UCA0TXBUF) R(UCA0RXBUF) R(UCA1IE) R(UCA1IFG) R(UCA1TXBUF) R(UCA1RXBUF) \
+    R(P1OUT) R(P1DIR) R(P1SEL0) R(P1SEL1) R(P1SELC) R(P1IN) R(P1REN) R(P1IES) R(P1IFG) R(P1IE) \
+    R(P2OUT) R(P2DIR) R(P2SEL0) R(P2SEL1) R(P2SELC) R(P2IN) R(P2REN) R(P2IES) R(P2IFG) R(P2IE) \
+    R(P3OUT) R(P3DIR) R(P3SEL0) R(P3SEL1) R(P3SELC) R(P3IN) R(P3REN) R(P3IES) R(P3IFG) R(P3IE) \
+    R(P4OUT) R(P4DIR) R(P4SEL0) R(P4SEL1) R(P4SELC) R(P4IN) R(P4REN) R(P4IES) R(P4IFG) R(P4IE) \
+    R(P5OUT) R(P5DIR) R(P5SEL0) R(P5SEL1) R(P5SELC) R(P5IN) \
+    R(P6OUT) R(P6DIR) R(P6SEL0) R(P6SEL1) R(P6SELC) R(P6IN)
+
+#define HOST_REGISTER_EXTERN(name) extern volatile unsigned int name;
+HOST_REGISTERS(HOST_REGISTER_EXTERN)
+
+// Bits the sources use (values only need to be distinct where they are tested)
+#define GIE                 (0x0008)
+#define CCIFG               (0x0001)
+#define CCIE                (0x0010)
+#define TBIFG               (0x0001)
+#define TBIE                (0x0002)
+#define TBCLR               (0x0004)
+#define MC__STOP            (0x0000)
+#define MC__UP              (0x0010)
+#define MC__CONTINUOUS      (0x0020)
+#define TBSSEL__ACLK        (0x0100)
+#define TBSSEL__SMCLK       (0x0200)
+#define ID__1               (0x0000)
+#define ID__2               (0x0040)
+#define ID__4               (0x0080)
+#define ID__8               (0x00C0)
+#define TBIDEX__8           (0x0007)
+#define TBCLGRP_0           (0x0000)
+#define TBCLGRP_1           (0x2000)
+#define CLLD_0              (0x0000)
+#define CLLD_1              (0x0200)
+#define OUTMOD_7            (0x00E0)
+#define ADCENC              (0x0002)
+#define ADCSC               (0x0001)
+#define FRWPPW              (0xA500)
+#define PFWP                (0x0001)
+#define DFWP                (0x0002)
+#define UCTXIE              (0x0002)
+#define UCRXIE              (0x0001)
+#define UCTXIFG             (0x0002)
+#define UCRXIFG             (0x0001)
+#define ADCINCH_0           (0)
+#define ADCINCH_1           (1)
+#define ADCINCH_2           (2)
+#define ADCINCH_3           (3)
+#define ADCINCH_5           (5)
+#define ADCINCH_8           (8)
+#define ADCINCH_9           (9)
+#define ADCINCH_10          (10)
+#define ADCINCH_11          (11)
+#define ADCSHT_2            (0x0200)
+#define ADCMSC              (0x0080)
+#define ADCON               (0x0010)
+#define ADCSHS_0            (0x0000)
+#define ADCSHP              (0x0200)
+#define ADCISSH             (0x0100)
+#define ADCDIV_0            (0x0000)
+#define ADCSSEL_0           (0x0000)
+#define ADCCONSEQ_0         (0x0000)
+#define ADCBUSY             (0x0001)
+#define ADCPDIV0            (0x0100)
+#define ADCRES_2            (0x0020)
+#define ADCDF               (0x0008)
+#define ADCSR               (0x0004)
+#define ADCSREF_0           (0x0000)
+#define ADCIE0              (0x0001)
+#define ADCIV_NONE          (0x0000)
+#define ADCIV_ADCOVIFG      (0x0002)
+#define ADCIV_ADCTOVIFG     (0x0004)
+#define ADCIV_ADCHIIFG      (0x0006)
+#define ADCIV_ADCLOIFG      (0x0008)
+#define ADCIV_ADCINIFG      (0x000A)
+#define ADCIV_ADCIFG        (0x000C)
+#define DACSREF_0           (0x0000)
+#define DACLSEL_0           (0x0000)
+#define DACEN               (0x0001)
+#define NMUXEN              (0x0080)
+#define PMUXEN              (0x0008)
+#define PSEL_1              (0x0001)
+#define NSEL_1              (0x0010)
+#define OAPM                (0x0200)
+#define MSEL_1              (0x0001)
+#define SACEN               (0x0400)
+#define OAEN                (0x0100)
+
+// Intrinsics
+extern unsigned short host_sr;
+#define __get_SR_register()         (host_sr)
+#define __bis_SR_register(bits)     (host_sr |= (unsigned short)(bits))
+#define __bic_SR_register(bits)     (host_sr &= (unsigned short)~(bits))
+#define __disable_interrupt()       (host_sr &= (unsigned short)~GIE)
+#define __enable_interrupt()        (host_sr |= GIE)
+#define __no_operation()
+#define __delay_cycles(cycles)
+#define __even_in_range(value, range)   (value)
+
+#endif /* HOST_MSP430_H_ */
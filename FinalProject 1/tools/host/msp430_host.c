@@ -0,0 +1,18 @@
+/*
+ * msp430_host.c
+ *
+ *  Created on: Dec 18, 2025
+ *      Author: Dallas.Owens
+ *
+ *  Description: Register variables and status register for host builds.
+ *               The CRC module is not modelled - CRCINIRES keeps the seed,
+ *               so every record "CRC" is the seed. Enough for code that
+ *               compares against a CRC it worked out itself.
+ */
+
+#include "msp430.h"
+
+#define HOST_REGISTER_DEFINE(name) volatile unsigned int name;
+HOST_REGISTERS(HOST_REGISTER_DEFINE)
+
+unsigned short host_sr = GIE;
@@ -0,0 +1,11 @@
+/*
+ * LED.h (simulator)
+ *
+ *  Created on: Dec 18, 2025
+ *      Author: Dallas.Owens
+ *
+ *  Description: The sources include both LED.h and led.h - one file on the
+ *               Windows build, two names on the host
+ */
+
+#include "led.h"
@@ -0,0 +1,287 @@
+/*
+ * sim.c
+ *
+ *  Created on: Dec 18, 2025
+ *      Author: Dallas.Owens
+ *
+ *  Description: Closed-loop host simulator for the line follower.
+ *               Boots the firmware (calibration, steering, autotune and DAC
+ *               records, supply ramp), queues a command and runs the car on
+ *               a track: the SMCLK clock is stepped, the timer ISRs fire
+ *               when their CCRs come round, each ADC conversion is answered
+ *               by the car model and the main loop runs Process_Queue and the
+ *               drive processes - all firmware code unmodified.
+ *
+ *  Usage: sim [-t circle|oval] [-s seconds] [-l laps] [-c command]...
+ *             [-a degrees] [-r seed] [-o trajectory.csv] [-v]
+ *
+ *         -c queues an IoT command once the supply is up; repeat it to queue
+ *         several in order (-c K0002 -c T0000). Default T0000.
+ *
+ *         The car starts at the origin facing +y, turned -a degrees clockwise
+ *         (negative for anticlockwise; default 20) so it meets the circle at
+ *         an angle, as placed on the pad. -s is the time limit (default 240).
+ *
+ *         Laps count from when steering takes over; once they are done X0000
+ *         is queued and the run ends when the car is back to IDLE. The last
+ *         line is for scripts (tools/sim/sweep):
+ *             result: lap_ms=<first lap> rms_um=<tracking> max_um=<worst>
+ *                     lost_ms=<time off the line> done=<1 if back to IDLE>
+ *         lap_ms is 0 when no lap was completed.
+ */
+
+#include "msp430.h"
+#include "macros.h"
+#include "functions.h"
+#include "ADC.h"
+#include "calibration.h"
+#include "control.h"
+#include "line_sensor.h"
+#include "DAC.h"
+#include "odometry.h"
+#include "steer_ctrl.h"
+#include "steer_lut.h"
+#include "autotune.h"
+#include "wheels.h"
+#include "sim.h"
+
+extern int drive_state;                         // drive_state_t - private to wheels.c
+
+void Init_ADC(void);
+void Init_PWM(void);
+__interrupt void ADC_ISR(void);
+__interrupt void TIMER_B1_CCR0_ISR(void);
+__interrupt void TIMER_B3_CCR0_ISR(void);
+void Line_Follow_Setup_Process(void);
+
+static const char *const sim_state_names[] = {
+    "IDLE", "TURN_LEFT", "TURN_RIGHT", "START", "BRAKE_RECOVER", "RAW_ALIGN",
+    "TUNE_ALIGN", "TRAVEL_DELAY", "BRAKE_DELAY", "INTERCEPT", "TURN", "TRAVEL",
+    "BACKUP", "CIRCLE", "EXIT", "STOP"
+};
+#define SIM_STATE_NAMES         (sizeof(sim_state_names) / sizeof(sim_state_names[0]))
+#define SIM_DRIVE_IDLE          (0)
+#define SIM_MAX_COMMANDS        (MAX_COMMANDS)  // What the firmware queue holds
+
+static uint64_t sim_clock = 0;                  // SMCLK ticks since reset
+
+
+//==============================================================================
+// CLOCK
+//==============================================================================
+// A CCR interrupt is due when the counter passed it this step (16-bit wrap)
+static unsigned char Sim_Due(unsigned int ctl, unsigned int ccr, unsigned int from, unsigned int to) {
+    unsigned int ahead = (ccr - from) & 0xFFFF;
+    return (ctl & CCIE) && (ahead != 0) && (ahead <= ((to - from) & 0xFFFF));
+}
+
+// Conversions chain from the ISR (ADCENC | ADCSC for the next input) - each is
+// answered at once, as if the 16 clock sample and conversion took no time
+static void Sim_ADC(void) {
+    while ((ADCCTL0 & ADCENC) && (ADCCTL0 & ADCSC)) {
+        ADCCTL0 &= ~ADCSC;
+        ADCMEM0 = Car_ADC(ADCMCTL0 & 0x0F);
+        ADCIV = ADCIV_ADCIFG;
+        ADC_ISR();
+    }
+}
+
+// Returns TRUE after a scan or a 100ms tick (TB1 CCR1) - new data for the
+// drive processes, which the car's main loop would pick up straight away
+static unsigned char Sim_Step(void) {
+    unsigned int tb1_from = TB1R, tb2_from = TB2R;
+    uint64_t tb3_from = sim_clock / (WHEEL_PERIOD + 1);
+    unsigned char tick = FALSE;
+
+    Car_Step(SIM_STEP_S);
+    sim_clock += SIM_STEP_CLOCKS;
+    sim_time = (double)sim_clock / SIM_SMCLK_HZ;
+    TB1R = (unsigned int)((sim_clock / SIM_TB1_DIVIDER) & 0xFFFF);
+    TB2R = (unsigned int)((sim_clock / SIM_TB2_DIVIDER) & 0xFFFF);
+    TB3R = (unsigned int)(sim_clock % (WHEEL_PERIOD + 1));
+
+    if ((sim_clock / (WHEEL_PERIOD + 1)) != tb3_from) {    // TB3 period end
+        Car_Latch();
+        TIMER_B3_CCR0_ISR();
+    }
+    if (Sim_Due(TB1CCTL0, TB1CCR0, tb1_from, TB1R)) {
+        TIMER_B1_CCR0_ISR();
+        Sim_ADC();
+        tick = TRUE;
+    }
+    if (Sim_Due(TB1CCTL1, TB1CCR1, tb1_from, TB1R)) {
+        Board_TB1_CCR1_ISR();
+        tick = TRUE;
+    }
+    if (Sim_Due(TB1CCTL2, TB1CCR2, tb1_from, TB1R)) {
+        Board_TB1_CCR2_ISR();
+    }
+    if (Sim_Due(TB2CCTL2, TB2CCR2, tb2_from, TB2R)) {
+        Board_TB2_CCR2_ISR();
+    }
+    return tick;
+}
+
+
+//==============================================================================
+// MAIN
+//==============================================================================
+static void Sim_Usage(void) {
+    fprintf(stderr, "usage: sim [-t circle|oval] [-s seconds] [-l laps] [-c command]...\n"
+                    "           [-a degrees] [-r seed] [-o trajectory.csv] [-v]\n");
+}
+
+int main(int argc, char **argv) {
+    const char *track = "circle";
+    const char *commands[SIM_MAX_COMMANDS] = { "T0000" };
+    unsigned int command_count = 0;
+    unsigned int i;
+    const char *csv_name = NULL;
+    double limit_s = 240;
+    unsigned int laps = 1;
+    unsigned int seed = 1;
+    double approach = 20;
+    FILE *csv = NULL;
+    int opt;
+
+    int last_state = SIM_DRIVE_IDLE;
+    unsigned char steering_seen = FALSE;
+    unsigned char done = FALSE;
+    double lap_start = 0, lap_time = 0;
+    double arc_last = 0, progress = 0;
+    double error_sum = 0, error_max = 0;
+    unsigned int error_samples = 0;
+    double lost_time = 0;
+    double bar_x, bar_y, arc, error;
+    uint64_t period = 0;
+
+    while ((opt = getopt(argc, argv, "t:s:l:c:a:r:o:v")) != -1) {
+        switch (opt) {
+        case 't': track = optarg; break;
+        case 's': limit_s = atof(optarg); break;
+        case 'l': laps = (unsigned int)atoi(optarg); break;
+        case 'c':
+            if (command_count == SIM_MAX_COMMANDS) {
+                fprintf(stderr, "sim: at most %d commands\n", SIM_MAX_COMMANDS);
+                return 2;
+            }
+            commands[command_count++] = optarg;
+            break;
+        case 'a': approach = atof(optarg); break;
+        case 'r': seed = (unsigned int)atoi(optarg); break;
+        case 'o': csv_name = optarg; break;
+        case 'v': sim_verbose = TRUE; break;
+        default: Sim_Usage(); return 2;
+        }
+    }
+    if (!Track_Build(track)) {
+        fprintf(stderr, "sim: unknown track '%s'\n", track);
+        return 2;
+    }
+    if (csv_name) {
+        csv = fopen(csv_name, "w");
+        if (!csv) {
+            perror(csv_name);
+            return 2;
+        }
+        fprintf(csv, "t,x,y,heading,v_left,v_right,state,line_position,lateral,dac,rail\n");
+    }
+    Car_Init(seed, (M_PI / 2) - (approach * M_PI / 180));
+
+    // BOOT - Bootup_Sequence order, then the drivers it brings up
+    TB3CTL = TBSSEL__SMCLK | MC__UP;
+    TB3CCR0 = WHEEL_PERIOD;
+    Calibration_Load();
+    Steer_Ctrl_Init();
+    Autotune_Load();
+    DAC_Cal_Load();
+#if STEER_USE_LUT
+    Steer_LUT_Init();
+#endif
+    Car_Calibrate();                            // As if IR_Calibrate_Menu had been run on this floor
+    Init_ADC();
+    Init_PWM();
+    Init_DAC();
+    while (!DAC_Ready() && (sim_time < 10)) {
+        Sim_Step();
+    }
+    if (sim_verbose) {
+        printf("%8.3f  supply ready, %u mV\n", sim_time, DAC_Supply_mV());
+    }
+    for (i = 0; i < ((command_count == 0) ? 1 : command_count); i++) {
+        Queue_AddCommand(commands[i]);
+    }
+
+    // RUN
+    while (sim_time < limit_s) {
+        if (Sim_Step()) {
+            Line_Follow_Process();
+            Line_Follow_Setup_Process();
+        }
+        Process_Queue();
+
+        if (drive_state != last_state) {
+            if (sim_verbose) {
+                printf("%8.3f  %s -> %s\n", sim_time,
+                       (last_state < (int)SIM_STATE_NAMES) ? sim_state_names[last_state] : "?",
+                       (drive_state < (int)SIM_STATE_NAMES) ? sim_state_names[drive_state] : "?");
+            }
+            last_state = drive_state;
+            if ((drive_state == SIM_DRIVE_IDLE) && steering_seen) {
+                done = TRUE;
+                break;
+            }
+        }
+
+        // Ground truth once per PWM period
+        if ((sim_clock / (WHEEL_PERIOD + 1)) == period) {
+            continue;
+        }
+        period = sim_clock / (WHEEL_PERIOD + 1);
+        Car_Sensor_Bar(&bar_x, &bar_y);
+        error = Track_Nearest(bar_x, bar_y, &arc);
+        if (control_steering) {
+            if (!steering_seen) {
+                steering_seen = TRUE;
+                lap_start = sim_time;
+                arc_last = arc;
+            }
+            error_sum += error * error;
+            error_samples++;
+            if (error > error_max) error_max = error;
+            if (line_lost) lost_time += SIM_PERIOD_S;
+        }
+        if (steering_seen && (lap_time == 0)) {
+            double delta = arc - arc_last;              // Unwrap across the start of the centreline
+            if (delta > (Track_Length() / 2)) delta -= Track_Length();
+            if (delta < -(Track_Length() / 2)) delta += Track_Length();
+            progress += delta;
+            arc_last = arc;
+            if (fabs(progress) >= (laps * Track_Length())) {
+                lap_time = sim_time - lap_start;
+                Queue_AddCommand("X0000");              // Runs once the CIRCLE state enables commands
+                if (sim_verbose) {
+                    printf("%8.3f  %u lap(s) in %.2f s\n", sim_time, laps, lap_time);
+                }
+            }
+        }
+
+        if (csv) {
+            const car_state_t *car = Car_State();
+            fprintf(csv, "%.4f,%.1f,%.1f,%.4f,%.1f,%.1f,%d,%d,%.1f,%u,%.0f\n",
+                    sim_time, car->x, car->y, car->heading, car->v_left, car->v_right,
+                    drive_state, line_position, error, SAC3DAT, car->rail_mv);
+        }
+    }
+    if (csv) {
+        fclose(csv);
+    }
+
+    printf("result: lap_ms=%u rms_um=%u max_um=%u lost_ms=%u done=%u\n",
+           (unsigned int)lround(lap_time * 1000),
+           error_samples ? (unsigned int)lround(sqrt(error_sum / error_samples) * 1000) : 0,
+           (unsigned int)lround(error_max * 1000),
+           (unsigned int)lround(lost_time * 1000), done);
+    Track_Free();
+    return 0;
+}
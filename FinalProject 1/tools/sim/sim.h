@@ -0,0 +1,117 @@
+/*
+ * sim.h
+ *
+ *  Created on: Dec 18, 2025
+ *      Author: Dallas.Owens
+ *
+ *  Description: Closed-loop host simulator - track, car and board models.
+ *               The firmware runs unmodified on top of them: sim.c clocks
+ *               the timers and calls the ISRs, sim_car.c turns the TB3 CCRs
+ *               and the DAC code into wheel motion and answers the ADC,
+ *               sim_track.c is the floor the sensors look at.
+ *               Distances are mm, angles radians, time seconds.
+ */
+
+#ifndef SIM_H_
+#define SIM_H_
+
+// CLOCK
+// Everything is stepped on SMCLK (8 MHz) - TB3 counts it directly, TB0/TB1 at
+// /16 (500 kHz) and TB2 at /64 (125 kHz) as set up in timers_b*.c.
+#define SIM_SMCLK_HZ            (8000000UL)
+#define SIM_STEP_CLOCKS         (1000)          // 125us - under every CCR interval in use
+#define SIM_TB1_DIVIDER         (16)
+#define SIM_TB2_DIVIDER         (64)
+#define SIM_STEP_S              ((double)SIM_STEP_CLOCKS / SIM_SMCLK_HZ)
+#define SIM_PERIOD_S            ((double)(WHEEL_PERIOD + 1) / SIM_SMCLK_HZ)    // TB3 / PWM period
+
+// TRACK
+// Black tape on a white floor, rendered at 1 mm per pixel from a closed
+// centreline. The car starts at the origin facing +y, off the line.
+#define TRACK_LINE_MM           (19)            // 3/4" electrical tape
+#define TRACK_MARGIN_MM         (800)           // White floor around the line
+#ifndef TRACK_CIRCLE_R_MM
+#define TRACK_CIRCLE_R_MM       (450)           // "circle": the course circle
+#endif
+#define TRACK_CIRCLE_GAP_MM     (500)           // Start to the near side of the circle
+#define TRACK_OVAL_R_MM         (350)           // "oval": stadium ends
+#define TRACK_OVAL_STRAIGHT_MM  (1200)
+
+// CAR
+// Wheel speed follows the odometry model (odometry.h) with a motor lag:
+//     v = kv x (rail x duty - stall)
+// so by default the car is the one the firmware thinks it has. Override any
+// of these from the build (make -B DEFS=-DCAR_KV_RIGHT=90) for a car that isn't.
+#ifndef CAR_KV_LEFT
+#define CAR_KV_LEFT             (ODOM_KV_LEFT)  // mm/s per volt above stall
+#endif
+#ifndef CAR_KV_RIGHT
+#define CAR_KV_RIGHT            (ODOM_KV_RIGHT)
+#endif
+#ifndef CAR_STALL_MV
+#define CAR_STALL_MV            (ODOM_STALL_MV)
+#endif
+#ifndef CAR_TRACK_MM
+#define CAR_TRACK_MM            (ODOM_TRACK_MM)
+#endif
+#ifndef CAR_WHEEL_TAU_S
+#define CAR_WHEEL_TAU_S         (0.08)          // Motor + drivetrain time constant
+#endif
+#ifndef CAR_RAIL_SAG_MV
+#define CAR_RAIL_SAG_MV         (300)           // Rail drop with both wheels at full duty
+#endif
+#define CAR_RAIL_TAU_S          (0.02)
+
+// IR SENSORS (index = ADC_Line_Detect[], car-left -> car-right)
+#ifndef CAR_SENSOR_AHEAD_MM
+#define CAR_SENSOR_AHEAD_MM     (70)            // Sensor bar ahead of the axle
+#endif
+#ifndef CAR_SENSOR_PITCH_MM
+#define CAR_SENSOR_PITCH_MM     (10)            // Between neighbouring sensors - both see a centred tape
+#endif
+#ifndef CAR_SENSOR_SPOT_MM
+#define CAR_SENSOR_SPOT_MM      (4)             // Radius of floor each sensor sees
+#endif
+#define CAR_ADC_WHITE           (120)           // 10-bit counts (ADC_Line_Detect)
+#define CAR_ADC_BLACK           (800)
+#ifndef CAR_ADC_NOISE
+#define CAR_ADC_NOISE           (6)             // +/- counts, uniform
+#endif
+#define CAR_ADC_THUMB           (512)
+
+
+typedef struct {
+    double x;                           // Axle centre
+    double y;
+    double heading;                     // 0 = +x, counter-clockwise positive
+    double v_left;                      // Wheel speeds, mm/s
+    double v_right;
+    double rail_mv;                     // Motor supply the wheels see
+} car_state_t;
+
+
+// sim_track.c
+unsigned char Track_Build(const char *name);       // FALSE for an unknown track
+void Track_Free(void);
+double Track_Coverage(double x, double y, double radius);  // Black fraction of a disc, 0..1
+double Track_Nearest(double x, double y, double *arc);     // Distance to the centreline, arc position
+double Track_Length(void);
+
+// sim_car.c
+void Car_Init(unsigned int seed, double heading);
+void Car_Latch(void);                              // Period start: TB3 CCRs -> wheel duties
+void Car_Step(double dt);
+unsigned int Car_ADC(unsigned int input);          // ADCMEM0 (12-bit) for an ADCINCH_ input
+void Car_Sensor_Bar(double *x, double *y);         // Centre of the sensor bar
+const car_state_t *Car_State(void);
+void Car_Calibrate(void);                          // Load the sensor black/white levels as calibration
+
+// sim_board.c
+extern unsigned char sim_verbose;
+extern double sim_time;
+void Board_TB1_CCR1_ISR(void);
+void Board_TB1_CCR2_ISR(void);
+void Board_TB2_CCR2_ISR(void);
+
+
+#endif /* SIM_H_ */
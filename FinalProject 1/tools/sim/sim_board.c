@@ -0,0 +1,87 @@
+/*
+ * sim_board.c
+ *
+ *  Created on: Dec 18, 2025
+ *      Author: Dallas.Owens
+ *
+ *  Description: Board side of the simulator - the globals, LED/IR and UART
+ *               helpers the firmware links against, and stand-ins for the
+ *               TB1/TB2 ISRs. interrupts_timers.c in this tree is the LED
+ *               marquee version, so the line-follow ISR bodies live here,
+ *               doing what the car's handlers do.
+ */
+
+#include "msp430.h"
+#include "macros.h"
+#include "functions.h"
+#include "timers.h"
+#include "PWM.h"
+#include "odometry.h"
+#include "sim.h"
+
+// DISPLAY / SWITCHES / ADC (main.c, LCD, switches and ADC globals on the car)
+char display_line[4][11];
+volatile unsigned char display_changed = FALSE;
+unsigned char display_menu = FALSE;
+volatile unsigned int SW1_pressed = FALSE;
+volatile unsigned int SW2_pressed = FALSE;
+volatile unsigned char adc_case = 0;
+volatile unsigned char sample_adc = FALSE;
+volatile unsigned long tb0_ccr0_hits = 0;
+
+unsigned char sim_verbose = FALSE;
+double sim_time = 0;
+
+extern volatile unsigned int drive_timer;
+extern volatile unsigned int setup_timer;
+extern volatile unsigned int calib_timer;
+extern volatile unsigned int command_timer;
+extern volatile unsigned char command_complete;
+extern volatile unsigned char ebraking;
+
+
+//==============================================================================
+// LED / IR / UART
+//==============================================================================
+void RED_ON(void) {}
+void RED_OFF(void) {}
+void GRN_TOGGLE(void) {}
+void IR_ON(void) {}
+void IR_OFF(void) {}
+
+void Send_Response(const char *response) {
+    if (sim_verbose) {
+        printf("%8.3f  uart: %s", sim_time, response);
+    }
+}
+
+
+//==============================================================================
+// TIMER STAND-INS
+//==============================================================================
+// TB1 CCR1 - the 100ms drive/setup/calibration tick
+void Board_TB1_CCR1_ISR(void) {
+    TB1CCR1 += TB1CCR1_INTERVAL;
+    drive_timer++;
+    setup_timer++;
+    calib_timer++;
+}
+
+// TB1 CCR2 - timed IoT commands (F/B/R/L)
+void Board_TB1_CCR2_ISR(void) {
+    TB1CCR2 += TB1CCR2_INTERVAL;
+    if (command_timer > 0) {
+        command_timer--;
+        if (command_timer <= 0) {
+            TB1CCTL2 &= ~CCIE;
+            command_complete = TRUE;
+        }
+    }
+}
+
+// TB2 CCR2 - end of the PWM_EBRAKE pulse
+void Board_TB2_CCR2_ISR(void) {
+    Wheels_Safe_Stop();
+    ebraking = FALSE;
+    TB2CCTL2 &= ~CCIE;
+}
@@ -0,0 +1,148 @@
+/*
+ * sim_car.c
+ *
+ *  Created on: Dec 18, 2025
+ *      Author: Dallas.Owens
+ *
+ *  Description: Kinematic model of the car for the simulator. The wheels run
+ *               on the duties the TB3 latches loaded at the start of each PWM
+ *               period and the rail the DAC sets, through a first-order motor
+ *               lag, on a differential drive. The IR sensors read the track
+ *               raster under them; the supply channel reads the modelled rail.
+ */
+
+#include "msp430.h"
+#include "macros.h"
+#include "ADC.h"
+#include "calibration.h"
+#include "DAC.h"
+#include "odometry.h"
+#include "sim.h"
+
+static car_state_t car;
+static unsigned int car_duty[4];                // Latched TB3 CCR1..CCR4 (L fwd, R fwd, L rev, R rev)
+static unsigned int car_noise_state = 1;
+static const unsigned int car_channels[LINE_SENSOR_COUNT] = { LINE_SENSOR_CHANNELS };
+
+
+void Car_Init(unsigned int seed, double heading) {
+    memset(&car, 0, sizeof(car));
+    memset(car_duty, 0, sizeof(car_duty));
+    car.heading = heading;
+    car_noise_state = seed ? seed : 1;
+}
+
+// TB3 period start - what the compare latches load for the period ahead
+void Car_Latch(void) {
+    car_duty[0] = LEFT_FORWARD_SPEED;
+    car_duty[1] = RIGHT_FORWARD_SPEED;
+    car_duty[2] = LEFT_REVERSE_SPEED;
+    car_duty[3] = RIGHT_REVERSE_SPEED;
+}
+
+const car_state_t *Car_State(void) {
+    return &car;
+}
+
+
+//==============================================================================
+// MOTION
+//==============================================================================
+static double Car_Duty(unsigned int forward, unsigned int reverse) {
+    return ((double)forward - (double)reverse) / WHEEL_PERIOD;
+}
+
+static double Car_Wheel_Speed(double duty, double kv) {
+    double effective = car.rail_mv * fabs(duty);
+    double speed;
+
+    if (effective <= CAR_STALL_MV) {
+        return 0;
+    }
+    speed = kv * (effective - CAR_STALL_MV) / 1000.0;
+    return (duty < 0) ? -speed : speed;
+}
+
+void Car_Step(double dt) {
+    double duty_left = Car_Duty(car_duty[0], car_duty[2]);
+    double duty_right = Car_Duty(car_duty[1], car_duty[3]);
+    double rail = 0;
+    double v, w;
+
+    // Rail: the DAC setpoint on the bench curve, pulled down under load
+    if (SAC3DAC & DACEN) {
+        rail = DAC_mV_For_Code(SAC3DAT)
+             - (CAR_RAIL_SAG_MV * (fabs(duty_left) + fabs(duty_right)) / 2);
+    }
+    car.rail_mv += (rail - car.rail_mv) * (dt / CAR_RAIL_TAU_S);
+
+    car.v_left += (Car_Wheel_Speed(duty_left, CAR_KV_LEFT) - car.v_left) * (dt / CAR_WHEEL_TAU_S);
+    car.v_right += (Car_Wheel_Speed(duty_right, CAR_KV_RIGHT) - car.v_right) * (dt / CAR_WHEEL_TAU_S);
+
+    v = (car.v_left + car.v_right) / 2;
+    w = (car.v_right - car.v_left) / CAR_TRACK_MM;
+    car.x += v * cos(car.heading + (w * dt / 2)) * dt;
+    car.y += v * sin(car.heading + (w * dt / 2)) * dt;
+    car.heading += w * dt;
+}
+
+
+//==============================================================================
+// SENSORS
+//==============================================================================
+// Floor position of line sensor <index> (car-left first)
+static void Car_Sensor(unsigned int index, double *x, double *y) {
+    double lateral = CAR_SENSOR_PITCH_MM * (((LINE_SENSOR_COUNT - 1) / 2.0) - index);
+    *x = car.x + (CAR_SENSOR_AHEAD_MM * cos(car.heading)) - (lateral * sin(car.heading));
+    *y = car.y + (CAR_SENSOR_AHEAD_MM * sin(car.heading)) + (lateral * cos(car.heading));
+}
+
+void Car_Sensor_Bar(double *x, double *y) {
+    *x = car.x + (CAR_SENSOR_AHEAD_MM * cos(car.heading));
+    *y = car.y + (CAR_SENSOR_AHEAD_MM * sin(car.heading));
+}
+
+static int Car_Noise(void) {
+    car_noise_state = (car_noise_state * 1103515245u) + 12345u;
+    return (int)((car_noise_state >> 16) % ((2 * CAR_ADC_NOISE) + 1)) - CAR_ADC_NOISE;
+}
+
+unsigned int Car_ADC(unsigned int input) {
+    unsigned int i;
+    double x, y;
+    int counts;
+
+    for (i = 0; i < LINE_SENSOR_COUNT; i++) {
+        if (car_channels[i] == input) {
+            Car_Sensor(i, &x, &y);
+            counts = CAR_ADC_WHITE
+                   + (int)lround((CAR_ADC_BLACK - CAR_ADC_WHITE) * Track_Coverage(x, y, CAR_SENSOR_SPOT_MM))
+                   + Car_Noise();
+            if (counts < 0) counts = 0;
+            if (counts > 1023) counts = 1023;
+            return (unsigned int)counts << 2;
+        }
+    }
+    if (input == ADC_SUPPLY_INPUT) {
+        counts = (int)lround((car.rail_mv * 1024) / DAC_SENSE_FULL_MV);
+        if (counts > 1023) counts = 1023;
+        return (unsigned int)counts << 2;
+    }
+    if (input == ADC_THUMB_INPUT) {
+        return CAR_ADC_THUMB << 2;
+    }
+    return 0;
+}
+
+// What a manual calibration over this floor would have stored
+void Car_Calibrate(void) {
+    unsigned int i;
+
+    for (i = 0; i < LINE_SENSOR_COUNT; i++) {
+        LINE_BLACK_VALUE[i] = CAR_ADC_BLACK;
+        LINE_WHITE_VALUE[i] = CAR_ADC_WHITE;
+        LINE_THRESHOLD[i] = (CAR_ADC_BLACK + CAR_ADC_WHITE) / 2;
+    }
+    calibration_complete = TRUE;
+    IR_Normalize_Update();
+}
@@ -0,0 +1,45 @@
+/*
+ * sim_target.h
+ *
+ *  Created on: Dec 18, 2025
+ *      Author: Dallas.Owens
+ *
+ *  Description: Force-included after host_target.h in the simulator build.
+ *               What the firmware expects from headers this tree has no
+ *               current copy of (functions.h here is the LED marquee one):
+ *               LED/IR helpers, the DAC control pin, the UART/LCD helpers
+ *               and the cross-file prototypes. sim_board.c supplies the
+ *               driver side.
+ */
+
+#ifndef SIM_TARGET_H_
+#define SIM_TARGET_H_
+
+#include "queue.h"
+
+#define DAC_CTRL_3              (0x20)          // P3.5
+
+void RED_ON(void);
+void RED_OFF(void);
+void GRN_TOGGLE(void);
+void IR_ON(void);
+void IR_OFF(void);
+
+void HEXtoBCD(int hex_value);
+void adc_line(char line, char location);
+void Send_Response(const char *response);
+
+unsigned char Get_Command(void);
+ParsedCommand Parse_Command(void);
+void Display_CurrentCommand(void);
+void Queue_AddCommand(const char *cmd_string);
+void Process_Queue(void);
+
+void Line_Follow_Start_LEFT_TURN(void);
+void Line_Follow_Start_RIGHT_TURN(void);
+void Line_Follow_Setup_LEFT(void);
+void Line_Follow_Setup_RIGHT(void);
+void PWM_Opening_Curve_Left(void);
+void PWM_Opening_Curve_Right(void);
+
+#endif /* SIM_TARGET_H_ */
@@ -0,0 +1,203 @@
+/*
+ * sim_track.c
+ *
+ *  Created on: Dec 18, 2025
+ *      Author: Dallas.Owens
+ *
+ *  Description: Track raster for the simulator. A closed centreline is
+ *               sampled every millimetre, tape is stamped along it into a
+ *               1 mm/pixel bitmap, and the sensors read coverage off the
+ *               bitmap. The centreline is kept for the ground truth -
+ *               tracking error and lap progress.
+ */
+
+#include "macros.h"
+#include "odometry.h"
+#include "sim.h"
+
+typedef struct {
+    double x;
+    double y;
+} track_point_t;
+
+static track_point_t *track_path = NULL;        // Centreline, 1 mm apart, closed
+static unsigned int track_points = 0;
+static unsigned char *track_raster = NULL;      // 1 = tape
+static int track_width = 0;                     // Pixels
+static int track_height = 0;
+static double track_x0 = 0;                     // Floor position of pixel (0, 0)
+static double track_y0 = 0;
+static unsigned int track_hint = 0;             // Last nearest point - searches start here
+
+
+//==============================================================================
+// CENTRELINES
+//==============================================================================
+static void Track_Add(double x, double y) {
+    track_path[track_points].x = x;
+    track_path[track_points].y = y;
+    track_points++;
+}
+
+static void Track_Arc(double cx, double cy, double r, double from, double sweep) {
+    unsigned int steps = (unsigned int)(fabs(sweep) * r);
+    unsigned int i;
+    for (i = 0; i < steps; i++) {
+        double a = from + (sweep * i) / steps;
+        Track_Add(cx + (r * cos(a)), cy + (r * sin(a)));
+    }
+}
+
+static void Track_Straight(double x0, double y0, double x1, double y1) {
+    unsigned int steps = (unsigned int)hypot(x1 - x0, y1 - y0);
+    unsigned int i;
+    for (i = 0; i < steps; i++) {
+        Track_Add(x0 + ((x1 - x0) * i) / steps, y0 + ((y1 - y0) * i) / steps);
+    }
+}
+
+// The course: one circle, the start pad TRACK_CIRCLE_GAP_MM short of it
+static void Track_Circle(void) {
+    double r = TRACK_CIRCLE_R_MM;
+    track_path = malloc(sizeof(track_point_t) * ((unsigned int)(2 * M_PI * r) + 1));
+    Track_Arc(0, TRACK_CIRCLE_GAP_MM + r, r, -M_PI / 2, 2 * M_PI);
+}
+
+// Stadium - straights for the speed schedule, ends tight enough to read as a
+// circle. Long axis along +y, so the car meets the near end square on, as it
+// meets the course circle from the start pad.
+static void Track_Oval(void) {
+    double r = TRACK_OVAL_R_MM;
+    double length = TRACK_OVAL_STRAIGHT_MM;
+    double y = TRACK_CIRCLE_GAP_MM + r;             // Near end centre
+    track_path = malloc(sizeof(track_point_t) * ((unsigned int)((2 * M_PI * r) + (2 * length)) + 5));
+    Track_Arc(0, y, r, -M_PI / 2, M_PI / 2);
+    Track_Straight(r, y, r, y + length);
+    Track_Arc(0, y + length, r, 0, M_PI);
+    Track_Straight(-r, y + length, -r, y);
+    Track_Arc(0, y, r, M_PI, M_PI / 2);
+}
+
+
+//==============================================================================
+// RASTER
+//==============================================================================
+static void Track_Stamp(double x, double y) {
+    int r = TRACK_LINE_MM / 2;
+    int cx = (int)lround(x - track_x0);
+    int cy = (int)lround(y - track_y0);
+    int dx, dy;
+
+    for (dy = -r; dy <= r; dy++) {
+        for (dx = -r; dx <= r; dx++) {
+            if ((dx * dx) + (dy * dy) <= (r * r) + r) {
+                track_raster[((cy + dy) * track_width) + cx + dx] = 1;
+            }
+        }
+    }
+}
+
+unsigned char Track_Build(const char *name) {
+    double x_min = 0, x_max = 0, y_min = 0, y_max = 0;     // Start pose is on the floor too
+    unsigned int i;
+
+    Track_Free();
+    if (strcmp(name, "circle") == 0) {
+        Track_Circle();
+    }
+    else if (strcmp(name, "oval") == 0) {
+        Track_Oval();
+    }
+    else {
+        return FALSE;
+    }
+
+    for (i = 0; i < track_points; i++) {
+        if (track_path[i].x < x_min) x_min = track_path[i].x;
+        if (track_path[i].x > x_max) x_max = track_path[i].x;
+        if (track_path[i].y < y_min) y_min = track_path[i].y;
+        if (track_path[i].y > y_max) y_max = track_path[i].y;
+    }
+    track_x0 = floor(x_min) - TRACK_MARGIN_MM;
+    track_y0 = floor(y_min) - TRACK_MARGIN_MM;
+    track_width = (int)(x_max - track_x0) + TRACK_MARGIN_MM + 1;
+    track_height = (int)(y_max - track_y0) + TRACK_MARGIN_MM + 1;
+    track_raster = calloc((size_t)track_width * track_height, 1);
+
+    for (i = 0; i < track_points; i++) {
+        Track_Stamp(track_path[i].x, track_path[i].y);
+    }
+    track_hint = 0;
+    return TRUE;
+}
+
+void Track_Free(void) {
+    free(track_path);
+    free(track_raster);
+    track_path = NULL;
+    track_raster = NULL;
+    track_points = 0;
+}
+
+
+//==============================================================================
+// QUERIES
+//==============================================================================
+double Track_Coverage(double x, double y, double radius) {
+    int r = (int)radius;
+    int cx = (int)lround(x - track_x0);
+    int cy = (int)lround(y - track_y0);
+    unsigned int seen = 0, black = 0;
+    int dx, dy, px, py;
+
+    for (dy = -r; dy <= r; dy++) {
+        for (dx = -r; dx <= r; dx++) {
+            if ((dx * dx) + (dy * dy) > (r * r) + r) continue;
+            seen++;
+            px = cx + dx;
+            py = cy + dy;
+            if ((px >= 0) && (py >= 0) && (px < track_width) && (py < track_height)) {
+                black += track_raster[(py * track_width) + px];     // Off the raster is floor
+            }
+        }
+    }
+    return (double)black / seen;
+}
+
+// Local search from the last answer - the car moves well under a window per
+// call. A full pass when the local minimum sits on the window edge.
+double Track_Nearest(double x, double y, double *arc) {
+    const int window = 200;
+    unsigned int best = track_hint;
+    double best_d = hypot(track_path[best].x - x, track_path[best].y - y);
+    double d;
+    unsigned int i, k;
+    int offset;
+
+    for (offset = -window; offset <= window; offset++) {
+        k = (unsigned int)(((int)track_hint + offset + (int)track_points) % (int)track_points);
+        d = hypot(track_path[k].x - x, track_path[k].y - y);
+        if (d < best_d) {
+            best_d = d;
+            best = k;
+        }
+    }
+    if ((best == (track_hint + window) % track_points) || (best == (track_hint + track_points - window) % track_points)) {
+        for (i = 0; i < track_points; i++) {
+            d = hypot(track_path[i].x - x, track_path[i].y - y);
+            if (d < best_d) {
+                best_d = d;
+                best = i;
+            }
+        }
+    }
+    track_hint = best;
+    if (arc) {
+        *arc = best;                    // 1 mm per point
+    }
+    return best_d;
+}
+
+double Track_Length(void) {
+    return track_points;
+}
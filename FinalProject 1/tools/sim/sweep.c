@@ -0,0 +1,364 @@
+/*
+ * sweep.c
+ *
+ *  Created on: Dec 18, 2025
+ *      Author: Dallas.Owens
+ *
+ *  Description: Steering parameter sweep on the host simulator. Every
+ *               candidate is a set of steer_params.h overrides: the
+ *               simulator is built with them (make -B DEFS=... OUT=...),
+ *               run, and its result line collected. Candidates run in
+ *               parallel, one worker per core. Runs that finish the course
+ *               inside the tracking error limit are ranked by lap time and
+ *               the best set is written as a header of #defines - force
+ *               include it in the build or copy the values into
+ *               Include/steer_params.h.
+ *
+ *               Plain host program - not built on host_target.h.
+ *
+ *  Usage: sweep [-g | -n count] [-p NAME=min:max:step | NAME=value]...
+ *               [-e max_error_mm] [-t track] [-s seconds] [-j workers]
+ *               [-r seed] [-o steer_tuned.h]
+ *
+ *         -g walks the full grid of the ranges, -n draws that many random
+ *         points from it (default -n 32). -p replaces a range or pins a
+ *         parameter; ranges for parameters not in the table are added.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+
+#define SWEEP_MAX_PARAMS        (16)
+#define SWEEP_MAX_JOBS          (64)
+#define SWEEP_NAME_LEN          (32)
+#define SWEEP_DIR               "sweep.d"
+
+typedef struct {
+    char name[SWEEP_NAME_LEN];
+    int min;
+    int max;
+    int step;
+} sweep_param_t;
+
+typedef struct {
+    int value[SWEEP_MAX_PARAMS];
+    unsigned int lap_ms;
+    unsigned int rms_um;
+    unsigned int max_um;
+    unsigned int lost_ms;
+    unsigned int done;
+    int status;                         // 0 = ran, else build/run failure
+} sweep_run_t;
+
+// What the PD was hand tuned on - steer_params.h, error units of line_position
+static sweep_param_t sweep_params[SWEEP_MAX_PARAMS] = {
+    { "STEER_KP_GENTLE",        30,     70,     10 },
+    { "STEER_KP_SHARP",         60,     140,    20 },
+    { "STEER_KD",               3,      11,     2 },
+    { "STEER_DEADZONE",         50,     250,    50 },
+    { "STEER_SHARP_THRESHOLD",  300,    600,    150 },
+    { "STEER_MAX_SPEED",        20000,  35000,  5000 },
+    { "STEER_MIN_SPEED",        12500,  17500,  2500 },     // Under ~11000 the curve end stalls at 4.08V
+};
+static unsigned int sweep_param_count = 7;
+
+static int sweep_error_um = 12000;              // Max tracking error to qualify
+static const char *sweep_track = "circle";
+static const char *sweep_seconds = "240";
+
+
+//==============================================================================
+// PARAMETERS
+//==============================================================================
+static unsigned int Sweep_Levels(const sweep_param_t *p) {
+    return (unsigned int)((p->max - p->min) / p->step) + 1;
+}
+
+static int Sweep_Param_Option(const char *arg) {
+    sweep_param_t p;
+    const char *eq = strchr(arg, '=');
+    unsigned int i;
+    int n;
+
+    if (!eq || ((size_t)(eq - arg) >= SWEEP_NAME_LEN)) {
+        return 0;
+    }
+    memset(&p, 0, sizeof(p));
+    memcpy(p.name, arg, (size_t)(eq - arg));
+    n = sscanf(eq + 1, "%d:%d:%d", &p.min, &p.max, &p.step);
+    if (n == 1) {
+        p.max = p.min;                          // Pinned
+        p.step = 1;
+    }
+    else if ((n != 3) || (p.step <= 0) || (p.max < p.min)) {
+        return 0;
+    }
+
+    for (i = 0; i < sweep_param_count; i++) {
+        if (strcmp(sweep_params[i].name, p.name) == 0) {
+            sweep_params[i] = p;
+            return 1;
+        }
+    }
+    if (sweep_param_count == SWEEP_MAX_PARAMS) {
+        return 0;
+    }
+    sweep_params[sweep_param_count++] = p;
+    return 1;
+}
+
+// Grid point <index> (mixed radix over the levels), or a random one
+static void Sweep_Point(sweep_run_t *run, unsigned long index, int random_point) {
+    unsigned int i, levels;
+
+    for (i = 0; i < sweep_param_count; i++) {
+        levels = Sweep_Levels(&sweep_params[i]);
+        if (random_point) {
+            run->value[i] = sweep_params[i].min + (sweep_params[i].step * (int)((unsigned int)rand() % levels));
+        }
+        else {
+            run->value[i] = sweep_params[i].min + (sweep_params[i].step * (int)(index % levels));
+            index /= levels;
+        }
+    }
+}
+
+
+//==============================================================================
+// ONE CANDIDATE (worker process)
+//==============================================================================
+static void Sweep_Worker(sweep_run_t *run, unsigned int id, int out) {
+    char defs[SWEEP_MAX_PARAMS * (SWEEP_NAME_LEN + 16)];
+    char command[sizeof(defs) + 256];
+    char line[256];
+    size_t used = 0;
+    unsigned int i;
+    FILE *sim;
+
+    run->status = 1;
+    for (i = 0; i < sweep_param_count; i++) {
+        used += (size_t)snprintf(defs + used, sizeof(defs) - used, "%s-D%s=%d",
+                                 i ? " " : "", sweep_params[i].name, run->value[i]);
+    }
+    snprintf(command, sizeof(command), "make -s -B DEFS='%s' OUT=%s/sim_%u >/dev/null 2>&1",
+             defs, SWEEP_DIR, id);
+    if (system(command) == 0) {
+        snprintf(command, sizeof(command), "./%s/sim_%u -t %s -s %s", SWEEP_DIR, id, sweep_track, sweep_seconds);
+        sim = popen(command, "r");
+        if (sim) {
+            while (fgets(line, sizeof(line), sim)) {
+                if (sscanf(line, "result: lap_ms=%u rms_um=%u max_um=%u lost_ms=%u done=%u",
+                           &run->lap_ms, &run->rms_um, &run->max_um, &run->lost_ms, &run->done) == 5) {
+                    run->status = 0;
+                }
+            }
+            pclose(sim);
+        }
+    }
+    snprintf(command, sizeof(command), "%s/sim_%u", SWEEP_DIR, id);
+    unlink(command);
+
+    if (write(out, run, sizeof(*run)) != (ssize_t)sizeof(*run)) {
+        _exit(1);
+    }
+    _exit(0);
+}
+
+
+//==============================================================================
+// RANKING / OUTPUT
+//==============================================================================
+static int Sweep_Qualifies(const sweep_run_t *run) {
+    return (run->status == 0) && run->done && (run->lap_ms != 0) && ((int)run->max_um <= sweep_error_um);
+}
+
+static int Sweep_Compare(const void *a, const void *b) {
+    const sweep_run_t *ra = a, *rb = b;
+    int qa = Sweep_Qualifies(ra), qb = Sweep_Qualifies(rb);
+
+    if (qa != qb) return qb - qa;               // Qualifying runs first
+    if (qa) {
+        if (ra->lap_ms != rb->lap_ms) return (ra->lap_ms < rb->lap_ms) ? -1 : 1;
+        return (ra->rms_um < rb->rms_um) ? -1 : (ra->rms_um > rb->rms_um);
+    }
+    return (ra->rms_um < rb->rms_um) ? -1 : (ra->rms_um > rb->rms_um);
+}
+
+static void Sweep_Print(const sweep_run_t *run) {
+    unsigned int i;
+
+    if (run->status) {
+        printf("  build/run failed  ");
+    }
+    else {
+        printf("  %7.2f s %6.1f mm %6.1f mm %5u ms %s ", run->lap_ms / 1000.0, run->rms_um / 1000.0,
+               run->max_um / 1000.0, run->lost_ms, Sweep_Qualifies(run) ? " " : "x");
+    }
+    for (i = 0; i < sweep_param_count; i++) {
+        printf(" %s=%d", sweep_params[i].name, run->value[i]);
+    }
+    printf("\n");
+}
+
+static int Sweep_Write(const char *name, const sweep_run_t *run, unsigned int runs) {
+    FILE *out = fopen(name, "w");
+    unsigned int i;
+
+    if (!out) {
+        perror(name);
+        return 0;
+    }
+    fprintf(out, "/*\n * %s\n *\n", name);
+    fprintf(out, " *  Description: Steering parameters from tools/sim/sweep - best of %u runs on\n", runs);
+    fprintf(out, " *               the \"%s\" track: lap %.2f s, tracking error %.1f mm RMS,\n",
+            sweep_track, run->lap_ms / 1000.0, run->rms_um / 1000.0);
+    fprintf(out, " *               %.1f mm max. Overrides Include/steer_params.h when force\n", run->max_um / 1000.0);
+    fprintf(out, " *               included, or copy the values over.\n */\n\n");
+    fprintf(out, "#ifndef STEER_TUNED_H_\n#define STEER_TUNED_H_\n\n");
+    for (i = 0; i < sweep_param_count; i++) {
+        fprintf(out, "#define %-27s (%d)\n", sweep_params[i].name, run->value[i]);
+    }
+    fprintf(out, "\n#endif /* STEER_TUNED_H_ */\n");
+    fclose(out);
+    return 1;
+}
+
+
+//==============================================================================
+// MAIN
+//==============================================================================
+static void Sweep_Usage(void) {
+    fprintf(stderr, "usage: sweep [-g | -n count] [-p NAME=min:max:step | NAME=value]...\n"
+                    "             [-e max_error_mm] [-t track] [-s seconds] [-j workers]\n"
+                    "             [-r seed] [-o steer_tuned.h]\n");
+}
+
+int main(int argc, char **argv) {
+    const char *out_name = "steer_tuned.h";
+    unsigned long count = 32;
+    unsigned long grid = 1;
+    unsigned long next = 0, finished = 0;
+    int use_grid = 0;
+    int jobs = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    int running = 0;
+    pid_t job_pid[SWEEP_MAX_JOBS] = { 0 };
+    int job_pipe[SWEEP_MAX_JOBS];
+    unsigned long job_index[SWEEP_MAX_JOBS];
+    sweep_run_t *runs;
+    unsigned int i;
+    int opt, j, status;
+    pid_t pid;
+
+    srand(1);
+    while ((opt = getopt(argc, argv, "gn:p:e:t:s:j:r:o:")) != -1) {
+        switch (opt) {
+        case 'g': use_grid = 1; break;
+        case 'n': count = strtoul(optarg, NULL, 10); break;
+        case 'p':
+            if (!Sweep_Param_Option(optarg)) {
+                fprintf(stderr, "sweep: bad parameter '%s'\n", optarg);
+                return 2;
+            }
+            break;
+        case 'e': sweep_error_um = (int)(atof(optarg) * 1000); break;
+        case 't': sweep_track = optarg; break;
+        case 's': sweep_seconds = optarg; break;
+        case 'j': jobs = atoi(optarg); break;
+        case 'r': srand((unsigned int)atoi(optarg)); break;
+        case 'o': out_name = optarg; break;
+        default: Sweep_Usage(); return 2;
+        }
+    }
+    if (jobs < 1) jobs = 1;
+    if (jobs > SWEEP_MAX_JOBS) jobs = SWEEP_MAX_JOBS;
+
+    for (i = 0; i < sweep_param_count; i++) {
+        grid *= Sweep_Levels(&sweep_params[i]);
+    }
+    if (use_grid) {
+        count = grid;
+    }
+    if (count == 0) {
+        Sweep_Usage();
+        return 2;
+    }
+    runs = calloc(count, sizeof(sweep_run_t));
+    if (!runs) {
+        perror("sweep");
+        return 1;
+    }
+    for (next = 0; next < count; next++) {
+        Sweep_Point(&runs[next], next, !use_grid);
+    }
+    if ((mkdir(SWEEP_DIR, 0777) != 0) && (access(SWEEP_DIR, W_OK) != 0)) {
+        perror(SWEEP_DIR);
+        return 1;
+    }
+    printf("sweep: %lu %s runs (grid %lu) on \"%s\", %d workers\n",
+           count, use_grid ? "grid" : "random", grid, sweep_track, jobs);
+    fflush(stdout);
+
+    // Keep <jobs> workers busy; each hands its result back on a pipe
+    next = 0;
+    while (finished < count) {
+        while ((running < jobs) && (next < count)) {
+            int fd[2];
+            if (pipe(fd) != 0) {
+                perror("pipe");
+                return 1;
+            }
+            pid = fork();
+            if (pid == 0) {
+                close(fd[0]);
+                Sweep_Worker(&runs[next], (unsigned int)next, fd[1]);
+            }
+            close(fd[1]);
+            for (j = 0; (j < jobs) && job_pid[j]; j++) { }
+            job_pid[j] = pid;
+            job_pipe[j] = fd[0];
+            job_index[j] = next;
+            running++;
+            next++;
+        }
+
+        pid = wait(&status);
+        for (j = 0; (j < jobs) && (job_pid[j] != pid); j++) { }
+        if (j == jobs) {
+            continue;                           // Not a worker (make's children are reaped by system())
+        }
+        if (read(job_pipe[j], &runs[job_index[j]], sizeof(sweep_run_t)) != (ssize_t)sizeof(sweep_run_t)) {
+            runs[job_index[j]].status = 1;
+        }
+        close(job_pipe[j]);
+        job_pid[j] = 0;
+        running--;
+        finished++;
+        printf("[%lu/%lu]", finished, count);
+        Sweep_Print(&runs[job_index[j]]);
+        fflush(stdout);
+    }
+
+    qsort(runs, count, sizeof(sweep_run_t), Sweep_Compare);
+    printf("\nbest (lap time, RMS error, max error, time lost; x = over %.1f mm or unfinished):\n",
+           sweep_error_um / 1000.0);
+    for (next = 0; (next < count) && (next < 10); next++) {
+        Sweep_Print(&runs[next]);
+    }
+    if (!Sweep_Qualifies(&runs[0])) {
+        printf("sweep: no run finished inside the error limit - %s not written\n", out_name);
+        free(runs);
+        return 1;
+    }
+    if (!Sweep_Write(out_name, &runs[0], (unsigned int)count)) {
+        free(runs);
+        return 1;
+    }
+    printf("sweep: wrote %s\n", out_name);
+    free(runs);
+    return 0;
+}
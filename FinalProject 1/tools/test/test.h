@@ -0,0 +1,39 @@
+/*
+ * test.h
+ *
+ *  Created on: Dec 18, 2025
+ *      Author: Dallas.Owens
+ *
+ *  Description: Minimal checks for the host unit tests (tools/test)
+ */
+
+#ifndef TEST_H_
+#define TEST_H_
+
+#include <stdio.h>
+
+static int test_failures = 0;
+static int test_checks = 0;
+
+#define CHECK(cond) do { \
+        test_checks++; \
+        if (!(cond)) { \
+            test_failures++; \
+            printf("%s:%d: FAIL %s\n", __FILE__, __LINE__, #cond); \
+        } \
+    } while (0)
+
+#define CHECK_EQ(actual, expected) do { \
+        long test_a = (long)(actual); \
+        long test_e = (long)(expected); \
+        test_checks++; \
+        if (test_a != test_e) { \
+            test_failures++; \
+            printf("%s:%d: FAIL %s = %.0f, expected %.0f\n", __FILE__, __LINE__, #actual, (double)test_a, (double)test_e); \
+        } \
+    } while (0)
+
+#define TEST_DONE(name) \
+    (printf("%s: %d checks, %d failed\n", (name), test_checks, test_failures), (test_failures != 0))
+
+#endif /* TEST_H_ */
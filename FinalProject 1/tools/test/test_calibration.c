@@ -0,0 +1,345 @@
+/*
+ * test_calibration.c
+ *
+ *  Created on: Dec 18, 2025
+ *      Author: Dallas.Owens
+ *
+ *  Description: Host tests for calibration.c - per-sensor normalization:
+ *               the Q12 reciprocal and its span limits, the clamps at the
+ *               white and black ends, the threshold step when there is no
+ *               usable span, and when a moved span recomputes the
+ *               reciprocal. Then online calibration on a replayed sensor
+ *               trace: the envelope following the extremes, its decay, and
+ *               the FRAM save on each low -> good confidence transition.
+ *               calibration.c and fram.c are included so the statics can be
+ *               checked; the LCD and motor calls are stubbed.
+ */
+
+// What the current board headers would declare (see test_dac.c)
+void HEXtoBCD(int hex_value);
+void adc_line(char line, char location);
+
+#include "../../Exclude/calibration.c"
+#include "../../Exclude/fram.c"
+#include "test.h"
+
+// Stubs - what calibration.c links against on the car
+char display_line[4][11];
+volatile unsigned char display_changed = FALSE;
+unsigned char display_menu = FALSE;
+volatile unsigned int SW2_pressed = 0;
+volatile unsigned int ADC_Line_Detect[LINE_SENSOR_COUNT];
+
+void HEXtoBCD(int hex_value) { (void)hex_value; }
+void adc_line(char line, char location) { (void)line; (void)location; }
+void Motor_Stop(void) {}
+
+#define TEST_SENSOR     (LINE_CENTER_LEFT)
+
+
+// Every sensor on the same black/white pair, reciprocals recomputed
+static void Test_Set_Span(unsigned int white, unsigned int black) {
+    unsigned int i;
+
+    for (i = 0; i < LINE_SENSOR_COUNT; i++) {
+        LINE_WHITE_VALUE[i] = white;
+        LINE_BLACK_VALUE[i] = black;
+        LINE_THRESHOLD[i] = (white + black) / 2;
+        norm_span[i] = 0xFFFF;                              // Force Norm_Recip
+    }
+    IR_Normalize_Update();
+}
+
+// span < NORM_MIN_SPAN (or inverted): no reciprocal, and nothing to compare drift with
+static void Test_Min_Span(void) {
+    unsigned int span_used = 123;
+
+    CHECK_EQ(Norm_Recip(100 + NORM_MIN_SPAN - 1, 100, &span_used), 0);
+    CHECK_EQ(span_used, 0);
+    CHECK_EQ(Norm_Recip(100, 100, &span_used), 0);
+    CHECK_EQ(Norm_Recip(100, 400, &span_used), 0);          // Black below white
+    CHECK_EQ(span_used, 0);
+
+    CHECK(Norm_Recip(100 + NORM_MIN_SPAN, 100, &span_used) != 0);
+    CHECK_EQ(span_used, NORM_MIN_SPAN);
+}
+
+// The reciprocal fits 16 bits over every span the 10-bit ADC can give, and
+// the last count below black lands within 2 of the exact 1000 (span - 1) / span -
+// one lost to the truncated reciprocal, one to the shift
+static void Test_Recip_Bounds(void) {
+    unsigned int span, span_used, recip, top;
+    unsigned char bounded = TRUE, near_full = TRUE;
+
+    for (span = NORM_MIN_SPAN; span <= 1023; span++) {
+        recip = Norm_Recip(span, 0, &span_used);
+        if ((recip == 0) || ((((unsigned long)NORM_FULL_SCALE << NORM_RECIP_SHIFT) / span) > 0xFFFF)) {
+            bounded = FALSE;
+        }
+        top = IR_Normalize(span - 1, 0, span, span / 2, recip);
+        if ((top > NORM_FULL_SCALE)
+                || (((unsigned long)(top + 2) * span) < ((unsigned long)NORM_FULL_SCALE * (span - 1)))) {
+            near_full = FALSE;
+        }
+    }
+    CHECK(bounded);
+    CHECK(near_full);
+    CHECK_EQ(Norm_Recip(NORM_MIN_SPAN, 0, &span_used), 65015);
+    CHECK_EQ(Norm_Recip(1023, 0, &span_used), 4003);
+}
+
+static void Test_Clamps(void) {
+    unsigned int recip;
+
+    Test_Set_Span(100, 900);
+    recip = LINE_NORM_RECIP[TEST_SENSOR];
+    CHECK_EQ(recip, 5120);
+
+    CHECK_EQ(IR_Normalize(0, 100, 900, 500, recip), 0);                 // At or under white
+    CHECK_EQ(IR_Normalize(100, 100, 900, 500, recip), 0);
+    CHECK_EQ(IR_Normalize(101, 100, 900, 500, recip), 1);
+    CHECK_EQ(IR_Normalize(500, 100, 900, 500, recip), 500);
+    CHECK_EQ(IR_Normalize(899, 100, 900, 500, recip), 998);
+    CHECK_EQ(IR_Normalize(900, 100, 900, 500, recip), NORM_FULL_SCALE); // At or over black
+    CHECK_EQ(IR_Normalize(1023, 100, 900, 500, recip), NORM_FULL_SCALE);
+
+    Test_Set_Span(0, 1023);                                 // Truncated reciprocal - black itself would give 999
+    recip = LINE_NORM_RECIP[TEST_SENSOR];
+    CHECK_EQ(IR_Normalize(1022, 0, 1023, 511, recip), 998);
+    CHECK_EQ(IR_Normalize(1023, 0, 1023, 511, recip), NORM_FULL_SCALE);
+}
+
+// No reciprocal - on/off at the threshold, as the 2-sensor code did
+static void Test_Threshold_Step(void) {
+    Test_Set_Span(300, 300 + NORM_MIN_SPAN - 1);
+    CHECK_EQ(LINE_NORM_RECIP[TEST_SENSOR], 0);
+
+    CHECK_EQ(IR_Normalize(330, 300, 362, 330, 0), 0);
+    CHECK_EQ(IR_Normalize(331, 300, 362, 330, 0), NORM_FULL_SCALE);
+    CHECK_EQ(IR_Normalize(1023, 300, 362, 330, 0), NORM_FULL_SCALE);
+
+    ADC_Line_Detect[TEST_SENSOR] = 340;                     // Through IR_Normalize_Sample
+    IR_Normalize_Sample();
+    CHECK_EQ(line_norm[TEST_SENSOR], NORM_FULL_SCALE);
+}
+
+// Drift up to NORM_SPAN_TOLERANCE keeps the reciprocal; past it, recomputed
+static void Test_Span_Tolerance(void) {
+    unsigned int recip;
+
+    Test_Set_Span(100, 900);
+    recip = LINE_NORM_RECIP[TEST_SENSOR];
+
+    LINE_BLACK_VALUE[TEST_SENSOR] = 900 + NORM_SPAN_TOLERANCE;
+    IR_Normalize_Update();
+    CHECK_EQ(LINE_NORM_RECIP[TEST_SENSOR], recip);
+    CHECK_EQ(norm_span[TEST_SENSOR], 800);
+
+    LINE_WHITE_VALUE[TEST_SENSOR] = 100 - 1;                // Tolerance + 1 from the span in use
+    IR_Normalize_Update();
+    CHECK_EQ(norm_span[TEST_SENSOR], 800 + NORM_SPAN_TOLERANCE + 1);
+    CHECK_EQ(LINE_NORM_RECIP[TEST_SENSOR],
+             ((unsigned long)NORM_FULL_SCALE << NORM_RECIP_SHIFT) / (800 + NORM_SPAN_TOLERANCE + 1));
+
+    LINE_WHITE_VALUE[TEST_SENSOR] = 900;                    // Contrast gone - back to the threshold step
+    IR_Normalize_Update();
+    CHECK_EQ(LINE_NORM_RECIP[TEST_SENSOR], 0);
+    CHECK_EQ(norm_span[TEST_SENSOR], 0);
+}
+
+
+// Centre pair ADC counts as the car weaves over the line from a standing
+// start on white; the outer sensors stay on white (TEST_TRACE_WHITE)
+typedef struct {
+    unsigned int samples;
+    unsigned int left;                                      // LINE_CENTER_LEFT
+    unsigned int right;                                     // LINE_CENTER_RIGHT
+} test_trace_t;
+
+#define TEST_TRACE_WHITE    (110)
+#define TEST_HALF_LIFE      (89)                            // ln 2 x 2^ONLINE_DECAY_SHIFT / 2 - both edges relax
+
+static const test_trace_t test_trace[] = {
+    { 4, 120, 130 },                                        //  1-4   Placed on white
+    { 1, 480, 140 },                                        //  5     Left edging onto the line
+    { 3, 810, 150 },                                        //  6-8   Left on black
+    { 3, 300, 320 },                                        //  9-11  Straddling
+    { 3, 140, 790 },                                        // 12-14  Right on black
+    { 6, 130, 150 },                                        // 15-20  White - ONLINE_MIN_SAMPLES in
+    { 6, 700, 200 },                                        // 21-26
+    { 4, 860, 140 },                                        // 27-30  Darker than anything so far
+    { 10, 150, 780 },                                       // 31-40
+};
+#define TEST_TRACE_SEGMENTS (sizeof(test_trace) / sizeof(test_trace[0]))
+
+static unsigned int test_sample = 0;                        // Samples replayed
+static unsigned int test_confident_at = 0;                  // Sample that last cleared low confidence
+
+static void Test_Sample(unsigned int left, unsigned int right) {
+    unsigned char was_low = calibration_low_confidence;
+    unsigned int i;
+
+    for (i = 0; i < LINE_SENSOR_COUNT; i++) {
+        ADC_Line_Detect[i] = TEST_TRACE_WHITE;
+    }
+    ADC_Line_Detect[LINE_CENTER_LEFT] = left;
+    ADC_Line_Detect[LINE_CENTER_RIGHT] = right;
+    IR_Calibrate_Online_Update();
+    test_sample++;
+    if (was_low && !calibration_low_confidence) {
+        test_confident_at = test_sample;
+    }
+}
+
+// Carry the replay on up to and including sample 'until' (1-based)
+static void Test_Replay_To(unsigned int until) {
+    unsigned int segment, k, index = 0;
+
+    for (segment = 0; segment < TEST_TRACE_SEGMENTS; segment++) {
+        for (k = 0; k < test_trace[segment].samples; k++) {
+            if (++index <= test_sample) continue;
+            if (index > until) return;
+            Test_Sample(test_trace[segment].left, test_trace[segment].right);
+        }
+    }
+}
+
+static void Test_Replay_Start(void) {
+    test_sample = 0;
+    test_confident_at = 0;
+}
+
+// The FRAM record holds what is in use now
+static unsigned char Test_Record_Current(void) {
+    unsigned int i;
+
+    if (calib_record.version != CALIB_RECORD_VERSION) return FALSE;
+    for (i = 0; i < LINE_SENSOR_COUNT; i++) {
+        if ((calib_record.black[i] != LINE_BLACK_VALUE[i]) || (calib_record.white[i] != LINE_WHITE_VALUE[i])
+                || (calib_record.threshold[i] != LINE_THRESHOLD[i])) {
+            return FALSE;
+        }
+    }
+    return TRUE;
+}
+
+static unsigned int Test_Span(unsigned int sensor) {
+    return LINE_BLACK_VALUE[sensor] - LINE_WHITE_VALUE[sensor];
+}
+
+// From nothing: fixed thresholds until there is contrast, the envelope on
+// the extremes, one save when confidence arrives - not before, not after
+static void Test_Online_Envelope(void) {
+    unsigned int saved;
+
+    Calibration_Invalidate();
+    Test_Replay_Start();
+    CHECK(calibration_low_confidence);
+    CHECK(!calibration_complete);
+    CHECK_EQ(LINE_THRESHOLD[LINE_CENTER_LEFT], DETECT_THRESH_LEFT);
+
+    Test_Replay_To(4);                                      // White only - nothing to go on
+    CHECK_EQ(LINE_THRESHOLD[LINE_CENTER_LEFT], DETECT_THRESH_LEFT);
+    CHECK_EQ(LINE_BLACK_VALUE[LINE_CENTER_LEFT], 0);
+
+    Test_Replay_To(5);                                      // First contrast past ONLINE_MIN_SPAN
+    CHECK_EQ(LINE_BLACK_VALUE[LINE_CENTER_LEFT], 480);
+    CHECK_EQ(LINE_WHITE_VALUE[LINE_CENTER_LEFT], 120);
+    CHECK_EQ(LINE_THRESHOLD[LINE_CENTER_LEFT], 300);
+    CHECK_EQ(LINE_THRESHOLD[LINE_CENTER_RIGHT], DETECT_THRESH_RIGHT);   // Right still without
+
+    Test_Replay_To(6);                                      // New extreme taken at once, white barely relaxed
+    CHECK_EQ(LINE_BLACK_VALUE[LINE_CENTER_LEFT], 810);
+    CHECK(LINE_WHITE_VALUE[LINE_CENTER_LEFT] >= 120);
+    CHECK(LINE_WHITE_VALUE[LINE_CENTER_LEFT] <= 122);
+    CHECK(LINE_NORM_RECIP[LINE_CENTER_LEFT] != 0);
+
+    Test_Replay_To(ONLINE_MIN_SAMPLES - 1);                 // Both centres have contrast, too few samples
+    CHECK(Test_Span(LINE_CENTER_RIGHT) >= ONLINE_MIN_SPAN);
+    CHECK(calibration_low_confidence);
+    CHECK_EQ(calib_record.version, 0);
+
+    Test_Replay_To(ONLINE_MIN_SAMPLES);
+    CHECK_EQ(test_confident_at, ONLINE_MIN_SAMPLES);
+    CHECK(calibration_complete);
+    CHECK(Test_Record_Current());
+    saved = calib_record.black[LINE_CENTER_LEFT];
+    CHECK(saved < 810);                                     // 12 samples off black - relaxed a little
+    CHECK(saved > 760);
+
+    Test_Replay_To(27);                                     // Still tracking, but the record is left alone
+    CHECK_EQ(LINE_BLACK_VALUE[LINE_CENTER_LEFT], 860);
+    CHECK_EQ(calib_record.black[LINE_CENTER_LEFT], saved);
+    CHECK(!calibration_low_confidence);
+
+    Test_Replay_To(40);
+    calibration_complete = FALSE;                           // What the next boot loads
+    CHECK(Calibration_Load());
+    CHECK_EQ(LINE_BLACK_VALUE[LINE_CENTER_LEFT], saved);
+    CHECK(calibration_complete);
+}
+
+// Nothing dark or light for a while: both edges relax toward the samples
+// until the span is too small to trust, then a weave saves the new envelope
+static void Test_Online_Decay(void) {
+    unsigned int i, span, threshold, saved;
+
+    Calibration_Invalidate();
+    Test_Replay_Start();
+    Test_Replay_To(40);
+    saved = calib_record.black[LINE_CENTER_LEFT];
+    span = Test_Span(LINE_CENTER_LEFT);
+    threshold = LINE_THRESHOLD[LINE_CENTER_LEFT];
+
+    for (i = 0; i < TEST_HALF_LIFE; i++) {
+        Test_Sample(threshold, LINE_THRESHOLD[LINE_CENTER_RIGHT]);
+    }
+    CHECK(Test_Span(LINE_CENTER_LEFT) >= (span * 45) / 100);
+    CHECK(Test_Span(LINE_CENTER_LEFT) <= (span * 55) / 100);
+    CHECK(LINE_THRESHOLD[LINE_CENTER_LEFT] >= threshold - 2);   // Relaxed about the middle
+    CHECK(LINE_THRESHOLD[LINE_CENTER_LEFT] <= threshold + 2);
+    CHECK(!calibration_low_confidence);
+
+    for (i = 0; (i < 1000) && !calibration_low_confidence; i++) {
+        Test_Sample(threshold, LINE_THRESHOLD[LINE_CENTER_RIGHT]);
+    }
+    CHECK(calibration_low_confidence);                      // Contrast gone...
+    CHECK(Test_Span(LINE_CENTER_LEFT) >= ONLINE_MIN_SPAN);  // ...last trusted values kept
+    CHECK(calibration_complete);
+    CHECK_EQ(calib_record.black[LINE_CENTER_LEFT], saved);  // Not saved on the way down
+
+    Test_Replay_Start();                                    // Back on the white - saved the moment it is back
+    Test_Replay_To(1);
+    CHECK_EQ(test_confident_at, 1);
+    CHECK(Test_Record_Current());
+    CHECK(calib_record.black[LINE_CENTER_LEFT] < saved);    // The relaxed envelope, not the old one
+    CHECK_EQ(calib_record.white[LINE_CENTER_LEFT], 120);
+}
+
+// Manual calibration running, or online switched off: envelope untouched
+static void Test_Online_Gated(void) {
+    unsigned int black = LINE_BLACK_VALUE[LINE_CENTER_LEFT];
+
+    calibrating = TRUE;
+    Test_Sample(1000, 1000);
+    CHECK_EQ(LINE_BLACK_VALUE[LINE_CENTER_LEFT], black);
+    calibrating = FALSE;
+
+    online_calibration_enabled = FALSE;
+    Test_Sample(1000, 1000);
+    CHECK_EQ(LINE_BLACK_VALUE[LINE_CENTER_LEFT], black);
+    online_calibration_enabled = TRUE;
+}
+
+
+int main(void) {
+    Test_Min_Span();
+    Test_Recip_Bounds();
+    Test_Clamps();
+    Test_Threshold_Step();
+    Test_Span_Tolerance();
+    Test_Online_Envelope();
+    Test_Online_Decay();
+    Test_Online_Gated();
+    return TEST_DONE("test_calibration");
+}
@@ -0,0 +1,239 @@
+/*
+ * test_motion.c
+ *
+ *  Created on: Dec 18, 2025
+ *      Author: Dallas.Owens
+ *
+ *  Description: Host tests for motion.c - the IoT M/N/H/J moves run closed
+ *               loop on the odometry wheel model. Each tick is the TB3 CCR0
+ *               ISR as on the car: odometry integrates the duty the last
+ *               period ran on, motion sets the next, motor.c applies the
+ *               dead time. Checks the final pose against the move asked for,
+ *               and the profile: a trapezoid at MOTION_ACCEL up to
+ *               MOTION_MAX_SPEED, a triangle when the move is too short to
+ *               reach it, then the approach speed into the target.
+ *               odometry.c, motion.c, motor.c and DAC.c are included so the
+ *               statics can be checked; the LCD/UART/LED calls are stubbed.
+ */
+
+// What the current board headers would declare (see test_dac.c)
+#define DAC_CTRL_3      (0x20)          // P3.5
+void RED_ON(void);
+void RED_OFF(void);
+void HEXtoBCD(int hex_value);
+void adc_line(char line, char location);
+void Send_Response(const char *response);
+void PWM_Slew_Update(void);
+
+#include "../../Exclude/odometry.c"
+#include "../../Exclude/motion.c"
+#include "../../Exclude/motor.c"
+#include "../../Exclude/DAC.c"
+#include "../../Exclude/fram.c"
+#include "test.h"
+
+// Stubs - what the move path links against on the car
+char display_line[4][11];
+volatile unsigned char display_changed = FALSE;
+char adc_char[4];
+volatile unsigned char sample_adc = FALSE;
+volatile unsigned int ADC_Supply = 0;
+volatile unsigned char command_complete = FALSE;
+
+void RED_ON(void) {}
+void RED_OFF(void) {}
+void HEXtoBCD(int hex_value) { (void)hex_value; }
+void adc_line(char line, char location) { (void)line; (void)location; }
+void Send_Response(const char *response) { (void)response; }
+void PWM_Slew_Update(void) {}                               // No PWM_ ramps during a move
+
+#define TEST_MAX_TICKS      (ODOM_TICKS_PER_SEC * 60)
+#define TEST_POS_UM         (2000)                          // Final position tolerance
+#define TEST_DRIFT_UM       (20000)                         // Sideways step with a weak wheel
+#define TEST_HEADING        (ODOM_DEG(1))                   // Final heading tolerance
+#define TEST_OVERRUN_UM     (1000)                          // Past the target: under a tick at approach speed, plus rounding
+
+// Profile speed (Q4 mm/s) each tick of the last move
+static unsigned int test_profile[TEST_MAX_TICKS];
+static unsigned int test_ticks;
+
+
+// From rest at the origin, heading 0
+static void Test_Reset(void) {
+    unsigned char i;
+
+    Motion_Stop();
+    Motor_Stop();
+    for (i = 0; i < MOTOR_DEAD_PERIODS; i++) {
+        Motor_Update();
+    }
+    TIMER_B3_CCR0_ISR();                                    // Latch the stopped duty
+    Odometry_Reset();
+    command_complete = FALSE;
+}
+
+// Run the move to completion, one TB3 period at a time
+static void Test_Run(void) {
+    test_ticks = 0;
+    while (Motion_Active() && (test_ticks < TEST_MAX_TICKS)) {
+        TIMER_B3_CCR0_ISR();
+        test_profile[test_ticks++] = motion_speed;
+    }
+    TIMER_B3_CCR0_ISR();                                    // The last period the wheels ran
+}
+
+static long Test_Abs(long value) {
+    return (value < 0) ? -value : value;
+}
+
+static int Test_Heading_Error(unsigned int heading, int deg) {
+    return (short)(heading - (unsigned int)(((long)deg << 16) / 360));
+}
+
+// Finished on the target, not on the stall limit, motors off
+static void Test_Finished(void) {
+    CHECK(!Motion_Active());
+    CHECK(command_complete);
+    CHECK(motion_ticks < motion_limit);
+    CHECK_EQ(LEFT_FORWARD_SPEED, WHEEL_OFF);
+    CHECK_EQ(RIGHT_FORWARD_SPEED, WHEEL_OFF);
+    CHECK_EQ(LEFT_REVERSE_SPEED, WHEEL_OFF);
+    CHECK_EQ(RIGHT_REVERSE_SPEED, WHEEL_OFF);
+}
+
+static void Test_Straight(int mm, long y_um) {
+    odom_pose_t pose;
+
+    Test_Reset();
+    CHECK(Motion_Start_Straight(mm));
+    Test_Run();
+    Test_Finished();
+
+    Odometry_Get_Pose(&pose);
+    printf("Straight %5d mm: %u ticks, x %6d um off, y %5d um, heading %4d\n", mm, test_ticks,
+           (int)(pose.x - ((long)mm * 1000)), (int)pose.y, Test_Heading_Error(Odometry_Heading(), 0));
+    CHECK(Test_Abs(pose.x - ((long)mm * 1000)) <= TEST_POS_UM);
+    CHECK(Test_Abs(pose.y) <= y_um);
+    CHECK(Test_Abs(Test_Heading_Error(Odometry_Heading(), 0)) <= TEST_HEADING);
+    CHECK(pose.distance >= ODOM_MM(Test_Abs(mm)));          // Stops once there...
+    CHECK(pose.distance <= ODOM_MM(Test_Abs(mm)) + TEST_OVERRUN_UM);    // ...not long after
+}
+
+static void Test_Rotate(int deg) {
+    odom_pose_t pose;
+
+    Test_Reset();
+    CHECK(Motion_Start_Rotate(deg));
+    Test_Run();
+    Test_Finished();
+
+    Odometry_Get_Pose(&pose);
+    printf("Rotate  %5d deg: %u ticks, heading %4d off, x %5d um, y %5d um\n", deg, test_ticks,
+           Test_Heading_Error(Odometry_Heading(), deg), (int)pose.x, (int)pose.y);
+    CHECK(Test_Abs(Test_Heading_Error(Odometry_Heading(), deg)) <= TEST_HEADING);
+    CHECK(Test_Abs(pose.x) <= TEST_POS_UM);                 // In place
+    CHECK(Test_Abs(pose.y) <= TEST_POS_UM);
+}
+
+// M / N / H / J as Process_Queue starts them
+static void Test_Moves(void) {
+    Test_Straight(500, TEST_POS_UM);                        // M0500
+    Test_Straight(-300, TEST_POS_UM);                       // N0300
+    Test_Straight(40, TEST_POS_UM);                         // Inside the approach zone from the start
+    Test_Rotate(90);                                        // H0090
+    Test_Rotate(-90);                                       // J0090
+    Test_Rotate(360);
+}
+
+// A weak right wheel (trimmed duty - the model sees what the CCRs drive):
+// the heading hold keeps the car pointing where it started. Proportional
+// only, so it steps sideways while the offset builds up
+static void Test_Heading_Hold(void) {
+    Motor_Set_Trim(MOTOR_RIGHT, 900);
+    Test_Straight(500, TEST_DRIFT_UM);
+    Test_Straight(-500, TEST_DRIFT_UM);
+    Motor_Set_Trim(MOTOR_RIGHT, MOTOR_TRIM_RIGHT);
+}
+
+static void Test_Out_Of_Range(void) {
+    Test_Reset();
+    CHECK(!Motion_Start_Straight(0));
+    CHECK(!Motion_Start_Straight(MOTION_MAX_MM + 1));
+    CHECK(!Motion_Start_Rotate(0));
+    CHECK(!Motion_Start_Rotate(-(MOTION_MAX_DEG + 1)));
+    CHECK(!Motion_Active());
+}
+
+
+// The profile of the last move: from the approach speed up a step per tick,
+// an optional plateau at the top, down a step per tick, then the approach
+// speed to the end
+static void Test_Shape(unsigned int *peak, unsigned int *plateau, unsigned int *approach) {
+    unsigned int i = 0;
+    unsigned int approach_q = (unsigned int)MOTION_APPROACH_SPEED << MOTION_SPEED_SHIFT;
+    unsigned char steps = TRUE;
+
+    *peak = 0;
+    *plateau = 0;
+    *approach = 0;
+
+    for (i = 1; (i < test_ticks) && (test_profile[i] > test_profile[i - 1]); i++) {        // Accelerate
+        if ((test_profile[i] - test_profile[i - 1] != MOTION_ACCEL_STEP)
+                && (test_profile[i] != ((unsigned int)MOTION_MAX_SPEED << MOTION_SPEED_SHIFT))) {
+            steps = FALSE;
+        }
+    }
+    *peak = test_profile[i - 1];
+    for (; (i < test_ticks) && (test_profile[i] == *peak); i++) {                           // Cruise
+        (*plateau)++;
+    }
+    for (; (i < test_ticks) && (test_profile[i] < test_profile[i - 1]); i++) {             // Brake
+        if ((test_profile[i - 1] - test_profile[i] != MOTION_ACCEL_STEP) && (test_profile[i] != approach_q)) {
+            steps = FALSE;
+        }
+    }
+    for (; (i < test_ticks) && (test_profile[i] == approach_q); i++) {                     // Approach
+        (*approach)++;
+    }
+    CHECK(steps);
+    CHECK_EQ(i, test_ticks);                                // Nothing after the approach
+    CHECK_EQ(test_profile[0], approach_q);                  // From rest: no slower than the approach
+}
+
+static void Test_Trapezoid(void) {
+    unsigned int peak, plateau, approach;
+    unsigned long approach_ticks = ((unsigned long)MOTION_APPROACH_MM * ODOM_TICKS_PER_SEC) / MOTION_APPROACH_SPEED;
+
+    Test_Reset();                                           // Long move - reaches cruise
+    Motion_Start_Straight(500);
+    Test_Run();
+    Test_Shape(&peak, &plateau, &approach);
+    CHECK_EQ(peak, (unsigned int)MOTION_MAX_SPEED << MOTION_SPEED_SHIFT);
+    CHECK(plateau > 0);
+    CHECK(approach >= (approach_ticks * 3) / 4);            // About MOTION_APPROACH_MM at the approach speed
+    CHECK(approach <= (approach_ticks * 3) / 2);
+
+    Test_Reset();                                           // Short move - a triangle
+    Motion_Start_Straight(100);
+    Test_Run();
+    Test_Shape(&peak, &plateau, &approach);
+    CHECK(peak < ((unsigned int)MOTION_MAX_SPEED << MOTION_SPEED_SHIFT));
+    CHECK(peak > ((unsigned int)MOTION_APPROACH_SPEED << MOTION_SPEED_SHIFT));
+    CHECK(plateau <= 1);
+
+    Test_Reset();                                           // A rotation runs the same profile on the wheel arc
+    Motion_Start_Rotate(360);
+    Test_Run();
+    Test_Shape(&peak, &plateau, &approach);
+    CHECK_EQ(peak, (unsigned int)MOTION_MAX_SPEED << MOTION_SPEED_SHIFT);
+    CHECK(plateau > 0);
+}
+
+
+int main(void) {
+    Test_Moves();
+    Test_Heading_Hold();
+    Test_Out_Of_Range();
+    Test_Trapezoid();
+    return TEST_DONE("test_motion");
+}
@@ -0,0 +1,171 @@
+/*
+ * test_motor.c
+ *
+ *  Created on: Dec 18, 2025
+ *      Author: Dallas.Owens
+ *
+ *  Description: Host tests for motor.c - signed speed to the four wheel CCRs,
+ *               clamps and trim, and the dead time Motor_Update counts out
+ *               before a reversal is driven. motor.c is included so the
+ *               per-wheel state can be reset between tests.
+ */
+
+#include "../../Exclude/motor.c"
+#include "test.h"
+
+#define COUNTS(speed)   ((unsigned int)(speed) * MOTOR_COUNTS_PER_UNIT)
+
+
+// Both wheels off and settled, trim as built
+static void Motor_Reset(void) {
+    unsigned char i;
+
+    Motor_Set(0, 0);
+    for (i = 0; i < MOTOR_DEAD_PERIODS; i++) {
+        Motor_Update();
+    }
+    motor_trim[MOTOR_LEFT] = MOTOR_TRIM_LEFT;
+    motor_trim[MOTOR_RIGHT] = MOTOR_TRIM_RIGHT;
+}
+
+// A wheel's forward and reverse CCRs are never both driven
+static unsigned char Motor_Bridge_Safe(void) {
+    return ((LEFT_FORWARD_SPEED == WHEEL_OFF) || (LEFT_REVERSE_SPEED == WHEEL_OFF))
+        && ((RIGHT_FORWARD_SPEED == WHEEL_OFF) || (RIGHT_REVERSE_SPEED == WHEEL_OFF));
+}
+
+
+static void Test_Write(void) {
+    Motor_Reset();
+    Motor_Set(600, -300);
+    CHECK_EQ(LEFT_FORWARD_SPEED, COUNTS(600));
+    CHECK_EQ(LEFT_REVERSE_SPEED, WHEEL_OFF);
+    CHECK_EQ(RIGHT_FORWARD_SPEED, WHEEL_OFF);
+    CHECK_EQ(RIGHT_REVERSE_SPEED, COUNTS(300));
+    CHECK_EQ(Motor_Get(MOTOR_LEFT), 600);
+    CHECK_EQ(Motor_Get(MOTOR_RIGHT), -300);
+    CHECK(!Motor_Settling(MOTOR_LEFT) && !Motor_Settling(MOTOR_RIGHT));     // From rest - no wait
+
+    Motor_Set_Wheel(MOTOR_RIGHT, -800);                 // Same way - straight through
+    CHECK_EQ(RIGHT_REVERSE_SPEED, COUNTS(800));
+    CHECK_EQ(LEFT_FORWARD_SPEED, COUNTS(600));          // Other wheel rewritten unchanged
+
+    Motor_Set_Wheel(MOTOR_WHEELS, 500);                 // No such wheel
+    CHECK_EQ(LEFT_FORWARD_SPEED, COUNTS(600));
+    CHECK_EQ(Motor_Get(MOTOR_WHEELS), 0);
+}
+
+static void Test_Clamp_Trim(void) {
+    Motor_Reset();
+    Motor_Set(1500, -1500);
+    CHECK_EQ(Motor_Get(MOTOR_LEFT), MOTOR_SPEED_MAX);
+    CHECK_EQ(Motor_Get(MOTOR_RIGHT), -MOTOR_SPEED_MAX);
+    CHECK_EQ(LEFT_FORWARD_SPEED, PERCENT_100);
+    CHECK_EQ(RIGHT_REVERSE_SPEED, PERCENT_100);
+
+    Motor_Set_Trim(MOTOR_LEFT, MOTOR_TRIM_MAX + 100);   // Clamped, and past the period
+    CHECK_EQ(motor_trim[MOTOR_LEFT], MOTOR_TRIM_MAX);
+    CHECK_EQ(LEFT_FORWARD_SPEED, WHEEL_PERIOD);
+
+    Motor_Set(600, -600);
+    Motor_Set_Trim(MOTOR_RIGHT, 900);                   // Applied at once
+    CHECK_EQ(RIGHT_REVERSE_SPEED, (COUNTS(600) * 9) / 10);
+    Motor_Set_Trim(MOTOR_RIGHT, 0);
+    CHECK_EQ(motor_trim[MOTOR_RIGHT], MOTOR_TRIM_MIN);
+    CHECK_EQ(RIGHT_REVERSE_SPEED, COUNTS(600) / 2);
+}
+
+// Forward -> reverse: off for MOTOR_DEAD_PERIODS, then driven by Motor_Update
+static void Test_Reversal(void) {
+    unsigned char i;
+
+    Motor_Reset();
+    Motor_Set(600, 600);
+    Motor_Set(-600, 600);
+    CHECK_EQ(LEFT_FORWARD_SPEED, WHEEL_OFF);
+    CHECK_EQ(LEFT_REVERSE_SPEED, WHEEL_OFF);
+    CHECK_EQ(RIGHT_FORWARD_SPEED, COUNTS(600));
+    CHECK_EQ(Motor_Get(MOTOR_LEFT), -600);              // Held, not dropped
+    CHECK(Motor_Settling(MOTOR_LEFT));
+    CHECK(!Motor_Settling(MOTOR_RIGHT));
+
+    for (i = 1; i < MOTOR_DEAD_PERIODS; i++) {
+        Motor_Update();
+        CHECK_EQ(LEFT_REVERSE_SPEED, WHEEL_OFF);
+        CHECK(Motor_Settling(MOTOR_LEFT));
+    }
+    Motor_Update();
+    CHECK_EQ(LEFT_FORWARD_SPEED, WHEEL_OFF);
+    CHECK_EQ(LEFT_REVERSE_SPEED, COUNTS(600));
+    CHECK(!Motor_Settling(MOTOR_LEFT));
+    CHECK(Motor_Bridge_Safe());
+
+    Motor_Set(600, 600);                                // And back - dead time again
+    CHECK_EQ(LEFT_REVERSE_SPEED, WHEEL_OFF);
+    CHECK_EQ(LEFT_FORWARD_SPEED, WHEEL_OFF);
+    CHECK(Motor_Settling(MOTOR_LEFT));
+}
+
+// A new reversal during the dead time does not restart it
+static void Test_Reversal_Held(void) {
+    unsigned char i;
+
+    Motor_Reset();
+    Motor_Set(600, 0);
+    Motor_Set(0, 0);                                    // Stop starts the dead time
+    Motor_Update();
+    Motor_Set(-400, 0);
+    for (i = 2; i < MOTOR_DEAD_PERIODS; i++) {
+        Motor_Update();
+        CHECK(Motor_Bridge_Safe());
+    }
+    CHECK_EQ(LEFT_REVERSE_SPEED, WHEEL_OFF);
+    Motor_Update();
+    CHECK_EQ(LEFT_REVERSE_SPEED, COUNTS(400));
+
+    Motor_Set(600, 0);                                  // Reversal held...
+    Motor_Update();
+    CHECK(Motor_Settling(MOTOR_LEFT));
+    CHECK_EQ(LEFT_FORWARD_SPEED, WHEEL_OFF);
+    Motor_Set(-400, 0);                                 // ...then back the way it was driven - no wait
+    CHECK(!Motor_Settling(MOTOR_LEFT));
+    CHECK_EQ(LEFT_REVERSE_SPEED, COUNTS(400));
+}
+
+// Stop then the same way again: driven straight away
+static void Test_Stop_Resume(void) {
+    unsigned char i;
+
+    Motor_Reset();
+    Motor_Set(600, 600);
+    Motor_Stop();
+    CHECK_EQ(LEFT_FORWARD_SPEED, WHEEL_OFF);
+    CHECK_EQ(RIGHT_FORWARD_SPEED, WHEEL_OFF);
+    CHECK(Motor_Settling(MOTOR_LEFT));
+    Motor_Set(600, 600);
+    CHECK_EQ(LEFT_FORWARD_SPEED, COUNTS(600));
+    CHECK(!Motor_Settling(MOTOR_LEFT));
+
+    // Stopped and settled - Motor_Update leaves the CCRs alone
+    Motor_Stop();
+    for (i = 0; i < MOTOR_DEAD_PERIODS; i++) {
+        Motor_Update();
+    }
+    LEFT_FORWARD_SPEED = 123;
+    Motor_Update();
+    CHECK_EQ(LEFT_FORWARD_SPEED, 123);
+    Motor_Set(-600, -600);                              // Settled - either way at once
+    CHECK_EQ(LEFT_REVERSE_SPEED, COUNTS(600));
+    CHECK_EQ(RIGHT_REVERSE_SPEED, COUNTS(600));
+    CHECK(Motor_Bridge_Safe());
+}
+
+
+int main(void) {
+    Test_Write();
+    Test_Clamp_Trim();
+    Test_Reversal();
+    Test_Reversal_Held();
+    Test_Stop_Resume();
+    return TEST_DONE("test_motor");
+}
@@ -0,0 +1,188 @@
+/*
+ * test_pid.c
+ *
+ *  Created on: Dec 18, 2025
+ *      Author: Dallas.Owens
+ *
+ *  Description: Host tests for pid.c - saturating accumulation, integrator
+ *               clamp and anti-windup, output clamp, derivative filter -
+ *               and a per-update timing run through the CYCLE_STAMP hook.
+ *               pid.c is included so its static helpers can be reached.
+ */
+
+static unsigned int Host_Cycle_Stamp(void);
+#define CYCLE_STAMP()   Host_Cycle_Stamp()
+
+#include "../../Exclude/pid.c"
+#include "test.h"
+
+#define BENCH_UPDATES   (100000UL)
+
+// Host ns folded into the TB3 range, so CYCLES_SINCE works as on the board
+static unsigned int Host_Cycle_Stamp(void) {
+    struct timespec now;
+    time_t ns;                                                  // 64 bits - not narrowed
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    ns = (now.tv_sec * 1000000000) + now.tv_nsec;
+    return (unsigned int)(ns % (WHEEL_PERIOD + 1));
+}
+
+
+static void Test_Sat_Add(void) {
+    CHECK_EQ(PID_Sat_Add(1000, 2000), 3000);
+    CHECK_EQ(PID_Sat_Add(PID_ACC_MAX, 1), PID_ACC_MAX);
+    CHECK_EQ(PID_Sat_Add(PID_ACC_MAX, PID_ACC_MAX), PID_ACC_MAX);
+    CHECK_EQ(PID_Sat_Add(PID_ACC_MIN, -1), PID_ACC_MIN);
+    CHECK_EQ(PID_Sat_Add(PID_ACC_MIN, PID_ACC_MIN), PID_ACC_MIN);
+    CHECK_EQ(PID_Sat_Add(PID_ACC_MAX, PID_ACC_MIN), -1);        // Mixed signs never overflow
+    CHECK_EQ(PID_Sat_Add(PID_ACC_MAX - 5, 5), PID_ACC_MAX);
+    CHECK_EQ(PID_Sat_Add(PID_ACC_MIN + 5, -5), PID_ACC_MIN);
+}
+
+static void Test_Clamps(void) {
+    CHECK_EQ(PID_Clamp_Int(40000L, 500), 500);
+    CHECK_EQ(PID_Clamp_Int(-40000L, 500), -500);
+    CHECK_EQ(PID_Clamp_Int(499, 500), 499);
+    CHECK_EQ(PID_Clamp_Diff(32767L - (-32768L)), 32767);
+    CHECK_EQ(PID_Clamp_Diff(-32768L - 32767L), -32767);
+    CHECK_EQ(PID_Clamp_Diff(-32768L), -32767);                   // Symmetric - negates safely
+}
+
+// Output pinned at +/- out_max, saturated flag follows it
+static void Test_Output_Clamp(void) {
+    pid_controller_t pid;
+
+    PID_Init(&pid, PID_GAIN(100), 0, 0, 500);
+    CHECK_EQ(PID_Update(&pid, 100, 0), 500);
+    CHECK_EQ(pid.saturated, 1);
+    CHECK_EQ(PID_Update(&pid, -100, 0), -500);
+    CHECK_EQ(pid.saturated, -1);
+    CHECK_EQ(PID_Update(&pid, 2, 0), 200);
+    CHECK_EQ(pid.saturated, 0);
+}
+
+// Worst case terms: Kp*e and -Kd*d both ~2^30 plus the integral overflow
+// 32 bits - the sum must pin at PID_ACC_MAX, not wrap to a full negative output
+static void Test_Accumulator_Overflow(void) {
+    pid_controller_t pid;
+
+    PID_Init(&pid, 32767, 32767, -32768, 32767);
+    pid.d_filter_shift = 0;
+    PID_Update(&pid, 32767, -32768);                            // First update - sets last_measurement
+    CHECK_EQ(PID_Update(&pid, 32767, -1), 32767);               // e = 32767 (clamped), rate = +32767
+    CHECK_EQ(pid.saturated, 1);
+
+    PID_Init(&pid, 32767, 32767, -32768, 32767);
+    pid.d_filter_shift = 0;
+    PID_Update(&pid, -32768, 32767);
+    CHECK_EQ(PID_Update(&pid, -32768, 0), -32767);              // e = -32767 (clamped), rate = -32767
+    CHECK_EQ(pid.saturated, -1);
+}
+
+// Integral stays inside +/- out_max (Q.4) however long the error lasts
+static void Test_Integral_Limit(void) {
+    pid_controller_t pid;
+    unsigned int i;
+
+    PID_Init(&pid, 0, PID_GAIN(1), 0, 300);
+    for (i = 0; i < 1000; i++) {
+        PID_Update(&pid, 100, 0);
+    }
+    CHECK_EQ(pid.integral, 300L << PID_GAIN_SHIFT);
+    CHECK_EQ(PID_Update(&pid, 0, 0), 300);
+
+    PID_Init(&pid, 0, PID_GAIN(1), 0, 300);
+    for (i = 0; i < 1000; i++) {
+        PID_Update(&pid, -100, 0);
+    }
+    CHECK_EQ(pid.integral, -(300L << PID_GAIN_SHIFT));
+}
+
+// While P alone pins the output the integrator is held, so the output leaves
+// the limit as soon as the error reverses
+static void Test_Anti_Windup(void) {
+    pid_controller_t pid;
+    unsigned int i;
+    long integral;
+
+    PID_Init(&pid, PID_GAIN(10), PID_GAIN(1), 0, 500);
+    PID_Update(&pid, 100, 0);                                   // P = 1000 -> pinned at 500
+    integral = pid.integral;
+    for (i = 0; i < 200; i++) {
+        CHECK_EQ(PID_Update(&pid, 100, 0), 500);
+    }
+    CHECK_EQ(pid.integral, integral);                           // Held after the first update
+    CHECK(PID_Update(&pid, -10, 0) < 0);                        // Unwinds at once
+
+    // Held only in the direction it is pinned: an opposing error still integrates
+    PID_Init(&pid, PID_GAIN(10), PID_GAIN(1), 0, 500);
+    PID_Update(&pid, 100, 0);
+    integral = pid.integral;
+    pid.saturated = 1;
+    PID_Update(&pid, -5, 0);
+    CHECK(pid.integral < integral);
+}
+
+// Filtered rate settles on the exact rate, either sign
+static void Test_Derivative_Filter(void) {
+    pid_controller_t pid;
+    int measurement;
+    unsigned int i;
+    unsigned char shift;
+
+    for (shift = 0; shift <= 4; shift++) {
+        PID_Init(&pid, 0, 0, 0, 500);
+        pid.d_filter_shift = shift;
+        for (i = 0, measurement = 0; i < 200; i++, measurement += 3) {
+            PID_Rate_Update(&pid, measurement);
+        }
+        CHECK_EQ(pid.d_filtered, 3);
+
+        PID_Init(&pid, 0, 0, 0, 500);
+        pid.d_filter_shift = shift;
+        for (i = 0, measurement = 0; i < 200; i++, measurement -= 3) {
+            PID_Rate_Update(&pid, measurement);
+        }
+        CHECK_EQ(pid.d_filtered, -3);
+    }
+
+    PID_Init(&pid, 0, 0, 0, 500);
+    pid.d_filter_shift = 0;
+    PID_Rate_Update(&pid, -32768);
+    CHECK_EQ(PID_Rate_Update(&pid, 32767), 32767);              // Largest step, clamped difference
+    CHECK_EQ(PID_Rate_Update(&pid, -32768), -32767);
+}
+
+// Per-update cost through the same CYCLE_STAMP path the board uses (host ns here;
+// the board figure is pid.cycles / cycles_max with CYCLE_STAMP = TB3R)
+static void Bench_Update(void) {
+    pid_controller_t pid;
+    struct timespec start, end;
+    unsigned long i;
+    double ns;
+    volatile int sink = 0;
+
+    PID_Init(&pid, PID_GAIN(7), PID_GAIN_FRAC(1, 4), PID_GAIN(20), 20000);
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (i = 0; i < BENCH_UPDATES; i++) {
+        sink += PID_Update(&pid, 0, (int)((i * 37) % 2001) - 1000);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    ns = ((end.tv_sec - start.tv_sec) * 1e9 + (end.tv_nsec - start.tv_nsec)) / BENCH_UPDATES;
+    printf("PID_Update: %.1f ns/update (host), last %u, max %u (CYCLE_STAMP)\n", ns, pid.cycles, pid.cycles_max);
+    (void)sink;
+}
+
+
+int main(void) {
+    Test_Sat_Add();
+    Test_Clamps();
+    Test_Output_Clamp();
+    Test_Accumulator_Overflow();
+    Test_Integral_Limit();
+    Test_Anti_Windup();
+    Test_Derivative_Filter();
+    Bench_Update();
+    return TEST_DONE("test_pid");
+}
@@ -0,0 +1,207 @@
+/*
+ * test_steer_lut.c
+ *
+ *  Created on: Dec 18, 2025
+ *      Author: Dallas.Owens
+ *
+ *  Description: Host tests for steer_lut.c - the table against the code it
+ *               stands in for. Every (error, rate) the lookup can see is
+ *               swept and compared with PID_Update on the steering gains and
+ *               Line_Follow_Split: exact on the grid points, and between
+ *               them only the cells holding a deadzone / sharp turn edge or
+ *               the correction clamp may differ by more than rounding.
+ *               Also the time per update for both (host ns).
+ *               Line_Follow_Split sits in wheels.c with the whole state
+ *               machine around it, so this test links the firmware set the
+ *               simulator builds (tools/sim) rather than including one file.
+ */
+
+#include <time.h>
+#include "msp430.h"
+#include "macros.h"
+#include "control.h"
+#include "pid.h"
+#include "wheels.h"
+#include "steer_ctrl.h"
+#include "steer_lut.h"
+#include "test.h"
+
+#define TEST_ERR_MAX        ((STEER_LUT_ERR_STEPS / 2) << STEER_LUT_ERR_SHIFT)
+#define TEST_RATE_MAX       ((STEER_LUT_RATE_STEPS / 2) << STEER_LUT_RATE_SHIFT)
+#define TEST_ERR_STEP       (1 << STEER_LUT_ERR_SHIFT)
+#define TEST_RATE_STEP      (1 << STEER_LUT_RATE_SHIFT)
+#define TEST_ROUNDING       (2)                             // One count per interpolation pass
+#define BENCH_UPDATES       (1000000UL)
+
+extern steer_lut_t steer_lut;
+
+
+// What Line_Follow_PD_V1 does without the table: gain by |error|, then
+// PID_Update with this rate
+static int Test_PD(int error, int rate) {
+    pid_controller_t pid;
+    int abs_error = (error > 0) ? error : -error;
+
+    PID_Init(&pid, (abs_error > SHARP_ERROR_THRESHOLD_V4) ? steer_pd_params.kp_sharp : steer_pd_params.kp_gentle,
+             0, steer_pd_params.kd, steer_pd_params.max_correction);
+    pid.d_filter_shift = 0;
+    pid.first_update = FALSE;
+    pid.last_measurement = error - rate;
+    return -PID_Update(&pid, 0, error);
+}
+
+// ...and the wheel split
+static void Test_Reference(int error, int rate, int *left, int *right) {
+    Line_Follow_Split(error, Test_PD(error, rate), left, right);
+}
+
+static int Test_Clamped(int pd) {
+    return (pd >= steer_pd_params.max_correction) ? 1 : ((pd <= -steer_pd_params.max_correction) ? -1 : 0);
+}
+
+// The reference at the four corners of the cell holding (error, rate):
+// whether it is one straight line across the cell (no deadzone or sharp turn
+// edge inside, the correction clamp at all corners or none), and the range
+// of wheel offsets it gives there
+static unsigned char Test_Cell(int error, int rate, int *min, int *max) {
+    int error_lo = error - ((error - STEER_LUT_ERR_MIN) & (TEST_ERR_STEP - 1));
+    int rate_lo = rate - ((rate - STEER_LUT_RATE_MIN) & (TEST_RATE_STEP - 1));
+    int abs_lo = (error_lo >= 0) ? error_lo : -(error_lo + TEST_ERR_STEP);
+    int abs_hi = abs_lo + TEST_ERR_STEP;
+    int e, r, pd, left, right, clamp = 0;
+    unsigned char i, linear = TRUE;
+
+    if ((abs_lo < DEADZONE) && (abs_hi >= DEADZONE)) linear = FALSE;
+    if ((abs_lo <= SHARP_ERROR_THRESHOLD_V4) && (abs_hi > SHARP_ERROR_THRESHOLD_V4)) linear = FALSE;
+
+    *min = 32767;
+    *max = -32767;
+    for (i = 0; i < 4; i++) {
+        e = error_lo + ((i & 1) ? TEST_ERR_STEP : 0);
+        r = rate_lo + ((i & 2) ? TEST_RATE_STEP : 0);
+        pd = Test_PD(e, r);
+        if (i == 0) clamp = Test_Clamped(pd);
+        else if (Test_Clamped(pd) != clamp) linear = FALSE;
+
+        Line_Follow_Split(e, pd, &left, &right);
+        if (left < *min) *min = left;
+        if (right < *min) *min = right;
+        if (left > *max) *max = left;
+        if (right > *max) *max = right;
+    }
+    return linear;
+}
+
+static int Test_Abs(int value) {
+    return (value > 0) ? value : -value;
+}
+
+
+// The table is the reference at every grid point
+static void Test_Grid_Points(void) {
+    unsigned int e, r;
+    int error, rate, left, right;
+    unsigned char exact = TRUE;
+
+    for (e = 0; e <= STEER_LUT_ERR_STEPS; e++) {
+        error = STEER_LUT_ERR_MIN + (int)(e << STEER_LUT_ERR_SHIFT);
+        for (r = 0; r <= STEER_LUT_RATE_STEPS; r++) {
+            rate = STEER_LUT_RATE_MIN + (int)(r << STEER_LUT_RATE_SHIFT);
+            Test_Reference(error, rate, &left, &right);
+            if ((steer_lut.entry[e][r].left != left) || (steer_lut.entry[e][r].right != right)) {
+                exact = FALSE;
+            }
+        }
+    }
+    CHECK(exact);
+}
+
+// Every error x rate the lookup takes without clamping to the grid. Off the
+// edges the interpolation is the reference to rounding; in a cell holding an
+// edge it is blended across the step, but never outside what the reference
+// gives at the cell's corners - one grid step away at most
+static void Test_Sweep(void) {
+    int error, rate, left, right, ref_left, ref_right, deviation, min, max;
+    int worst_linear = 0, worst_edge = 0;
+    unsigned long points = 0, edge_points = 0;
+    unsigned char inside = TRUE;
+
+    for (error = -TEST_ERR_MAX; error < TEST_ERR_MAX; error++) {
+        for (rate = -TEST_RATE_MAX; rate < TEST_RATE_MAX; rate++) {
+            Steer_LUT_Lookup(error, rate, &left, &right);
+            Test_Reference(error, rate, &ref_left, &ref_right);
+            deviation = Test_Abs(left - ref_left);
+            if (Test_Abs(right - ref_right) > deviation) deviation = Test_Abs(right - ref_right);
+
+            points++;
+            if (Test_Cell(error, rate, &min, &max)) {
+                if (deviation > worst_linear) worst_linear = deviation;
+            }
+            else {
+                edge_points++;
+                if (deviation > worst_edge) worst_edge = deviation;
+            }
+            if ((left < min - TEST_ROUNDING) || (left > max + TEST_ROUNDING)
+                    || (right < min - TEST_ROUNDING) || (right > max + TEST_ROUNDING)) {
+                inside = FALSE;
+            }
+        }
+    }
+    printf("Steer_LUT sweep: %u points, worst %d counts off the edges, %d in the %u edge cell points\n",
+           points, worst_linear, worst_edge, edge_points);
+    CHECK(worst_linear <= TEST_ROUNDING);
+    CHECK(inside);
+}
+
+// Per-update cost of both paths as Line_Follow_PD_V1 runs them (host ns; on
+// the board the table skips the 32-bit PID products and the gain switch)
+static void Bench_Steer(void) {
+    pid_controller_t pid;
+    struct timespec start, end;
+    unsigned long i;
+    double ns_pid, ns_lut, us_build;
+    int error, left, right;
+    volatile int sink = 0;
+
+    PID_Init(&pid, steer_pd_params.kp_gentle, 0, steer_pd_params.kd, steer_pd_params.max_correction);
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (i = 0; i < BENCH_UPDATES; i++) {
+        error = (int)((i * 37) % 2001) - 1000;
+        pid.kp = (Test_Abs(error) > SHARP_ERROR_THRESHOLD_V4) ? steer_pd_params.kp_sharp : steer_pd_params.kp_gentle;
+        Line_Follow_Split(error, -PID_Update(&pid, 0, error), &left, &right);
+        sink += left + right;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    ns_pid = ((end.tv_sec - start.tv_sec) * 1e9 + (end.tv_nsec - start.tv_nsec)) / BENCH_UPDATES;
+
+    PID_Init(&pid, steer_pd_params.kp_gentle, 0, steer_pd_params.kd, steer_pd_params.max_correction);
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (i = 0; i < BENCH_UPDATES; i++) {
+        error = (int)((i * 37) % 2001) - 1000;
+        Steer_LUT_Lookup(error, PID_Rate_Update(&pid, error), &left, &right);
+        sink += left + right;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    ns_lut = ((end.tv_sec - start.tv_sec) * 1e9 + (end.tv_nsec - start.tv_nsec)) / BENCH_UPDATES;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    Steer_LUT_Build();
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    us_build = ((end.tv_sec - start.tv_sec) * 1e6 + (end.tv_nsec - start.tv_nsec) / 1e3);
+
+    printf("Steer update: PID_Update + Line_Follow_Split %.1f ns, PID_Rate_Update + Steer_LUT_Lookup %.1f ns (host)\n",
+           ns_pid, ns_lut);
+    printf("Steer_LUT_Build: %.0f us (host), %u points\n", us_build,
+           (unsigned int)((STEER_LUT_ERR_STEPS + 1) * (STEER_LUT_RATE_STEPS + 1)));
+    (void)sink;
+}
+
+
+int main(void) {
+    Steer_Ctrl_Init();
+    Steer_LUT_Build();
+    Test_Grid_Points();
+    Test_Sweep();
+    Bench_Steer();
+    return TEST_DONE("test_steer_lut");
+}